@@ -45,17 +45,58 @@ Base by Srinivasan Thiagarajan
 AABB-2D by Brockton Roth
 */
 
-#version 400 core // Identifies the version of the shader, this line must be on a separate line from the rest of the shader code
+#version 430 core // Identifies the version of the shader, this line must be on a separate line from the rest of the shader code
  
 layout(location = 0) in vec3 in_position;	// Get in a vec3 for position
 layout(location = 1) in vec4 in_color;		// Get in a vec4 for color
+layout(location = 2) in mat4 in_MVP;		// The MVP matrix of this instance, from the renderer (locations 2 to 5)
 
 out vec4 color; // Our vec4 color variable containing r, g, b, a
 
-uniform mat4 MVP; // Our uniform MVP matrix to modify our position values
+// A box whose wireframe is built here, 40 bytes each (see BoxWireframes.h)
+struct PulledBox
+{
+	float center[3];
+	float orientation[4];	// A quaternion, x, y, z, w
+	float halfExtents[3];
+};
+
+layout(std430, binding = 0) readonly buffer Boxes
+{
+	PulledBox boxes[];
+};
+
+uniform bool pullBoxes;	// Build a box's wireframe from gl_VertexID instead of reading vertices
+uniform mat4 VP;		// The view projection matrix for the pulled boxes
+uniform vec4 boxColor;	// The color of the pulled boxes
 
 void main(void)
 {
-	color = in_color;	// Pass the color through
-	gl_Position = MVP * vec4(in_position, 1.0); //w is 1.0, also notice cast to a vec4
+	if (pullBoxes)
+	{
+		PulledBox box = boxes[gl_InstanceID];
+
+		// Vertices 2e and 2e + 1 are the ends of edge e. Edges 0-3 run along X, 4-7 along Y, 8-11 along Z,
+		// and the low two bits of e put the edge on the -1 or +1 side of the other two axes.
+		int edge = gl_VertexID / 2;
+		int axis = edge / 4;
+		vec3 corner;
+		corner[axis] = (gl_VertexID & 1) == 0 ? -1.0 : 1.0;
+		corner[(axis + 1) % 3] = (edge & 1) == 0 ? -1.0 : 1.0;
+		corner[(axis + 2) % 3] = (edge & 2) == 0 ? -1.0 : 1.0;
+
+		// Scale, rotate by the quaternion, then move into place
+		vec3 local = corner * vec3(box.halfExtents[0], box.halfExtents[1], box.halfExtents[2]);
+		vec4 q = vec4(box.orientation[0], box.orientation[1], box.orientation[2], box.orientation[3]);
+		vec3 rotated = local + 2.0 * cross(q.xyz, cross(q.xyz, local) + q.w * local);
+		vec3 position = rotated + vec3(box.center[0], box.center[1], box.center[2]);
+
+		color = boxColor;
+		gl_Position = VP * vec4(position, 1.0);
+	}
+	else
+	{
+		color = in_color;	// Pass the color through
+		gl_Position = in_MVP * vec4(in_position, 1.0); //w is 1.0, also notice cast to a vec4
+	}
 }
\ No newline at end of file
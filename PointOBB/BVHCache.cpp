@@ -0,0 +1,386 @@
+/*
+Title: Point - OBB
+File Name: BVHCache.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Saves built trees to files and maps them back in. See BVHCache.h.
+*/
+
+#include "BVHCache.h"
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char BVH_CACHE_MAGIC[8] = { 'P', 'O', 'B', 'B', 'B', 'V', 'H', 0 };
+
+//The arrays start on cache line boundaries
+static const uint64_t BVH_CACHE_ALIGNMENT = 64;
+
+//Numbers each cache write, so writers in one process never share a temporary file
+static std::atomic<unsigned int> nextTemporaryId(0);
+
+MappedFile::MappedFile(void)
+{
+	this->data = nullptr;
+	this->size = 0;
+#ifdef _WIN32
+	this->file = INVALID_HANDLE_VALUE;
+	this->mapping = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile(void)
+{
+	this->Close();
+}
+
+bool MappedFile::Open(const char* path)
+{
+	this->Close();
+
+#ifdef _WIN32
+	this->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(this->file, &size) || size.QuadPart == 0)
+	{
+		this->Close();
+		return false;
+	}
+
+	this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (this->mapping == nullptr)
+	{
+		this->Close();
+		return false;
+	}
+
+	this->data = MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (this->data == nullptr)
+	{
+		this->Close();
+		return false;
+	}
+	this->size = (size_t)size.QuadPart;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	//The mapping keeps the file's pages even after the file is closed
+	void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+		return false;
+
+	this->data = data;
+	this->size = (size_t)status.st_size;
+#endif
+
+	return true;
+}
+
+void MappedFile::Close(void)
+{
+#ifdef _WIN32
+	if (this->data != nullptr)
+		UnmapViewOfFile(this->data);
+	if (this->mapping != nullptr)
+		CloseHandle(this->mapping);
+	if (this->file != INVALID_HANDLE_VALUE)
+		CloseHandle(this->file);
+	this->file = INVALID_HANDLE_VALUE;
+	this->mapping = nullptr;
+#else
+	if (this->data != nullptr)
+		munmap((void*)this->data, this->size);
+#endif
+	this->data = nullptr;
+	this->size = 0;
+}
+
+const void* MappedFile::Data(void) const
+{
+	return this->data;
+}
+
+size_t MappedFile::Size(void) const
+{
+	return this->size;
+}
+
+///
+//Mixes one 64 bit word into a hash
+static inline uint64_t HashWord(uint64_t hash, uint64_t word)
+{
+	hash ^= word;
+	hash *= 0x100000001b3ULL;
+	return hash ^ (hash >> 29);
+}
+
+uint64_t HashScene(const CollisionScene &scene)
+{
+	//FNV-1a a whole word at a time, over the raw bits of every collider, in four
+	//lanes so the multiplies do not all wait on each other
+	uint64_t lanes[4] = { 0xcbf29ce484222325ULL, 0x84222325cbf29ce4ULL, 0x9ce484222325cbf2ULL, 0x2325cbf29ce48422ULL };
+
+	const uint32_t* words = (const uint32_t*)scene.colliders.data();
+	size_t numWords = scene.colliders.size() * sizeof(OBBCollider) / sizeof(uint32_t);
+	size_t i = 0;
+	for (; i + 8 <= numWords; i += 8)
+	{
+		for (int lane = 0; lane < 4; lane++)
+			lanes[lane] = HashWord(lanes[lane], ((uint64_t)words[i + 2 * lane + 1] << 32) | words[i + 2 * lane]);
+	}
+	for (; i < numWords; i++)
+		lanes[0] = HashWord(lanes[0], words[i]);
+
+	uint64_t hash = HashWord(0xcbf29ce484222325ULL, scene.colliders.size());
+	for (int lane = 0; lane < 4; lane++)
+		hash = HashWord(hash, lanes[lane]);
+	return hash;
+}
+
+///
+//Rounds a file offset up to the next array boundary
+///
+//Gets the ID of this process, which no other running process shares
+static long long CurrentProcessId(void)
+{
+#ifdef _WIN32
+	return (long long)GetCurrentProcessId();
+#else
+	return (long long)getpid();
+#endif
+}
+
+static uint64_t Align(uint64_t offset)
+{
+	return (offset + BVH_CACHE_ALIGNMENT - 1) / BVH_CACHE_ALIGNMENT * BVH_CACHE_ALIGNMENT;
+}
+
+///
+//Writes a header and the arrays after it to a temporary file, then renames it into place
+static bool WriteCache(const char* path, BVHCacheHeader header, const void* nodes, const void* indices)
+{
+	header.nodeOffset = Align(sizeof(BVHCacheHeader));
+	header.indexOffset = Align(header.nodeOffset + header.numNodes * header.nodeBytes);
+	header.fileBytes = header.indexOffset + header.numIndices * sizeof(int);
+
+	std::string temporary = std::string(path) + "." + std::to_string(CurrentProcessId()) + "_" +
+		std::to_string(nextTemporaryId.fetch_add(1)) + ".tmp";
+	FILE* file = fopen(temporary.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	static const char padding[BVH_CACHE_ALIGNMENT] = {};
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && fwrite(padding, 1, (size_t)(header.nodeOffset - sizeof(header)), file) == header.nodeOffset - sizeof(header);
+	ok = ok && fwrite(nodes, header.nodeBytes, (size_t)header.numNodes, file) == header.numNodes;
+	uint64_t nodeEnd = header.nodeOffset + header.numNodes * header.nodeBytes;
+	ok = ok && fwrite(padding, 1, (size_t)(header.indexOffset - nodeEnd), file) == header.indexOffset - nodeEnd;
+	ok = ok && (header.numIndices == 0 || fwrite(indices, sizeof(int), (size_t)header.numIndices, file) == header.numIndices);
+	ok = fclose(file) == 0 && ok;
+
+#ifdef _WIN32
+	ok = ok && MoveFileExA(temporary.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	ok = ok && rename(temporary.c_str(), path) == 0;
+#endif
+	if (!ok)
+		remove(temporary.c_str());
+	return ok;
+}
+
+///
+//Fills in the parts of a header which do not depend on the kind of tree
+static BVHCacheHeader MakeHeader(const CollisionScene &scene, BVHCacheKind kind, uint32_t nodeBytes)
+{
+	BVHCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BVH_CACHE_MAGIC, sizeof(header.magic));
+	header.version = BVH_CACHE_VERSION;
+	header.kind = kind;
+	header.nodeBytes = nodeBytes;
+	header.numColliders = (uint32_t)scene.Size();
+	header.sceneHash = HashScene(scene);
+	return header;
+}
+
+bool SaveBVHCache(const char* path, const CollisionScene &scene, const ColliderBVH &tree)
+{
+	BVHCacheHeader header = MakeHeader(scene, BVH_CACHE_BINARY, sizeof(BVHNode));
+	header.numNodes = tree.NumNodes();
+	header.numIndices = tree.NumIndices();
+	return WriteCache(path, header, tree.Nodes(), tree.Indices());
+}
+
+bool SaveBVHCache(const char* path, const CollisionScene &scene, const WideBVH &tree)
+{
+	BVHCacheHeader header = MakeHeader(scene, BVH_CACHE_WIDE, sizeof(WideBVHNode));
+	header.numNodes = tree.NumNodes();
+	return WriteCache(path, header, tree.Nodes(), nullptr);
+}
+
+BVHCache::BVHCache(void)
+{
+	this->scene = nullptr;
+	this->kind = BVH_CACHE_BINARY;
+	this->ready.store(false);
+	this->fromCache = false;
+}
+
+BVHCache::~BVHCache(void)
+{
+	this->Wait();
+}
+
+bool BVHCache::Open(const CollisionScene &scene, const char* path, BVHCacheKind kind, int numThreads)
+{
+	this->Wait();
+	this->scene = &scene;
+	this->path = path;
+	this->kind = kind;
+	this->ready.store(false);
+
+	this->fromCache = this->Load();
+	if (this->fromCache)
+	{
+		this->ready.store(true, std::memory_order_release);
+		return true;
+	}
+
+	//The old file must be let go of before it can be replaced
+	this->file.Close();
+	this->builder = std::thread(&BVHCache::Rebuild, this, numThreads);
+	return false;
+}
+
+///
+//Maps the cache file and attaches the tree to it, if it is for this scene
+//
+//Returns:
+//	false if the file is missing, damaged, from another version, or for another scene
+bool BVHCache::Load(void)
+{
+	if (!this->file.Open(this->path.c_str()) || this->file.Size() < sizeof(BVHCacheHeader))
+		return false;
+
+	const BVHCacheHeader* header = (const BVHCacheHeader*)this->file.Data();
+	uint32_t nodeBytes = this->kind == BVH_CACHE_BINARY ? sizeof(BVHNode) : sizeof(WideBVHNode);
+	if (memcmp(header->magic, BVH_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != BVH_CACHE_VERSION || header->kind != (uint32_t)this->kind ||
+		header->nodeBytes != nodeBytes || header->numColliders != (uint32_t)this->scene->Size() ||
+		header->fileBytes != this->file.Size())
+		return false;
+
+	//The arrays must lie inside the file, on their boundaries
+	if (header->nodeOffset % BVH_CACHE_ALIGNMENT != 0 || header->indexOffset % BVH_CACHE_ALIGNMENT != 0 ||
+		header->nodeOffset > header->fileBytes || header->indexOffset > header->fileBytes ||
+		header->numNodes > (header->fileBytes - header->nodeOffset) / nodeBytes ||
+		header->numIndices > (header->fileBytes - header->indexOffset) / sizeof(int) ||
+		header->numNodes > INT_MAX || header->numIndices > INT_MAX)
+		return false;
+
+	//Hashing the scene is the only part which is not a handful of compares
+	if (header->sceneHash != HashScene(*this->scene))
+		return false;
+
+	//A file that matches the scene can still be damaged, so the tree checks every
+	//node before it is used
+	const char* base = (const char*)this->file.Data();
+	if (this->kind == BVH_CACHE_BINARY)
+		return this->binary.Attach(*this->scene, (const BVHNode*)(base + header->nodeOffset), (int)header->numNodes, (const int*)(base + header->indexOffset), (int)header->numIndices);
+	return this->wide.Attach(*this->scene, (const WideBVHNode*)(base + header->nodeOffset), (int)header->numNodes);
+}
+
+///
+//Builds the tree, writes it to the cache file, and marks it ready
+void BVHCache::Rebuild(int numThreads)
+{
+	if (this->kind == BVH_CACHE_BINARY)
+	{
+		this->binary.BuildLinear(*this->scene, numThreads, true);
+		this->ready.store(true, std::memory_order_release);
+		SaveBVHCache(this->path.c_str(), *this->scene, this->binary);
+	}
+	else
+	{
+		this->wide.Build(*this->scene);
+		this->ready.store(true, std::memory_order_release);
+		SaveBVHCache(this->path.c_str(), *this->scene, this->wide);
+	}
+}
+
+bool BVHCache::Ready(void) const
+{
+	return this->ready.load(std::memory_order_acquire);
+}
+
+void BVHCache::Wait(void)
+{
+	if (this->builder.joinable())
+		this->builder.join();
+}
+
+bool BVHCache::FromCache(void) const
+{
+	return this->fromCache;
+}
+
+int BVHCache::FindContaining(glm::vec3 point) const
+{
+	if (!this->Ready())
+		return FindContainingCollider(*this->scene, point);
+	if (this->kind == BVH_CACHE_BINARY)
+		return this->binary.FindContaining(point);
+	return this->wide.FindContaining(point);
+}
+
+const ColliderBVH &BVHCache::Binary(void) const
+{
+	return this->binary;
+}
+
+const WideBVH &BVHCache::Wide(void) const
+{
+	return this->wide;
+}
@@ -0,0 +1,198 @@
+/*
+Title: Point - OBB
+File Name: BVHCache.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Saves a built ColliderBVH or WideBVH to a file, so the next run over the same scene
+can start with the tree instead of building it again.
+
+The file is a small header followed by the tree's own arrays, exactly as they sit in
+memory. Loading it is just mapping the file: the tree is attached to the mapped
+arrays and used in place, and the operating system reads in only the pages the
+queries touch. The header records a format version, which kind of tree follows,
+the size of a node, the number of colliders, and a hash of every collider in the
+scene, so a file left by an older build or for a different scene is spotted by
+reading a few dozen bytes and hashing the scene. The tree is then walked once to
+check every child and index, so a damaged file is rebuilt rather than followed
+off the end of its arrays.
+
+When the file is missing or stale, BVHCache builds the tree on a thread of its own
+and writes a new file. Queries made before it is ready fall back to testing every
+collider, so a program can start on them straight away. The file is written under
+a temporary name and renamed into place, so a run which stops part way through
+writing never leaves a torn file for the next one to map.
+*/
+
+#ifndef _BVH_CACHE_H
+#define _BVH_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "ColliderBVH.h"
+#include "WideBVH.h"
+
+//Bumped whenever the file layout, or the layout of a node, changes
+#define BVH_CACHE_VERSION 1
+
+//Which tree a cache file holds
+enum BVHCacheKind
+{
+	BVH_CACHE_BINARY = 1,	//A ColliderBVH from BuildLinear with treelets
+	BVH_CACHE_WIDE = 2		//A WideBVH
+};
+
+//The start of a cache file. The arrays follow at the offsets given.
+struct BVHCacheHeader
+{
+	char magic[8];			//"POBBBVH" and a 0
+	uint32_t version;		//BVH_CACHE_VERSION
+	uint32_t kind;			//A BVHCacheKind
+	uint32_t nodeBytes;		//The size of one node, to catch a change of layout
+	uint32_t numColliders;	//The number of colliders in the scene
+	uint64_t sceneHash;		//HashScene of the scene
+	uint64_t numNodes;
+	uint64_t numIndices;	//Only used by BVH_CACHE_BINARY
+	uint64_t nodeOffset;	//Bytes from the start of the file to the nodes
+	uint64_t indexOffset;	//Bytes from the start of the file to the indices
+	uint64_t fileBytes;		//The size of the whole file
+};
+
+//A file mapped read-only into memory
+class MappedFile
+{
+public:
+	MappedFile(void);
+	~MappedFile(void);
+
+	///
+	//Maps a whole file, unmapping any file mapped before
+	//
+	//Returns:
+	//	false if the file could not be opened or mapped, else true
+	bool Open(const char* path);
+
+	///
+	//Unmaps the file
+	void Close(void);
+
+	const void* Data(void) const;
+	size_t Size(void) const;
+
+private:
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+
+	const void* data;
+	size_t size;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#endif
+};
+
+///
+//Hashes every collider of a scene
+//
+//Returns:
+//	A 64 bit hash which changes when any collider is added, removed, or moved
+uint64_t HashScene(const CollisionScene &scene);
+
+///
+//Writes a built tree to a cache file
+//
+//Parameters:
+//	path: The file to write, which is replaced
+//	scene: The scene the tree was built over
+//	tree: The tree
+//
+//Returns:
+//	false if the file could not be written, else true
+bool SaveBVHCache(const char* path, const CollisionScene &scene, const ColliderBVH &tree);
+bool SaveBVHCache(const char* path, const CollisionScene &scene, const WideBVH &tree);
+
+class BVHCache
+{
+public:
+	BVHCache(void);
+
+	///
+	//Waits for any rebuild to finish writing
+	~BVHCache(void);
+
+	///
+	//Gets the tree for a scene from a cache file, or starts building it
+	//
+	//Parameters:
+	//	scene: The scene, which must outlive the cache and not change while it rebuilds
+	//	path: The cache file
+	//	kind: Which tree to use
+	//	numThreads: The number of threads a rebuild may use, or 0 for one per hardware thread
+	//
+	//Returns:
+	//	true if the file was valid and the tree is ready now, false if it is being rebuilt
+	bool Open(const CollisionScene &scene, const char* path, BVHCacheKind kind, int numThreads);
+
+	///
+	//Tests whether the tree is ready to be queried
+	bool Ready(void) const;
+
+	///
+	//Waits for a rebuild to finish
+	void Wait(void);
+
+	///
+	//Gets whether the tree came from the cache file rather than a rebuild
+	bool FromCache(void) const;
+
+	///
+	//Finds a collider containing a point, with the tree once it is ready
+	//
+	//Returns:
+	//	The index of a collider containing the point, or -1 if there is none
+	int FindContaining(glm::vec3 point) const;
+
+	///
+	//Gets the trees. Only the one of the kind asked for is used, once Ready.
+	const ColliderBVH &Binary(void) const;
+	const WideBVH &Wide(void) const;
+
+private:
+	BVHCache(const BVHCache &);
+	BVHCache &operator=(const BVHCache &);
+
+	bool Load(void);
+	void Rebuild(int numThreads);
+
+	const CollisionScene* scene;
+	std::string path;
+	BVHCacheKind kind;
+	MappedFile file;
+	ColliderBVH binary;
+	WideBVH wide;
+	std::thread builder;
+	std::atomic<bool> ready;
+	bool fromCache;
+};
+
+#endif _BVH_CACHE_H
@@ -0,0 +1,213 @@
+/*
+Title: Point - OBB
+File Name: BatchedWorlds.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Many small point - OBB worlds stepped together. See BatchedWorlds.h.
+*/
+
+//So the SSE and scalar paths give every world the same answer
+#include "NoContract.h"
+#include "BatchedWorlds.h"
+#include "Parallel.h"
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_SSE
+#endif
+
+//The number of worlds in each thread's chunk
+static const int WORLDS_PER_CHUNK = 1024;
+
+void BatchedWorlds::Resize(int numWorlds)
+{
+	std::vector<float>* arrays[] =
+	{
+		&this->pointX, &this->pointY, &this->pointZ,
+		&this->pointVelocityX, &this->pointVelocityY, &this->pointVelocityZ,
+		&this->centerX, &this->centerY, &this->centerZ,
+		&this->boxVelocityX, &this->boxVelocityY, &this->boxVelocityZ,
+		&this->min[0], &this->min[1], &this->min[2],
+		&this->max[0], &this->max[1], &this->max[2]
+	};
+	for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+		arrays[i]->resize(numWorlds, 0.0f);
+
+	//New boxes get the identity rotation
+	for (int a = 0; a < 3; a++)
+	{
+		for (int c = 0; c < 3; c++)
+			this->axes[3 * a + c].resize(numWorlds, a == c ? 1.0f : 0.0f);
+	}
+
+	this->hits.resize(numWorlds, 0);
+	this->hitSteps.resize(numWorlds, 0);
+}
+
+void BatchedWorlds::SetPoint(int world, glm::vec3 position, glm::vec3 velocity)
+{
+	this->pointX[world] = position.x;
+	this->pointY[world] = position.y;
+	this->pointZ[world] = position.z;
+	this->pointVelocityX[world] = velocity.x;
+	this->pointVelocityY[world] = velocity.y;
+	this->pointVelocityZ[world] = velocity.z;
+}
+
+void BatchedWorlds::SetBox(int world, const OBBCollider &box, glm::vec3 velocity)
+{
+	this->centerX[world] = box.center.x;
+	this->centerY[world] = box.center.y;
+	this->centerZ[world] = box.center.z;
+	this->boxVelocityX[world] = velocity.x;
+	this->boxVelocityY[world] = velocity.y;
+	this->boxVelocityZ[world] = velocity.z;
+	for (int a = 0; a < 3; a++)
+	{
+		this->axes[3 * a + 0][world] = box.axes[a].x;
+		this->axes[3 * a + 1][world] = box.axes[a].y;
+		this->axes[3 * a + 2][world] = box.axes[a].z;
+		this->min[a][world] = box.min[a];
+		this->max[a][world] = box.max[a];
+	}
+}
+
+void BatchedWorlds::Step(float dt, int numSteps, int numThreads)
+{
+	ParallelFor(this->Size(), WORLDS_PER_CHUNK, numThreads, [this, dt, numSteps](int begin, int end)
+	{
+		this->StepRange(begin, end, dt, numSteps);
+	});
+}
+
+///
+//Steps the worlds from begin up to end
+void BatchedWorlds::StepRange(int begin, int end, float dt, int numSteps)
+{
+	float* px = this->pointX.data(), *py = this->pointY.data(), *pz = this->pointZ.data();
+	const float* pvx = this->pointVelocityX.data(), *pvy = this->pointVelocityY.data(), *pvz = this->pointVelocityZ.data();
+	float* cx = this->centerX.data(), *cy = this->centerY.data(), *cz = this->centerZ.data();
+	const float* bvx = this->boxVelocityX.data(), *bvy = this->boxVelocityY.data(), *bvz = this->boxVelocityZ.data();
+	const float* ax[3], *ay[3], *az[3], *lo[3], *hi[3];
+	for (int a = 0; a < 3; a++)
+	{
+		ax[a] = this->axes[3 * a + 0].data();
+		ay[a] = this->axes[3 * a + 1].data();
+		az[a] = this->axes[3 * a + 2].data();
+		lo[a] = this->min[a].data();
+		hi[a] = this->max[a].data();
+	}
+
+	int i = begin;
+
+#ifdef COLLISION_SSE
+	__m128 step = _mm_set1_ps(dt);
+	for (; i + 4 <= end; i += 4)
+	{
+		//Keep four worlds in registers for all of the steps
+		__m128 x = _mm_loadu_ps(px + i), y = _mm_loadu_ps(py + i), z = _mm_loadu_ps(pz + i);
+		__m128 centerX = _mm_loadu_ps(cx + i), centerY = _mm_loadu_ps(cy + i), centerZ = _mm_loadu_ps(cz + i);
+		__m128 pointDX = _mm_mul_ps(_mm_loadu_ps(pvx + i), step);
+		__m128 pointDY = _mm_mul_ps(_mm_loadu_ps(pvy + i), step);
+		__m128 pointDZ = _mm_mul_ps(_mm_loadu_ps(pvz + i), step);
+		__m128 boxDX = _mm_mul_ps(_mm_loadu_ps(bvx + i), step);
+		__m128 boxDY = _mm_mul_ps(_mm_loadu_ps(bvy + i), step);
+		__m128 boxDZ = _mm_mul_ps(_mm_loadu_ps(bvz + i), step);
+
+		__m128 axisX[3], axisY[3], axisZ[3], low[3], high[3];
+		for (int a = 0; a < 3; a++)
+		{
+			axisX[a] = _mm_loadu_ps(ax[a] + i);
+			axisY[a] = _mm_loadu_ps(ay[a] + i);
+			axisZ[a] = _mm_loadu_ps(az[a] + i);
+			low[a] = _mm_loadu_ps(lo[a] + i);
+			high[a] = _mm_loadu_ps(hi[a] + i);
+		}
+
+		__m128i counts = _mm_setzero_si128();
+		__m128 inside = _mm_setzero_ps();
+		for (int s = 0; s < numSteps; s++)
+		{
+			x = _mm_add_ps(x, pointDX);
+			y = _mm_add_ps(y, pointDY);
+			z = _mm_add_ps(z, pointDZ);
+			centerX = _mm_add_ps(centerX, boxDX);
+			centerY = _mm_add_ps(centerY, boxDY);
+			centerZ = _mm_add_ps(centerZ, boxDZ);
+
+			__m128 dx = _mm_sub_ps(x, centerX), dy = _mm_sub_ps(y, centerY), dz = _mm_sub_ps(z, centerZ);
+			inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int a = 0; a < 3; a++)
+			{
+				__m128 sProj = _mm_add_ps(_mm_add_ps(_mm_mul_ps(axisX[a], dx), _mm_mul_ps(axisY[a], dy)), _mm_mul_ps(axisZ[a], dz));
+				inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(low[a], sProj), _mm_cmple_ps(sProj, high[a])));
+			}
+
+			//A true lane is -1, so subtracting counts it
+			counts = _mm_sub_epi32(counts, _mm_castps_si128(inside));
+		}
+
+		_mm_storeu_ps(px + i, x);
+		_mm_storeu_ps(py + i, y);
+		_mm_storeu_ps(pz + i, z);
+		_mm_storeu_ps(cx + i, centerX);
+		_mm_storeu_ps(cy + i, centerY);
+		_mm_storeu_ps(cz + i, centerZ);
+		_mm_storeu_si128((__m128i*)(this->hitSteps.data() + i), counts);
+
+		int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; lane++)
+			this->hits[i + lane] = (unsigned char)((mask >> lane) & 1);
+	}
+#endif
+
+	//Whatever is left over (or everything, without SSE)
+	for (; i < end; i++)
+	{
+		float pointDX = pvx[i] * dt, pointDY = pvy[i] * dt, pointDZ = pvz[i] * dt;
+		float boxDX = bvx[i] * dt, boxDY = bvy[i] * dt, boxDZ = bvz[i] * dt;
+		int count = 0;
+		bool inside = false;
+
+		for (int s = 0; s < numSteps; s++)
+		{
+			px[i] += pointDX;
+			py[i] += pointDY;
+			pz[i] += pointDZ;
+			cx[i] += boxDX;
+			cy[i] += boxDY;
+			cz[i] += boxDZ;
+
+			float dx = px[i] - cx[i], dy = py[i] - cy[i], dz = pz[i] - cz[i];
+			inside = true;
+			for (int a = 0; a < 3; a++)
+			{
+				float sProj = (ax[a][i] * dx + ay[a][i] * dy) + az[a][i] * dz;
+				inside &= (lo[a][i] <= sProj) & (sProj <= hi[a][i]);
+			}
+			count += inside ? 1 : 0;
+		}
+
+		this->hitSteps[i] = count;
+		this->hits[i] = inside ? 1 : 0;
+	}
+}
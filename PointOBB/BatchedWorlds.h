@@ -0,0 +1,96 @@
+/*
+Title: Point - OBB
+File Name: BatchedWorlds.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Many small, independent copies of the demo's world, one moving point and one moving
+box each, stepped together. This is meant for running thousands of environments
+side by side, for example to train an agent, where stepping each world through its
+own objects would spend most of its time on overhead.
+
+The worlds are stored as structure of arrays across worlds: there is one array for
+every point's X, one for every box center's X, and so on. Stepping moves every
+point and box by its velocity and then runs the point - OBB test, four worlds at a
+time in SSE lanes, with the worlds split between threads in chunks.
+
+Starting threads costs far more than stepping a few thousand tiny worlds, so Step
+can run several steps in one call. Each thread runs all of the steps for its own
+chunk of worlds, since no world ever looks at another.
+*/
+
+#ifndef _BATCHED_WORLDS_H
+#define _BATCHED_WORLDS_H
+
+#include <vector>
+#include "Collision.h"
+
+//Every array holds one entry per world
+struct BatchedWorlds
+{
+	//The points
+	std::vector<float> pointX, pointY, pointZ;
+	std::vector<float> pointVelocityX, pointVelocityY, pointVelocityZ;
+
+	//The boxes, as in OBBCollider
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> boxVelocityX, boxVelocityY, boxVelocityZ;
+	std::vector<float> axes[9];	//axes[3 * a + c] holds component c of each box's axis a
+	std::vector<float> min[3];
+	std::vector<float> max[3];
+
+	//The results of stepping
+	std::vector<unsigned char> hits;	//1 if the point was inside the box after the last step
+	std::vector<int> hitSteps;			//How many steps of the last Step call ended in a hit
+
+	///
+	//Sets the number of worlds. New worlds have their point and box at rest at the origin.
+	void Resize(int numWorlds);
+
+	///
+	//Gets the number of worlds
+	int Size(void) const
+	{
+		return (int)this->hits.size();
+	}
+
+	///
+	//Places the point of one world
+	void SetPoint(int world, glm::vec3 position, glm::vec3 velocity);
+
+	///
+	//Places the box of one world
+	void SetBox(int world, const OBBCollider &box, glm::vec3 velocity);
+
+	///
+	//Steps every world
+	//
+	//Parameters:
+	//	dt: The time to move the points and boxes by, each step
+	//	numSteps: The number of steps to take
+	//	numThreads: The number of threads to use, or 0 for one per hardware thread
+	void Step(float dt, int numSteps, int numThreads);
+
+private:
+	void StepRange(int begin, int end, float dt, int numSteps);
+};
+
+#endif _BATCHED_WORLDS_H
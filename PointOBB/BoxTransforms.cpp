@@ -0,0 +1,179 @@
+/*
+Title: Point - OBB
+File Name: BoxTransforms.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Prepares colliders and AABBs for many boxes at once. See BoxTransforms.h.
+*/
+
+//So the SSE and scalar paths round exactly as PrepareCollider and ComputeWorldAABB do
+#include "NoContract.h"
+#include "BoxTransforms.h"
+#include "Parallel.h"
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_SSE
+#endif
+
+//The number of boxes in each thread's chunk
+static const int BOXES_PER_CHUNK = 1024;
+
+void BoxTransforms::Resize(int numBoxes)
+{
+	this->width.resize(numBoxes, 2.0f);
+	this->height.resize(numBoxes, 2.0f);
+	this->depth.resize(numBoxes, 2.0f);
+	for (int a = 0; a < 3; a++)
+	{
+		this->position[a].resize(numBoxes, 0.0f);
+		this->scale[a].resize(numBoxes, 1.0f);
+		for (int c = 0; c < 3; c++)
+			this->rotation[3 * a + c].resize(numBoxes, a == c ? 1.0f : 0.0f);
+	}
+}
+
+void BoxTransforms::Set(int box, const OBB &boxCollider, const glm::mat4 &boxTranslation, const glm::mat4 &boxRotation, const glm::mat4 &boxScale)
+{
+	this->width[box] = boxCollider.width;
+	this->height[box] = boxCollider.height;
+	this->depth[box] = boxCollider.depth;
+	for (int a = 0; a < 3; a++)
+	{
+		this->position[a][box] = boxTranslation[3][a];
+		this->scale[a][box] = boxScale[a][a];
+		for (int c = 0; c < 3; c++)
+			this->rotation[3 * a + c][box] = boxRotation[a][c];
+	}
+}
+
+///
+//Prepares one box
+static void PrepareBox(const BoxTransforms &boxes, int i, OBBCollider* colliders, AABB* bounds)
+{
+	OBBCollider collider;
+	collider.center = glm::vec3(boxes.position[0][i], boxes.position[1][i], boxes.position[2][i]);
+	for (int a = 0; a < 3; a++)
+		collider.axes[a] = glm::vec3(boxes.rotation[3 * a][i], boxes.rotation[3 * a + 1][i], boxes.rotation[3 * a + 2][i]);
+
+	glm::vec3 half(boxes.width[i] / 2.0f, boxes.height[i] / 2.0f, boxes.depth[i] / 2.0f);
+	glm::vec3 scale(boxes.scale[0][i], boxes.scale[1][i], boxes.scale[2][i]);
+	collider.min = scale * -half;
+	collider.max = scale * half;
+
+	if (colliders != nullptr)
+		colliders[i] = collider;
+	if (bounds != nullptr)
+		bounds[i] = ComputeWorldAABB(collider);
+}
+
+///
+//Prepares the boxes from begin up to end
+static void PrepareRange(const BoxTransforms &boxes, int begin, int end, OBBCollider* colliders, AABB* bounds)
+{
+	int i = begin;
+#ifdef COLLISION_SSE
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 halfOf = _mm_set1_ps(0.5f);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const std::vector<float>* sizes[3] = { &boxes.width, &boxes.height, &boxes.depth };
+
+	for (; i + 4 <= end; i += 4)
+	{
+		//The scaled bounds on each of the box's axes, and their middles and half spans
+		__m128 min[3], max[3], mid[3], half[3];
+		for (int a = 0; a < 3; a++)
+		{
+			__m128 scale = _mm_loadu_ps(&boxes.scale[a][i]);
+			__m128 extent = _mm_div_ps(_mm_loadu_ps(&(*sizes[a])[i]), two);
+			min[a] = _mm_mul_ps(scale, _mm_xor_ps(extent, signBit));
+			max[a] = _mm_mul_ps(scale, extent);
+			mid[a] = _mm_mul_ps(_mm_add_ps(min[a], max[a]), halfOf);
+			half[a] = _mm_mul_ps(_mm_sub_ps(max[a], min[a]), halfOf);
+		}
+
+		//Along each world axis, the middle of the box and how far it reaches out
+		__m128 center[3], low[3], high[3];
+		for (int c = 0; c < 3; c++)
+		{
+			center[c] = _mm_loadu_ps(&boxes.position[c][i]);
+			__m128 middle = center[c];
+			__m128 reach = _mm_setzero_ps();
+			for (int a = 0; a < 3; a++)
+			{
+				__m128 axis = _mm_loadu_ps(&boxes.rotation[3 * a + c][i]);
+				middle = _mm_add_ps(middle, _mm_mul_ps(axis, mid[a]));
+				reach = _mm_add_ps(reach, _mm_mul_ps(_mm_andnot_ps(signBit, axis), half[a]));
+			}
+			low[c] = _mm_sub_ps(middle, reach);
+			high[c] = _mm_add_ps(middle, reach);
+		}
+
+		//Write the four boxes out
+		if (colliders != nullptr)
+		{
+			float lanes[4];
+			for (int a = 0; a < 3; a++)
+			{
+				_mm_storeu_ps(lanes, center[a]);
+				for (int l = 0; l < 4; l++)
+					colliders[i + l].center[a] = lanes[l];
+				_mm_storeu_ps(lanes, min[a]);
+				for (int l = 0; l < 4; l++)
+					colliders[i + l].min[a] = lanes[l];
+				_mm_storeu_ps(lanes, max[a]);
+				for (int l = 0; l < 4; l++)
+					colliders[i + l].max[a] = lanes[l];
+				for (int c = 0; c < 3; c++)
+				{
+					for (int l = 0; l < 4; l++)
+						colliders[i + l].axes[a][c] = boxes.rotation[3 * a + c][i + l];
+				}
+			}
+		}
+		if (bounds != nullptr)
+		{
+			float lanes[4];
+			for (int c = 0; c < 3; c++)
+			{
+				_mm_storeu_ps(lanes, low[c]);
+				for (int l = 0; l < 4; l++)
+					bounds[i + l].min[c] = lanes[l];
+				_mm_storeu_ps(lanes, high[c]);
+				for (int l = 0; l < 4; l++)
+					bounds[i + l].max[c] = lanes[l];
+			}
+		}
+	}
+#endif
+
+	for (; i < end; i++)
+		PrepareBox(boxes, i, colliders, bounds);
+}
+
+void PrepareColliders(const BoxTransforms &boxes, OBBCollider* colliders, AABB* bounds, int numThreads)
+{
+	ParallelFor(boxes.Size(), BOXES_PER_CHUNK, numThreads, [&](int begin, int end)
+	{
+		PrepareRange(boxes, begin, end, colliders, bounds);
+	});
+}
@@ -0,0 +1,87 @@
+/*
+Title: Point - OBB
+File Name: BoxTransforms.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+The transforms of many boxes, kept as structure of arrays, and a pass which turns
+them into prepared colliders and worldspace AABBs together.
+
+Each box is described the way the demo's box is: an OBB giving its width, height,
+and depth, and a Mesh's translation, rotation, and scale. Building a scene from
+those one box at a time means a PrepareCollider call for the local-space test data,
+then a ComputeWorldAABB call which reads the collider straight back to work out the
+AABB: the box's center plus, along each world axis, abs(rotation) times the box's
+half extents.
+
+PrepareColliders does both in one pass, four boxes at a time in SSE lanes, with the
+boxes split between threads in chunks. It reads each box's transform once and writes
+its collider and AABB once, and the results match the two calls bit for bit.
+*/
+
+#ifndef _BOX_TRANSFORMS_H
+#define _BOX_TRANSFORMS_H
+
+#include <vector>
+#include "CollisionScene.h"
+
+//Every array holds one entry per box
+struct BoxTransforms
+{
+	std::vector<float> width, height, depth;	//As in OBB
+	std::vector<float> position[3];				//The translation of each box
+	std::vector<float> rotation[9];				//rotation[3 * a + c] holds component c of each box's axis a
+	std::vector<float> scale[3];				//The scale of each box along its own axes
+
+	///
+	//Sets the number of boxes. New boxes are 2 units on a side, at the origin, with no rotation.
+	void Resize(int numBoxes);
+
+	///
+	//Gets the number of boxes
+	int Size(void) const
+	{
+		return (int)this->width.size();
+	}
+
+	///
+	//Sets one box from its OBB and transformation matrices
+	//
+	//Parameters:
+	//	box: The index of the box
+	//	boxCollider: The box's size
+	//	boxTranslation: The box's translation transformation matrix
+	//	boxRotation: the box's rotation transformation matrix
+	//	boxScale: The box's scale transformation matrix, which must only scale
+	void Set(int box, const OBB &boxCollider, const glm::mat4 &boxTranslation, const glm::mat4 &boxRotation, const glm::mat4 &boxScale);
+};
+
+///
+//Prepares the collider and works out the worldspace AABB of every box
+//
+//Parameters:
+//	boxes: The boxes
+//	colliders: Receives the collider of each box, as from PrepareCollider, may be null
+//	bounds: Receives the AABB of each box, as from ComputeWorldAABB, may be null
+//	numThreads: The number of threads to use, or 0 for one per hardware thread
+void PrepareColliders(const BoxTransforms &boxes, OBBCollider* colliders, AABB* bounds, int numThreads);
+
+#endif _BOX_TRANSFORMS_H
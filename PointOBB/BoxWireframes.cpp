@@ -0,0 +1,91 @@
+/*
+Title: Point - OBB
+File Name: BoxWireframes.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Draws box wireframes by vertex pulling. See BoxWireframes.h.
+*/
+
+#include "BoxWireframes.h"
+
+//The binding point of the boxes buffer in Assets/VertexShader.glsl
+static const GLuint BOXES_BINDING = 0;
+
+//The number of line endpoints in a box's wireframe
+static const int BOX_WIRE_VERTICES = 24;
+
+PulledBox MakePulledBox(const OBBCollider &collider)
+{
+	glm::vec3 mid = (collider.min + collider.max) * 0.5f;
+	glm::vec3 half = (collider.max - collider.min) * 0.5f;
+	glm::vec3 center = collider.center + collider.axes[0] * mid.x + collider.axes[1] * mid.y + collider.axes[2] * mid.z;
+	glm::quat orientation = glm::quat_cast(glm::mat3(collider.axes[0], collider.axes[1], collider.axes[2]));
+
+	PulledBox box;
+	for (int a = 0; a < 3; a++)
+	{
+		box.center[a] = center[a];
+		box.halfExtents[a] = half[a];
+	}
+	box.orientation[0] = orientation.x;
+	box.orientation[1] = orientation.y;
+	box.orientation[2] = orientation.z;
+	box.orientation[3] = orientation.w;
+	return box;
+}
+
+BoxWireframes::BoxWireframes(GLuint program)
+{
+	glGenVertexArrays(1, &this->VAO);
+	glGenBuffers(1, &this->boxBuffer);
+
+	this->uniPullBoxes = glGetUniformLocation(program, "pullBoxes");
+	this->uniVP = glGetUniformLocation(program, "VP");
+	this->uniBoxColor = glGetUniformLocation(program, "boxColor");
+}
+
+BoxWireframes::~BoxWireframes(void)
+{
+	glDeleteVertexArrays(1, &this->VAO);
+	glDeleteBuffers(1, &this->boxBuffer);
+}
+
+void BoxWireframes::Draw(const PulledBox* boxes, int count, const glm::mat4 &VP, const glm::vec4 &color)
+{
+	if (count <= 0)
+		return;
+
+	//Send only the boxes' state, orphaning last frame's buffer
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->boxBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(PulledBox), boxes, GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BOXES_BINDING, this->boxBuffer);
+
+	glUniform1i(this->uniPullBoxes, 1);
+	glUniformMatrix4fv(this->uniVP, 1, GL_FALSE, glm::value_ptr(VP));
+	glUniform4fv(this->uniBoxColor, 1, glm::value_ptr(color));
+
+	//One instance per box, with every endpoint worked out in the vertex shader
+	glBindVertexArray(this->VAO);
+	glDrawArraysInstanced(GL_LINES, 0, BOX_WIRE_VERTICES, count);
+
+	glUniform1i(this->uniPullBoxes, 0);
+}
@@ -0,0 +1,96 @@
+/*
+Title: Point - OBB
+File Name: BoxWireframes.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Draws the wireframes of many boxes without any vertex buffer, by vertex pulling.
+
+The demo's box is drawn from 24 line endpoints written out by hand and uploaded
+once, then moved by a model matrix. Here the only thing sent for a box is its
+state: its center, its orientation as a quaternion, and its half extents, 40 bytes
+in all, written into a shader storage buffer. Each box is one instance of a
+24 vertex GL_LINES draw, and Assets/VertexShader.glsl works out which corner each
+vertex is from gl_VertexID alone: vertices 2e and 2e + 1 are the two ends of edge
+e, edges 0 to 3 run along the box's X axis, 4 to 7 along Y, and 8 to 11 along Z,
+and the two low bits of e say which side of the box the edge is on along the
+other two axes. The corner is then scaled, rotated, and moved into place using
+the box read from the buffer at gl_InstanceID.
+
+The state comes straight from a prepared OBBCollider, so the CPU only writes what
+collision testing already has. This needs OpenGL 4.3.
+*/
+
+#ifndef _BOX_WIREFRAMES_H
+#define _BOX_WIREFRAMES_H
+
+#include "GLIncludes.h"
+#include "Collision.h"
+
+//A box as the vertex shader reads it from the storage buffer, laid out as std430
+struct PulledBox
+{
+	float center[3];		//The middle of the box in worldspace
+	float orientation[4];	//The box's rotation as a quaternion, x, y, z, w
+	float halfExtents[3];	//Half the box's size along each of its own axes
+};
+
+///
+//Gets the state to draw a prepared box with
+//
+//Parameters:
+//	collider: The prepared box, whose axes must be unit length and perpendicular
+//
+//Returns:
+//	The box as the vertex shader reads it
+PulledBox MakePulledBox(const OBBCollider &collider);
+
+class BoxWireframes
+{
+public:
+	///
+	//Makes the storage buffer. Needs a current OpenGL context.
+	//
+	//Parameters:
+	//	program: A program using Assets/VertexShader.glsl
+	BoxWireframes(GLuint program);
+	~BoxWireframes(void);
+
+	///
+	//Draws the wireframes of a set of boxes. The program must be in use.
+	//
+	//Parameters:
+	//	boxes: The boxes
+	//	count: The number of boxes
+	//	VP: The view projection matrix
+	//	color: The color of the lines
+	void Draw(const PulledBox* boxes, int count, const glm::mat4 &VP, const glm::vec4 &color);
+
+private:
+	BoxWireframes(const BoxWireframes &);
+	BoxWireframes &operator=(const BoxWireframes &);
+
+	GLuint VAO;	//Holds no attributes, but one must be bound to draw
+	GLuint boxBuffer;
+	GLint uniPullBoxes, uniVP, uniBoxColor;
+};
+
+#endif _BOX_WIREFRAMES_H
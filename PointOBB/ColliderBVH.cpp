@@ -0,0 +1,1028 @@
+/*
+Title: Point - OBB
+File Name: ColliderBVH.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A bounding volume hierarchy over the boxes of a CollisionScene. See ColliderBVH.h.
+*/
+
+#include "ColliderBVH.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "Morton.h"
+#include "Parallel.h"
+#include "Prefetch.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define COLLISION_SSE
+#endif
+
+//The deepest a tree built by Build can be, which bounds the traversal stacks
+static const int MAX_DEPTH = 64;
+
+ColliderBVH::ColliderBVH(void)
+{
+	this->scene = nullptr;
+	this->UseOwnArrays();
+}
+
+ColliderBVH::ColliderBVH(const ColliderBVH &other)
+	: nodes(other.nodes), indices(other.indices)
+{
+	this->scene = other.scene;
+	this->UseArraysOf(other, other.nodeData == other.nodes.data());
+}
+
+ColliderBVH &ColliderBVH::operator=(const ColliderBVH &other)
+{
+	if (this != &other)
+	{
+		this->scene = other.scene;
+		this->nodes = other.nodes;
+		this->indices = other.indices;
+		this->UseArraysOf(other, other.nodeData == other.nodes.data());
+	}
+	return *this;
+}
+
+void ColliderBVH::Build(const CollisionScene &scene, int maxLeafSize)
+{
+	this->scene = &scene;
+	this->nodes.clear();
+	this->indices.resize(scene.Size());
+	for (int i = 0; i < scene.Size(); i++)
+		this->indices[i] = i;
+
+	if (scene.Size() > 0)
+	{
+		this->nodes.reserve(2 * scene.Size());
+		this->nodes.push_back(BVHNode());
+		this->BuildNode(0, 0, scene.Size(), std::max(1, maxLeafSize));
+	}
+	this->UseOwnArrays();
+}
+
+///
+//Fills in a node over indices[start] up to indices[start + count], and everything beneath it
+void ColliderBVH::BuildNode(int node, int start, int count, int maxLeafSize)
+{
+	const HugeVector<AABB> &bounds = this->scene->bounds;
+
+	//Bound everything under this node, and the centers of it
+	AABB box = bounds[this->indices[start]];
+	glm::vec3 centerMin = (box.min + box.max) * 0.5f;
+	glm::vec3 centerMax = centerMin;
+	for (int i = start + 1; i < start + count; i++)
+	{
+		const AABB &b = bounds[this->indices[i]];
+		box.min = glm::min(box.min, b.min);
+		box.max = glm::max(box.max, b.max);
+
+		glm::vec3 center = (b.min + b.max) * 0.5f;
+		centerMin = glm::min(centerMin, center);
+		centerMax = glm::max(centerMax, center);
+	}
+	this->nodes[node].bounds = box;
+
+	if (count <= maxLeafSize)
+	{
+		this->nodes[node].start = start;
+		this->nodes[node].count = count;
+		return;
+	}
+
+	//Split at the median center along the axis the centers are most spread out on
+	glm::vec3 spread = centerMax - centerMin;
+	int axis = 0;
+	if (spread.y > spread[axis])
+		axis = 1;
+	if (spread.z > spread[axis])
+		axis = 2;
+
+	int half = count / 2;
+	std::nth_element(this->indices.begin() + start, this->indices.begin() + start + half, this->indices.begin() + start + count,
+		[&bounds, axis](int a, int b) { return bounds[a].min[axis] + bounds[a].max[axis] < bounds[b].min[axis] + bounds[b].max[axis]; });
+
+	int left = (int)this->nodes.size();
+	this->nodes.push_back(BVHNode());
+	this->nodes.push_back(BVHNode());
+	this->nodes[node].start = left;
+	this->nodes[node].count = 0;
+
+	this->BuildNode(left, start, half, maxLeafSize);
+	this->BuildNode(left + 1, start + half, count - half, maxLeafSize);
+}
+
+//The number of bits sorted by each radix sort pass, and the passes over a 30 bit code
+static const int RADIX_BITS = 10;
+static const int RADIX_PASSES = 3 * MORTON_BITS / RADIX_BITS;
+
+//The number of items each thread takes at a time while building
+static const int BUILD_GRAIN = 1 << 14;
+
+//The most leaves in a treelet. The search tries every way of splitting every subset
+//of them, which is 3^n steps, so 7 (as in the paper) is left to a GPU.
+static const int TREELET_LEAVES = 5;
+
+//The surface area heuristic's costs of visiting a node, and of testing a collider
+static const float TRAVERSAL_COST = 1.0f;
+static const float COLLIDER_COST = 2.0f;
+
+///
+//Gets the number of 0 bits above the highest 1 bit of a nonzero number
+static int CountLeadingZeros(uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return 31 - (int)index;
+#else
+	return __builtin_clz(value);
+#endif
+}
+
+///
+//Gets the surface area of an AABB
+static float SurfaceArea(const AABB &box)
+{
+	glm::vec3 size = box.max - box.min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+///
+//Gets the AABB around two others
+static AABB Union(const AABB &a, const AABB &b)
+{
+	AABB box;
+	box.min = glm::min(a.min, b.min);
+	box.max = glm::max(a.max, b.max);
+	return box;
+}
+
+///
+//Gets the length of the prefix two sorted keys share, with ties broken by position
+//
+//Returns:
+//	The number of leading bits keys[i] and keys[j] have in common, or -1 if j is out of range
+static int CommonPrefix(const uint32_t* keys, int count, int i, int j)
+{
+	if (j < 0 || j >= count)
+		return -1;
+	if (keys[i] == keys[j])
+		return 32 + CountLeadingZeros((uint32_t)(i ^ j));
+	return CountLeadingZeros(keys[i] ^ keys[j]);
+}
+
+void ColliderBVH::BuildLinear(const CollisionScene &scene, int numThreads, bool optimizeTreelets)
+{
+	this->scene = &scene;
+	this->nodes.clear();
+	int count = scene.Size();
+	this->indices.resize(count);
+	this->UseOwnArrays();
+	if (count == 0)
+		return;
+
+	//Give each collider the Morton code of its center, on a grid over all of the centers
+	AABB centers;
+	centers.min = centers.max = (scene.bounds[0].min + scene.bounds[0].max) * 0.5f;
+	for (int i = 1; i < count; i++)
+	{
+		glm::vec3 center = (scene.bounds[i].min + scene.bounds[i].max) * 0.5f;
+		centers.min = glm::min(centers.min, center);
+		centers.max = glm::max(centers.max, center);
+	}
+	glm::vec3 invSize = 1.0f / glm::max(centers.max - centers.min, glm::vec3(1e-6f));
+
+	std::vector<uint32_t> keys(count), sortedKeys(count);
+	HugeVector<int> sortedIndices(count);
+	ParallelFor(count, BUILD_GRAIN, numThreads, [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			glm::uvec3 cell = MortonCell((scene.bounds[i].min + scene.bounds[i].max) * 0.5f, centers.min, invSize, MORTON_BITS);
+			keys[i] = MortonCode(cell.x, cell.y, cell.z);
+			this->indices[i] = i;
+		}
+	});
+
+	//Radix sort the codes, RADIX_BITS at a time. Each chunk of the input counts its
+	//digits, the counts give every chunk its own place to write each digit, and then
+	//the chunks scatter their items at the same time.
+	int numChunks = (count + BUILD_GRAIN - 1) / BUILD_GRAIN;
+	int numDigits = 1 << RADIX_BITS;
+	std::vector<int> histograms((size_t)numChunks * numDigits);
+	for (int pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		int shift = pass * RADIX_BITS;
+		std::fill(histograms.begin(), histograms.end(), 0);
+		ParallelFor(count, BUILD_GRAIN, numThreads, [&](int begin, int end)
+		{
+			int* histogram = &histograms[(size_t)(begin / BUILD_GRAIN) * numDigits];
+			for (int i = begin; i < end; i++)
+				histogram[(keys[i] >> shift) & (numDigits - 1)]++;
+		});
+
+		int offset = 0;
+		for (int digit = 0; digit < numDigits; digit++)
+		{
+			for (int chunk = 0; chunk < numChunks; chunk++)
+			{
+				int digitCount = histograms[(size_t)chunk * numDigits + digit];
+				histograms[(size_t)chunk * numDigits + digit] = offset;
+				offset += digitCount;
+			}
+		}
+
+		ParallelFor(count, BUILD_GRAIN, numThreads, [&](int begin, int end)
+		{
+			int* next = &histograms[(size_t)(begin / BUILD_GRAIN) * numDigits];
+			for (int i = begin; i < end; i++)
+			{
+				int slot = next[(keys[i] >> shift) & (numDigits - 1)]++;
+				sortedKeys[slot] = keys[i];
+				sortedIndices[slot] = this->indices[i];
+			}
+		});
+
+		keys.swap(sortedKeys);
+		this->indices.swap(sortedIndices);
+	}
+
+	//Inner node i owns the pair of nodes at 1 + 2i, so every pair of children is
+	//next to each other and the tree uses the same layout as Build's
+	this->nodes.resize(2 * (size_t)count - 1);
+	std::vector<int> innerSlot(count - 1), leafSlot(count);
+	std::vector<int> innerParent(count - 1), leafParent(count);
+	if (count == 1)
+		leafSlot[0] = 0;
+	else
+		innerSlot[0] = 0;
+
+	const uint32_t* sorted = keys.data();
+	ParallelFor(count - 1, BUILD_GRAIN, numThreads, [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			//Which way the node's range runs from i, and how far
+			int direction = CommonPrefix(sorted, count, i, i + 1) > CommonPrefix(sorted, count, i, i - 1) ? 1 : -1;
+			int minPrefix = CommonPrefix(sorted, count, i, i - direction);
+			int maxLength = 2;
+			while (CommonPrefix(sorted, count, i, i + maxLength * direction) > minPrefix)
+				maxLength *= 2;
+			int length = 0;
+			for (int step = maxLength / 2; step >= 1; step /= 2)
+			{
+				if (CommonPrefix(sorted, count, i, i + (length + step) * direction) > minPrefix)
+					length += step;
+			}
+			int j = i + length * direction;
+
+			//Where in the range the highest differing bit changes
+			int nodePrefix = CommonPrefix(sorted, count, i, j);
+			int split = 0;
+			for (int divisor = 2; ; divisor *= 2)
+			{
+				int step = (length + divisor - 1) / divisor;
+				if (CommonPrefix(sorted, count, i, i + (split + step) * direction) > nodePrefix)
+					split += step;
+				if (step <= 1)
+					break;
+			}
+			int gamma = i + split * direction + std::min(direction, 0);
+
+			//The left child ends the split and the right child starts after it,
+			//and either is a leaf if it covers only one collider
+			if (std::min(i, j) == gamma)
+			{
+				leafSlot[gamma] = 1 + 2 * i;
+				leafParent[gamma] = i;
+			}
+			else
+			{
+				innerSlot[gamma] = 1 + 2 * i;
+				innerParent[gamma] = i;
+			}
+			if (std::max(i, j) == gamma + 1)
+			{
+				leafSlot[gamma + 1] = 2 + 2 * i;
+				leafParent[gamma + 1] = i;
+			}
+			else
+			{
+				innerSlot[gamma + 1] = 2 + 2 * i;
+				innerParent[gamma + 1] = i;
+			}
+		}
+	});
+
+	//Fill in the leaves, then the inner nodes from the bottom up. The second of a
+	//node's children to finish is the one which goes on to its parent.
+	std::vector<float> cost(this->nodes.size());
+	std::vector<std::atomic<int> > arrivals(count - 1);
+	for (int i = 0; i < count - 1; i++)
+		arrivals[i].store(0, std::memory_order_relaxed);
+
+	ParallelFor(count, BUILD_GRAIN, numThreads, [&](int begin, int end)
+	{
+		for (int k = begin; k < end; k++)
+		{
+			BVHNode &leaf = this->nodes[leafSlot[k]];
+			leaf.bounds = scene.bounds[this->indices[k]];
+			leaf.start = k;
+			leaf.count = 1;
+			cost[leafSlot[k]] = COLLIDER_COST * SurfaceArea(leaf.bounds);
+
+			if (count == 1)
+				continue;
+			for (int parent = leafParent[k]; ; parent = innerParent[parent])
+			{
+				if (arrivals[parent].fetch_add(1, std::memory_order_acq_rel) == 0)
+					break;
+
+				int slot = innerSlot[parent];
+				BVHNode &node = this->nodes[slot];
+				node.start = 1 + 2 * parent;
+				node.count = 0;
+				node.bounds = Union(this->nodes[node.start].bounds, this->nodes[node.start + 1].bounds);
+				cost[slot] = TRAVERSAL_COST * SurfaceArea(node.bounds) + cost[node.start] + cost[node.start + 1];
+
+				if (parent == 0)
+					break;
+			}
+		}
+	});
+
+	if (optimizeTreelets && count > 2)
+	{
+		this->OptimizeTreelets(cost, numThreads);
+
+		//Rearranging can deepen the tree. The traversal stacks are only so big.
+		if (this->Depth() >= MAX_DEPTH)
+			this->BuildLinear(scene, numThreads, false);
+	}
+	this->UseOwnArrays();
+}
+
+///
+//Rearranges the treelet under every inner node, deepest nodes first
+void ColliderBVH::OptimizeTreelets(std::vector<float> &cost, int numThreads)
+{
+	//Sort the inner nodes by depth. Treelets rooted at the same depth never share a
+	//node, and a rearranged treelet keeps its root where it was, so each level can
+	//be done on several threads and the levels above stay valid.
+	std::vector<std::vector<int> > levels;
+	std::vector<int> level(1, 0);
+	while (!level.empty())
+	{
+		levels.push_back(level);
+		std::vector<int> next;
+		for (size_t i = 0; i < level.size(); i++)
+		{
+			const BVHNode &node = this->nodes[level[i]];
+			for (int c = 0; c < 2; c++)
+			{
+				if (this->nodes[node.start + c].count == 0)
+					next.push_back(node.start + c);
+			}
+		}
+		level.swap(next);
+	}
+
+	for (int depth = (int)levels.size() - 1; depth >= 0; depth--)
+	{
+		const std::vector<int> &roots = levels[depth];
+		ParallelFor((int)roots.size(), 256, numThreads, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+				this->OptimizeTreelet(roots[i], cost);
+		});
+	}
+}
+
+///
+//Rearranges the nodes under a root into the shape with the lowest cost
+//
+//Overview:
+//	The treelet is grown from the root's two children by opening up whichever
+//	of its inner nodes has the largest surface area, until it has TREELET_LEAVES
+//	leaves (which may be whole subtrees). For every subset of those leaves the
+//	cheapest tree over just that subset is found from the cheapest trees over the
+//	two parts of each way of splitting it. If the cheapest tree over all of them
+//	beats the current one, the treelet is rebuilt that way, reusing its own slots.
+void ColliderBVH::OptimizeTreelet(int root, std::vector<float> &cost)
+{
+	int leaves[TREELET_LEAVES];
+	int pairs[TREELET_LEAVES];
+	int numLeaves = 2;
+	int numPairs = 1;
+	leaves[0] = this->nodes[root].start;
+	leaves[1] = this->nodes[root].start + 1;
+	pairs[0] = this->nodes[root].start;
+
+	while (numLeaves < TREELET_LEAVES)
+	{
+		int biggest = -1;
+		for (int l = 0; l < numLeaves; l++)
+		{
+			if (this->nodes[leaves[l]].count == 0 && (biggest < 0 || SurfaceArea(this->nodes[leaves[l]].bounds) > SurfaceArea(this->nodes[leaves[biggest]].bounds)))
+				biggest = l;
+		}
+		if (biggest < 0)
+			break;
+
+		int start = this->nodes[leaves[biggest]].start;
+		pairs[numPairs++] = start;
+		leaves[biggest] = start;
+		leaves[numLeaves++] = start + 1;
+	}
+	if (numLeaves < 3)
+		return;
+
+	//The cheapest tree over each subset of the leaves, and how it splits
+	const int numSubsets = 1 << TREELET_LEAVES;
+	AABB bounds[numSubsets];
+	float best[numSubsets];
+	int split[numSubsets];
+	BVHNode records[TREELET_LEAVES];
+	float recordCosts[TREELET_LEAVES];
+	for (int l = 0; l < numLeaves; l++)
+	{
+		records[l] = this->nodes[leaves[l]];
+		recordCosts[l] = cost[leaves[l]];
+	}
+
+	int full = (1 << numLeaves) - 1;
+	for (int subset = 1; subset <= full; subset++)
+	{
+		int low = subset & -subset;
+		int lowIndex = 0;
+		while ((1 << lowIndex) != low)
+			lowIndex++;
+
+		if (subset == low)
+		{
+			bounds[subset] = records[lowIndex].bounds;
+			best[subset] = recordCosts[lowIndex];
+			split[subset] = 0;
+			continue;
+		}
+
+		//Every split, counted once by keeping the lowest leaf on the left
+		bounds[subset] = Union(bounds[low], bounds[subset ^ low]);
+		int rest = subset ^ low;
+		best[subset] = FLT_MAX;
+		for (int part = rest; ; part = (part - 1) & rest)
+		{
+			int left = low | part;
+			if (left != subset)
+			{
+				float splitCost = best[left] + best[subset ^ left];
+				if (splitCost < best[subset])
+				{
+					best[subset] = splitCost;
+					split[subset] = left;
+				}
+			}
+			if (part == 0)
+				break;
+		}
+		best[subset] += TRAVERSAL_COST * SurfaceArea(bounds[subset]);
+	}
+
+	//Only rebuild for a real improvement, so rounding cannot make it churn
+	if (best[full] >= cost[root] * (1.0f - 1e-5f))
+		return;
+
+	//Lay the new shape back into the treelet's slots, top down
+	int nextPair = 0;
+	int stackSlots[2 * TREELET_LEAVES], stackSubsets[2 * TREELET_LEAVES];
+	int top = 0;
+	stackSlots[top] = root;
+	stackSubsets[top++] = full;
+	while (top > 0)
+	{
+		top--;
+		int slot = stackSlots[top];
+		int subset = stackSubsets[top];
+
+		if ((subset & (subset - 1)) == 0)
+		{
+			int leaf = 0;
+			while ((1 << leaf) != subset)
+				leaf++;
+			this->nodes[slot] = records[leaf];
+			cost[slot] = recordCosts[leaf];
+			continue;
+		}
+
+		int pair = pairs[nextPair++];
+		this->nodes[slot].bounds = bounds[subset];
+		this->nodes[slot].start = pair;
+		this->nodes[slot].count = 0;
+		cost[slot] = best[subset];
+
+		stackSlots[top] = pair;
+		stackSubsets[top++] = split[subset];
+		stackSlots[top] = pair + 1;
+		stackSubsets[top++] = subset ^ split[subset];
+	}
+}
+
+///
+//Gets the number of nodes on the longest path from the root to a leaf
+int ColliderBVH::Depth(void) const
+{
+	if (this->nodes.empty())
+		return 0;
+
+	std::vector<std::pair<int, int> > stack(1, std::pair<int, int>(0, 1));
+	int deepest = 0;
+	while (!stack.empty())
+	{
+		std::pair<int, int> entry = stack.back();
+		stack.pop_back();
+		deepest = std::max(deepest, entry.second);
+
+		const BVHNode &node = this->nodes[entry.first];
+		if (node.count == 0)
+		{
+			stack.push_back(std::pair<int, int>(node.start, entry.second + 1));
+			stack.push_back(std::pair<int, int>(node.start + 1, entry.second + 1));
+		}
+	}
+	return deepest;
+}
+
+int ColliderBVH::FindContaining(glm::vec3 point) const
+{
+	if (this->numNodes == 0)
+		return -1;
+
+	bool prefetch = PrefetchDistance() > 0;
+	int stack[MAX_DEPTH * 2];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const BVHNode &node = this->nodeData[stack[--top]];
+
+		//Start loading the node after this one while this one is tested
+		if (prefetch && top > 0)
+			Prefetch(&this->nodeData[stack[top - 1]]);
+
+		if (!Contains(node.bounds, point))
+			continue;
+
+		if (node.count > 0)
+		{
+			//Start loading every collider in the leaf before testing the first
+			if (prefetch)
+				for (int i = node.start; i < node.start + node.count; i++)
+					Prefetch(&this->scene->colliders[this->indexData[i]]);
+
+			for (int i = node.start; i < node.start + node.count; i++)
+			{
+				int collider = this->indexData[i];
+				if (TestCollision(this->scene->colliders[collider], point))
+					return collider;
+			}
+		}
+		else
+		{
+			stack[top++] = node.start + 1;
+			stack[top++] = node.start;
+		}
+	}
+
+	return -1;
+}
+
+///
+//Gets which lanes of a packet are inside an AABB
+//
+//Parameters:
+//	box: The AABB
+//	x, y, z: The packet's points, PACKET_SIZE of each, 16 byte aligned
+//	mask: The lanes to test
+//
+//Returns:
+//	The lanes of mask inside the box
+static uint32_t InsideMask(const AABB &box, const float* x, const float* y, const float* z, uint32_t mask)
+{
+	uint32_t inside = 0;
+#ifdef COLLISION_SSE
+	__m128 minX = _mm_set1_ps(box.min.x), minY = _mm_set1_ps(box.min.y), minZ = _mm_set1_ps(box.min.z);
+	__m128 maxX = _mm_set1_ps(box.max.x), maxY = _mm_set1_ps(box.max.y), maxZ = _mm_set1_ps(box.max.z);
+	for (int group = 0; group < PACKET_SIZE / 4; group++)
+	{
+		if (((mask >> (4 * group)) & 0xF) == 0)
+			continue;
+
+		__m128 px = _mm_load_ps(x + 4 * group);
+		__m128 py = _mm_load_ps(y + 4 * group);
+		__m128 pz = _mm_load_ps(z + 4 * group);
+		__m128 in = _mm_and_ps(_mm_cmple_ps(minX, px), _mm_cmple_ps(px, maxX));
+		in = _mm_and_ps(in, _mm_and_ps(_mm_cmple_ps(minY, py), _mm_cmple_ps(py, maxY)));
+		in = _mm_and_ps(in, _mm_and_ps(_mm_cmple_ps(minZ, pz), _mm_cmple_ps(pz, maxZ)));
+		inside |= (uint32_t)_mm_movemask_ps(in) << (4 * group);
+	}
+#else
+	for (int lane = 0; lane < PACKET_SIZE; lane++)
+	{
+		if (((mask >> lane) & 1) != 0 && Contains(box, glm::vec3(x[lane], y[lane], z[lane])))
+			inside |= 1u << lane;
+	}
+#endif
+	return inside & mask;
+}
+
+///
+//Finds a collider containing each point of a packet
+//
+//Overview:
+//	The packet walks the tree the same way a single point does, carrying the
+//	mask of lanes which are inside every node on the way down and have not found
+//	a collider yet. A lane drops out of a branch when it leaves the branch's box,
+//	so the packet only splits where its points really go different ways, and a
+//	branch no lane is left in is never visited.
+//
+//Parameters:
+//	x, y, z: The packet's points, PACKET_SIZE of each, 16 byte aligned
+//	active: The lanes holding points
+//	results: Receives the index of a collider containing each point, or -1
+//
+//Returns:
+//	The number of nodes visited
+int ColliderBVH::FindContainingPacket(const float* x, const float* y, const float* z, uint32_t active, int* results) const
+{
+	for (int lane = 0; lane < PACKET_SIZE; lane++)
+		results[lane] = -1;
+	if (this->numNodes == 0)
+		return 0;
+
+	bool prefetch = PrefetchDistance() > 0;
+	int stackNodes[MAX_DEPTH * 2];
+	uint32_t stackMasks[MAX_DEPTH * 2];
+	int top = 0;
+	stackNodes[top] = 0;
+	stackMasks[top++] = active;
+
+	//The lanes still looking for a collider
+	uint32_t pending = active;
+	int visits = 0;
+	while (top > 0 && pending != 0)
+	{
+		top--;
+		const BVHNode &node = this->nodeData[stackNodes[top]];
+		if (prefetch && top > 0)
+			Prefetch(&this->nodeData[stackNodes[top - 1]]);
+
+		uint32_t mask = stackMasks[top] & pending;
+		if (mask == 0)
+			continue;
+		visits++;
+
+		mask = InsideMask(node.bounds, x, y, z, mask);
+		if (mask == 0)
+			continue;
+
+		if (node.count > 0)
+		{
+			if (prefetch)
+				for (int i = node.start; i < node.start + node.count; i++)
+					Prefetch(&this->scene->colliders[this->indexData[i]]);
+
+			for (int i = node.start; i < node.start + node.count && mask != 0; i++)
+			{
+				int collider = this->indexData[i];
+				for (uint32_t lanes = mask; lanes != 0; lanes &= lanes - 1)
+				{
+					int lane = 0;
+					while (((lanes >> lane) & 1) == 0)
+						lane++;
+
+					if (TestCollision(this->scene->colliders[collider], glm::vec3(x[lane], y[lane], z[lane])))
+					{
+						results[lane] = collider;
+						mask &= ~(1u << lane);
+						pending &= ~(1u << lane);
+					}
+				}
+			}
+		}
+		else
+		{
+			stackNodes[top] = node.start + 1;
+			stackMasks[top++] = mask;
+			stackNodes[top] = node.start;
+			stackMasks[top++] = mask;
+		}
+	}
+
+	return visits;
+}
+
+long long ColliderBVH::FindContaining(const float* x, const float* y, const float* z, int count, int* results, int packetSize, int numThreads) const
+{
+	packetSize = std::min(std::max(packetSize, 1), PACKET_SIZE);
+	if (count <= 0)
+		return 0;
+
+	//Line the points up along a Z-order curve over their own bounds, so each
+	//packet holds points which are close together
+	glm::vec3 low(x[0], y[0], z[0]), high = low;
+	for (int i = 1; i < count; i++)
+	{
+		glm::vec3 p(x[i], y[i], z[i]);
+		low = glm::min(low, p);
+		high = glm::max(high, p);
+	}
+	glm::vec3 invSize = 1.0f / glm::max(high - low, glm::vec3(1e-6f));
+
+	std::vector<std::pair<uint32_t, int> > order(count);
+	ParallelFor(count, BUILD_GRAIN, numThreads, [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			glm::uvec3 cell = MortonCell(glm::vec3(x[i], y[i], z[i]), low, invSize, MORTON_BITS);
+			order[i] = std::pair<uint32_t, int>(MortonCode(cell.x, cell.y, cell.z), i);
+		}
+	});
+	std::sort(order.begin(), order.end());
+
+	std::atomic<long long> visits(0);
+	int numPackets = (count + packetSize - 1) / packetSize;
+	ParallelFor(numPackets, 64, numThreads, [&](int begin, int end)
+	{
+		alignas(16) float px[PACKET_SIZE], py[PACKET_SIZE], pz[PACKET_SIZE];
+		int packetResults[PACKET_SIZE];
+		long long chunkVisits = 0;
+
+		for (int packet = begin; packet < end; packet++)
+		{
+			int first = packet * packetSize;
+			int size = std::min(packetSize, count - first);
+			for (int lane = 0; lane < PACKET_SIZE; lane++)
+			{
+				int point = order[first + std::min(lane, size - 1)].second;
+				px[lane] = x[point];
+				py[lane] = y[point];
+				pz[lane] = z[point];
+			}
+
+			chunkVisits += this->FindContainingPacket(px, py, pz, (1u << size) - 1, packetResults);
+			for (int lane = 0; lane < size; lane++)
+				results[order[first + lane].second] = packetResults[lane];
+		}
+
+		visits.fetch_add(chunkVisits, std::memory_order_relaxed);
+	});
+
+	return visits.load();
+}
+
+int ColliderBVH::KNearest(glm::vec3 point, int k, int* indices, float* distances) const
+{
+	if (this->numNodes == 0 || k <= 0)
+		return 0;
+
+	typedef std::pair<float, int> Entry;
+
+	//The nodes waiting to be looked at, nearest on top
+	std::vector<Entry> open;
+	open.reserve(MAX_DEPTH * 2);
+	std::greater<Entry> nearerFirst;
+	bool prefetch = PrefetchDistance() > 0;
+
+	//The k best colliders so far, furthest on top
+	std::vector<Entry> best;
+	best.reserve(k + 1);
+
+	open.push_back(Entry(DistanceSquared(this->nodeData[0].bounds, point), 0));
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end(), nearerFirst);
+		Entry entry = open.back();
+		open.pop_back();
+		if (prefetch && !open.empty())
+			Prefetch(&this->nodeData[open.front().second]);
+
+		//Nothing left can beat the worst of the best
+		if ((int)best.size() == k && entry.first > best.front().first)
+			break;
+
+		const BVHNode &node = this->nodeData[entry.second];
+		if (node.count > 0)
+		{
+			if (prefetch)
+				for (int i = node.start; i < node.start + node.count; i++)
+					Prefetch(&this->scene->colliders[this->indexData[i]]);
+
+			for (int i = node.start; i < node.start + node.count; i++)
+			{
+				int collider = this->indexData[i];
+				float distance = DistanceSquared(this->scene->colliders[collider], point);
+				if ((int)best.size() < k)
+				{
+					best.push_back(Entry(distance, collider));
+					std::push_heap(best.begin(), best.end());
+				}
+				else if (distance < best.front().first)
+				{
+					std::pop_heap(best.begin(), best.end());
+					best.back() = Entry(distance, collider);
+					std::push_heap(best.begin(), best.end());
+				}
+			}
+		}
+		else
+		{
+			for (int c = 0; c < 2; c++)
+			{
+				int child = node.start + c;
+				float distance = DistanceSquared(this->nodeData[child].bounds, point);
+				if ((int)best.size() < k || distance <= best.front().first)
+				{
+					open.push_back(Entry(distance, child));
+					std::push_heap(open.begin(), open.end(), nearerFirst);
+				}
+			}
+		}
+	}
+
+	std::sort_heap(best.begin(), best.end());
+	for (size_t i = 0; i < best.size(); i++)
+	{
+		indices[i] = best[i].second;
+		if (distances != nullptr)
+			distances[i] = best[i].first;
+	}
+
+	return (int)best.size();
+}
+
+void ColliderBVH::KNearest(const float* x, const float* y, const float* z, int count, int k, int* indices, float* distances, int numThreads) const
+{
+	ParallelFor(count, 256, numThreads, [&](int begin, int end)
+	{
+		for (int p = begin; p < end; p++)
+		{
+			int* pointIndices = indices + (size_t)p * k;
+			float* pointDistances = distances != nullptr ? distances + (size_t)p * k : nullptr;
+
+			int found = this->KNearest(glm::vec3(x[p], y[p], z[p]), k, pointIndices, pointDistances);
+			for (int i = found; i < k; i++)
+			{
+				pointIndices[i] = -1;
+				if (pointDistances != nullptr)
+					pointDistances[i] = -1.0f;
+			}
+		}
+	});
+}
+
+///
+//Checks that arrays from outside make a tree the queries can walk safely: every
+//node is reached once from the root, no deeper than the traversal stacks allow,
+//and every leaf's indices are in range and name colliders in the scene
+static bool IsValidTree(const CollisionScene &scene, const BVHNode* nodes, int numNodes, const int* indices, int numIndices)
+{
+	if (numNodes < 0 || numIndices < 0)
+		return false;
+	for (int i = 0; i < numIndices; i++)
+	{
+		if (indices[i] < 0 || indices[i] >= scene.Size())
+			return false;
+	}
+	if (numNodes == 0)
+		return true;
+
+	std::vector<bool> reached(numNodes, false);
+	std::vector<std::pair<int, int> > stack;
+	stack.push_back(std::pair<int, int>(0, 0));
+	reached[0] = true;
+	while (!stack.empty())
+	{
+		std::pair<int, int> entry = stack.back();
+		stack.pop_back();
+		if (entry.second >= MAX_DEPTH)
+			return false;
+
+		const BVHNode &node = nodes[entry.first];
+		if (node.count > 0)
+		{
+			if (node.start < 0 || node.start > numIndices - node.count)
+				return false;
+			continue;
+		}
+		if (node.count < 0 || node.start < 0 || node.start >= numNodes - 1)
+			return false;
+
+		for (int child = node.start; child <= node.start + 1; child++)
+		{
+			if (reached[child])
+				return false;
+			reached[child] = true;
+			stack.push_back(std::pair<int, int>(child, entry.second + 1));
+		}
+	}
+	return true;
+}
+
+bool ColliderBVH::Attach(const CollisionScene &scene, const BVHNode* nodes, int numNodes, const int* indices, int numIndices)
+{
+	this->scene = &scene;
+	this->nodes.clear();
+	this->indices.clear();
+	if (!IsValidTree(scene, nodes, numNodes, indices, numIndices))
+	{
+		this->UseOwnArrays();
+		return false;
+	}
+
+	this->nodeData = nodes;
+	this->numNodes = numNodes;
+	this->indexData = indices;
+	this->numIndices = numIndices;
+	return true;
+}
+
+///
+//Points the queries at the tree's own arrays, once a build has finished with them
+void ColliderBVH::UseOwnArrays(void)
+{
+	this->nodeData = this->nodes.data();
+	this->numNodes = (int)this->nodes.size();
+	this->indexData = this->indices.data();
+	this->numIndices = (int)this->indices.size();
+}
+
+///
+//Points the queries at the right arrays after copying another tree's
+//
+//Parameters:
+//	other: The tree copied from
+//	owned: Whether the other tree's queries read its own arrays, rather than attached ones
+void ColliderBVH::UseArraysOf(const ColliderBVH &other, bool owned)
+{
+	if (owned)
+	{
+		this->UseOwnArrays();
+		return;
+	}
+
+	this->nodeData = other.nodeData;
+	this->numNodes = other.numNodes;
+	this->indexData = other.indexData;
+	this->numIndices = other.numIndices;
+}
+
+const BVHNode* ColliderBVH::Nodes(void) const
+{
+	return this->nodeData;
+}
+
+int ColliderBVH::NumNodes(void) const
+{
+	return this->numNodes;
+}
+
+const int* ColliderBVH::Indices(void) const
+{
+	return this->indexData;
+}
+
+int ColliderBVH::NumIndices(void) const
+{
+	return this->numIndices;
+}
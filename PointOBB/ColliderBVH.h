@@ -0,0 +1,193 @@
+/*
+Title: Point - OBB
+File Name: ColliderBVH.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A bounding volume hierarchy over the boxes of a CollisionScene. Each node holds an
+AABB around everything beneath it, so a query can skip a whole branch of the scene
+with one AABB test.
+
+The tree is built top-down: the boxes under a node are split in half at the median
+of their centers along the axis where the centers are most spread out, until few
+enough boxes are left to make a leaf. Nodes are stored in one array, and the two
+children of a node are always next to each other.
+
+BuildLinear makes the same kind of tree much faster, for scenes that are rebuilt
+from scratch. The box centers are given Morton codes and radix sorted, which lines
+the boxes up along a Z-order curve, and then every inner node of the tree is found
+at once from where neighbouring codes first differ (Karras, "Maximizing Parallelism
+in the Construction of BVHs, Octrees, and k-d Trees", 2012). Each step runs on
+several threads. Such a tree only splits where the grid does, so it can optionally
+be improved afterwards: every small treelet of nodes is rearranged into whichever
+shape has the lowest surface area heuristic cost (Karras and Aila, "Fast Parallel
+Construction of High-Quality Bounding Volume Hierarchies", 2013).
+
+Besides finding the box containing a point, the tree answers "which K boxes are
+closest to this point". That search is best-first: nodes wait in a queue ordered by
+how far their AABB is from the point, and the K best boxes so far are kept in a
+heap. Once the nearest waiting node is further away than the worst of the K best
+boxes, nothing left can be closer and the search stops. Distances to the boxes
+themselves are exact, measured in each box's local space.
+
+Points from a scan usually arrive close to their neighbours, and one at a time they
+would each walk nearly the same path down the tree. The batch FindContaining sorts
+them along a Z-order curve and sends them down in packets of up to PACKET_SIZE, with
+a mask of which points are still in play. Each node's box is tested against every
+point of the packet at once, and a point only leaves the packet's path where its
+own path differs.
+*/
+
+#ifndef _COLLIDER_BVH_H
+#define _COLLIDER_BVH_H
+
+#include <cstdint>
+#include <vector>
+#include "CollisionScene.h"
+
+//The most points which go through a ColliderBVH together as one packet
+#define PACKET_SIZE 16
+
+//A node in a ColliderBVH
+struct BVHNode
+{
+	AABB bounds;
+	int start;	//Leaf: the first entry in the BVH's indices. Otherwise: the first child
+	int count;	//Leaf: the number of colliders in it. Otherwise: 0
+};
+
+class ColliderBVH
+{
+public:
+	ColliderBVH(void);
+
+	///
+	//Copies a tree. A copy of an attached tree reads the same attached arrays.
+	ColliderBVH(const ColliderBVH &other);
+	ColliderBVH &operator=(const ColliderBVH &other);
+
+	///
+	//Builds the tree over every collider in a scene
+	//
+	//Parameters:
+	//	scene: The scene to build over, which must outlive the tree
+	//	maxLeafSize: The most colliders to put in one leaf
+	void Build(const CollisionScene &scene, int maxLeafSize);
+
+	///
+	//Builds the tree over every collider in a scene from sorted Morton codes,
+	//with one collider in each leaf
+	//
+	//Parameters:
+	//	scene: The scene to build over, which must outlive the tree
+	//	numThreads: The number of threads to use, or 0 for one per hardware thread
+	//	optimizeTreelets: Whether to improve the tree with treelet rearrangement
+	void BuildLinear(const CollisionScene &scene, int numThreads, bool optimizeTreelets);
+
+	///
+	//Finds a collider containing a point
+	//
+	//Returns:
+	//	The index of a collider containing the point, or -1 if there is none
+	int FindContaining(glm::vec3 point) const;
+
+	///
+	//Finds a collider containing each of a batch of points, sending packets of
+	//points which are close together through the tree as one
+	//
+	//Parameters:
+	//	x, y, z: The worldspace coordinates of the points
+	//	count: The number of points
+	//	results: Receives the index of a collider containing each point, or -1
+	//	packetSize: The number of points in a packet, from 1 up to PACKET_SIZE
+	//	numThreads: The number of threads to use, or 0 for one per hardware thread
+	//
+	//Returns:
+	//	The number of nodes visited, counting a visit by a whole packet once
+	long long FindContaining(const float* x, const float* y, const float* z, int count, int* results, int packetSize, int numThreads) const;
+
+	///
+	//Finds the k colliders closest to a point
+	//
+	//Parameters:
+	//	point: The point in worldspace
+	//	k: The number of colliders to find
+	//	indices: Receives the indices of the colliders, nearest first
+	//	distances: Receives the squared distance to each, may be null
+	//
+	//Returns:
+	//	The number found, which is only less than k if the scene is smaller than k
+	int KNearest(glm::vec3 point, int k, int* indices, float* distances) const;
+
+	///
+	//Finds the k colliders closest to each of a batch of points
+	//
+	//Parameters:
+	//	x, y, z: The worldspace coordinates of the points
+	//	count: The number of points
+	//	k: The number of colliders to find for each point
+	//	indices: Receives k indices per point, nearest first, padded with -1
+	//	distances: Receives k squared distances per point, may be null
+	//	numThreads: The number of threads to use, or 0 for one per hardware thread
+	void KNearest(const float* x, const float* y, const float* z, int count, int k, int* indices, float* distances, int numThreads) const;
+
+	///
+	//Uses a tree which was built earlier, such as one mapped from a BVHCache file,
+	//in place of building one. The arrays are not copied, so must outlive the tree.
+	//Every node and index is checked first, since they may come from a damaged file.
+	//
+	//Parameters:
+	//	scene: The scene the tree was built over, which must outlive the tree
+	//	nodes: The nodes, root first
+	//	numNodes: The number of nodes
+	//	indices: The collider indices the leaves refer to
+	//	numIndices: The number of collider indices
+	//
+	//Returns:
+	//	false, leaving the tree empty, if the arrays are not a tree over the scene
+	bool Attach(const CollisionScene &scene, const BVHNode* nodes, int numNodes, const int* indices, int numIndices);
+
+	const BVHNode* Nodes(void) const;
+	int NumNodes(void) const;
+	const int* Indices(void) const;
+	int NumIndices(void) const;
+
+private:
+	void BuildNode(int node, int start, int count, int maxLeafSize);
+	int FindContainingPacket(const float* x, const float* y, const float* z, uint32_t active, int* results) const;
+	void OptimizeTreelets(std::vector<float> &cost, int numThreads);
+	void OptimizeTreelet(int root, std::vector<float> &cost);
+	int Depth(void) const;
+	void UseOwnArrays(void);
+	void UseArraysOf(const ColliderBVH &other, bool owned);
+
+	const CollisionScene* scene;
+	HugeVector<BVHNode> nodes;
+	HugeVector<int> indices;	//Collider indices, ordered so every leaf's are together
+
+	//The arrays the queries read, which are either the two above or attached ones
+	const BVHNode* nodeData;
+	int numNodes;
+	const int* indexData;
+	int numIndices;
+};
+
+#endif _COLLIDER_BVH_H
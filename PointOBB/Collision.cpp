@@ -0,0 +1,253 @@
+/*
+Title: Point - OBB
+File Name: Collision.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+This algorithm tests for collisions between a point and an OBB by determining if
+the point lies between bounds of the OBB on the OBB's local X, Y, and Z axis. If
+this is true for all 3 axis, we have a collision. We are able to do this by first
+transforming the point into a space of which the origin is at the center of the OBB.
+Then we can get the scalar projection of the point onto the OBB's local axes by utilizing the
+dot product. Finally, if the number returned from the scalar projection is within the min
+and max bounds of the OBB on that axis, we know there is a collision on that axis.
+*/
+
+//Every path below rounds the projections identically, so results do not depend
+//on the build, the SIMD width, or how the points were split between threads
+#include "NoContract.h"
+#include "Collision.h"
+#include "Prefetch.h"
+
+//The number of coordinates in one cache line of a stream
+static const int FLOATS_PER_LINE = CACHE_LINE_SIZE / sizeof(float);
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_SSE
+#endif
+
+///
+//Tests for collisions between a point and an oriented bounding box
+//
+//Overview:
+//	This algorithm tests for collisions between a point and an OBB by determining if
+//	the point lies between bounds of the OBB on the OBB's local X, Y, and Z axis. If
+//	this is true for all 3 axis, we have a collision. We are able to do this by first
+//	transforming the point into a space of which the origin is at the center of the OBB.
+//	Then we can get the scalar projection of the point onto the OBB's local axes by utilizing the
+//	dot product. Finally, if the number returned from the scalar projection is within the min
+//	and max bounds of the OBB on that axis, we know there is a collision on that axis.
+//
+//Parameters:
+//	boxCollider: The AABB to test
+//	boxTranslation: The box's translation transformation matrix
+//		(Tip: We just need the position of the box in worldspace, so feel free to just use a vec3
+//			  if it suits your implementation better.)
+//	boxRotation: the box's rotation transformation matrix
+//	boxScale: The box's scale transformation matrix
+//	point: The point in worldspace
+//
+//Returns:
+//	true if a collision is detected, else false
+bool TestCollision(const OBB &boxCollider, const glm::mat4 &boxTranslation, const glm::mat4 &boxRotation, const glm::mat4 &boxScale, glm::vec3 point)
+{
+	//Translate the point to a coordinate system centered on the box
+	point += glm::vec3(-boxTranslation[3][0], -boxTranslation[3][1], -boxTranslation[3][2]);
+
+	//Get the minimum and maximum points on the AABB
+	glm::vec3 min(-boxCollider.width / 2.0f, -boxCollider.height / 2.0f, -boxCollider.depth / 2.0f);
+	glm::vec3 max(boxCollider.width / 2.0f, boxCollider.height / 2.0f, boxCollider.depth / 2.0f);
+
+	//scale the min and max by the box's dimensions
+	min = glm::vec3(boxScale * glm::vec4(min, 1.0f));
+	max = glm::vec3(boxScale * glm::vec4(max, 1.0f));
+
+	//Get the scalar projection of the point onto each of the box's axes and compare
+	float sProjX = glm::dot(glm::vec3(boxRotation[0][0], boxRotation[0][1], boxRotation[0][2]), point);
+	if (min.x <= sProjX && sProjX <= max.x)
+	{
+		float sProjY = glm::dot(glm::vec3(boxRotation[1][0], boxRotation[1][1], boxRotation[1][2]), point);
+		if (min.y <= sProjY && sProjY <= max.y)
+		{
+			float sProjZ = glm::dot(glm::vec3(boxRotation[2][0], boxRotation[2][1], boxRotation[2][2]), point);
+			if (min.z <= sProjZ && sProjZ <= max.z)
+				return true;
+		}
+
+	}
+
+
+	return false;
+}
+
+///
+//Pulls the position, axes, and scaled bounds of a box out of its transformations
+//
+//Parameters:
+//	boxCollider: The OBB to prepare
+//	boxTranslation: The box's translation transformation matrix
+//	boxRotation: the box's rotation transformation matrix
+//	boxScale: The box's scale transformation matrix
+//
+//Returns:
+//	The collider in the form used by the prepared tests
+OBBCollider PrepareCollider(const OBB &boxCollider, const glm::mat4 &boxTranslation, const glm::mat4 &boxRotation, const glm::mat4 &boxScale)
+{
+	OBBCollider collider;
+
+	collider.center = glm::vec3(boxTranslation[3][0], boxTranslation[3][1], boxTranslation[3][2]);
+
+	collider.axes[0] = glm::vec3(boxRotation[0][0], boxRotation[0][1], boxRotation[0][2]);
+	collider.axes[1] = glm::vec3(boxRotation[1][0], boxRotation[1][1], boxRotation[1][2]);
+	collider.axes[2] = glm::vec3(boxRotation[2][0], boxRotation[2][1], boxRotation[2][2]);
+
+	//Scale the bounds exactly as TestCollision does
+	glm::vec3 min(-boxCollider.width / 2.0f, -boxCollider.height / 2.0f, -boxCollider.depth / 2.0f);
+	glm::vec3 max(boxCollider.width / 2.0f, boxCollider.height / 2.0f, boxCollider.depth / 2.0f);
+	collider.min = glm::vec3(boxScale * glm::vec4(min, 1.0f));
+	collider.max = glm::vec3(boxScale * glm::vec4(max, 1.0f));
+
+	return collider;
+}
+
+///
+//Tests for collisions between a point and a prepared oriented bounding box
+//
+//Parameters:
+//	collider: The prepared OBB to test
+//	point: The point in worldspace
+//
+//Returns:
+//	true if a collision is detected, else false
+bool TestCollision(const OBBCollider &collider, glm::vec3 point)
+{
+	point -= collider.center;
+
+	float sProjX = glm::dot(collider.axes[0], point);
+	if (collider.min.x <= sProjX && sProjX <= collider.max.x)
+	{
+		float sProjY = glm::dot(collider.axes[1], point);
+		if (collider.min.y <= sProjY && sProjY <= collider.max.y)
+		{
+			float sProjZ = glm::dot(collider.axes[2], point);
+			if (collider.min.z <= sProjZ && sProjZ <= collider.max.z)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+///
+//Gets the squared distance from a point to the closest point on or in a prepared OBB
+//
+//Parameters:
+//	collider: The prepared OBB, whose axes must be unit length and perpendicular
+//	point: The point in worldspace
+//
+//Returns:
+//	The squared distance, which is 0 if the point is inside the box
+float DistanceSquared(const OBBCollider &collider, glm::vec3 point)
+{
+	point -= collider.center;
+
+	float distance = 0.0f;
+	for (int a = 0; a < 3; a++)
+	{
+		float sProj = glm::dot(collider.axes[a], point);
+		float outside = sProj - glm::clamp(sProj, collider.min[a], collider.max[a]);
+		distance += outside * outside;
+	}
+
+	return distance;
+}
+
+///
+//Tests a batch of points against a prepared oriented bounding box
+//
+//Parameters:
+//	collider: The prepared OBB to test
+//	x, y, z: The worldspace coordinates of the points
+//	count: The number of points
+//	results: Receives 1 for each point inside the box, else 0
+void TestCollisions(const OBBCollider &collider, const float* x, const float* y, const float* z, int count, unsigned char* results)
+{
+	int i = 0;
+
+#ifdef COLLISION_SSE
+	//Splat the collider into registers once for the whole batch
+	__m128 cx = _mm_set1_ps(collider.center.x);
+	__m128 cy = _mm_set1_ps(collider.center.y);
+	__m128 cz = _mm_set1_ps(collider.center.z);
+	__m128 ax[3], ay[3], az[3], lo[3], hi[3];
+	for (int a = 0; a < 3; a++)
+	{
+		ax[a] = _mm_set1_ps(collider.axes[a].x);
+		ay[a] = _mm_set1_ps(collider.axes[a].y);
+		az[a] = _mm_set1_ps(collider.axes[a].z);
+		lo[a] = _mm_set1_ps(collider.min[a]);
+		hi[a] = _mm_set1_ps(collider.max[a]);
+	}
+
+	int ahead = PrefetchDistance() * FLOATS_PER_LINE;
+	for (; i + 4 <= count; i += 4)
+	{
+		//Ask for the next streams' lines once per cache line of points
+		if (ahead > 0 && (i & (FLOATS_PER_LINE - 1)) == 0 && i + ahead < count)
+		{
+			Prefetch(x + i + ahead);
+			Prefetch(y + i + ahead);
+			Prefetch(z + i + ahead);
+		}
+
+		__m128 px = _mm_sub_ps(_mm_loadu_ps(x + i), cx);
+		__m128 py = _mm_sub_ps(_mm_loadu_ps(y + i), cy);
+		__m128 pz = _mm_sub_ps(_mm_loadu_ps(z + i), cz);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int a = 0; a < 3; a++)
+		{
+			__m128 sProj = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[a], px), _mm_mul_ps(ay[a], py)), _mm_mul_ps(az[a], pz));
+			inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(lo[a], sProj), _mm_cmple_ps(sProj, hi[a])));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		results[i + 0] = (unsigned char)(mask & 1);
+		results[i + 1] = (unsigned char)((mask >> 1) & 1);
+		results[i + 2] = (unsigned char)((mask >> 2) & 1);
+		results[i + 3] = (unsigned char)((mask >> 3) & 1);
+	}
+#endif
+
+	//Whatever is left over (or everything, without SSE)
+	for (; i < count; i++)
+	{
+		glm::vec3 p(x[i] - collider.center.x, y[i] - collider.center.y, z[i] - collider.center.z);
+		bool inside = true;
+		for (int a = 0; a < 3; a++)
+		{
+			float sProj = collider.axes[a].x * p.x + collider.axes[a].y * p.y + collider.axes[a].z * p.z;
+			inside &= (collider.min[a] <= sProj) & (sProj <= collider.max[a]);
+		}
+		results[i] = inside ? 1 : 0;
+	}
+}
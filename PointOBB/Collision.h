@@ -0,0 +1,143 @@
+/*
+Title: Point - OBB
+File Name: Collision.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+The OBB collider and the point - OBB collision tests.
+TestCollision is the original test used by the demo. OBBCollider holds the same
+data after it has been pulled out of the box's transformation matrices once, so
+that many points can be tested against one box without redoing that work for
+every point. TestCollisions runs that test over a batch of points stored as
+separate x, y, and z arrays.
+*/
+
+#ifndef _COLLISION_H
+#define _COLLISION_H
+
+#include "glm\glm.hpp"
+
+//An OBB Collider struct
+struct OBB
+{
+	float width, height, depth;
+
+	///
+	//Default constructor creating an OBB of unit
+	//Width, height, and depth (-1.0f to 1.0f on each axis)
+	OBB()
+	{
+		width = height = depth = 2.0f;
+	}
+
+	///
+	//Parameterized constructor creating an OBB of specified
+	//width, height, and depth
+	OBB(float w, float h, float d)
+	{
+		width = w;
+		height = h;
+		depth = d;
+	}
+};
+
+//An OBB with its transformations already applied
+struct OBBCollider
+{
+	glm::vec3 center;	//The position of the box in worldspace
+	glm::vec3 axes[3];	//The box's local X, Y, and Z axes in worldspace
+	glm::vec3 min;		//The scaled minimum bounds on each local axis
+	glm::vec3 max;		//The scaled maximum bounds on each local axis
+};
+
+///
+//Tests for collisions between a point and an oriented bounding box
+//
+//Parameters:
+//	boxCollider: The OBB to test
+//	boxTranslation: The box's translation transformation matrix
+//	boxRotation: the box's rotation transformation matrix
+//	boxScale: The box's scale transformation matrix
+//	point: The point in worldspace
+//
+//Returns:
+//	true if a collision is detected, else false
+bool TestCollision(const OBB &boxCollider, const glm::mat4 &boxTranslation, const glm::mat4 &boxRotation, const glm::mat4 &boxScale, glm::vec3 point);
+
+///
+//Pulls the position, axes, and scaled bounds of a box out of its transformations
+//
+//Parameters:
+//	boxCollider: The OBB to prepare
+//	boxTranslation: The box's translation transformation matrix
+//	boxRotation: the box's rotation transformation matrix
+//	boxScale: The box's scale transformation matrix
+//
+//Returns:
+//	The collider in the form used by the prepared tests
+OBBCollider PrepareCollider(const OBB &boxCollider, const glm::mat4 &boxTranslation, const glm::mat4 &boxRotation, const glm::mat4 &boxScale);
+
+///
+//Tests for collisions between a point and a prepared oriented bounding box
+//
+//Parameters:
+//	collider: The prepared OBB to test
+//	point: The point in worldspace
+//
+//Returns:
+//	true if a collision is detected, else false
+bool TestCollision(const OBBCollider &collider, glm::vec3 point);
+
+///
+//Gets the squared distance from a point to the closest point on or in a prepared OBB
+//
+//Overview:
+//	The point is moved into the box's local space, where the box is just the
+//	ranges [min, max] on each axis. The closest point in the box is the local
+//	point clamped to those ranges, and since the axes are at right angles to
+//	each other the distance can be measured there too.
+//
+//Parameters:
+//	collider: The prepared OBB, whose axes must be unit length and perpendicular
+//	point: The point in worldspace
+//
+//Returns:
+//	The squared distance, which is 0 if the point is inside the box
+float DistanceSquared(const OBBCollider &collider, glm::vec3 point);
+
+///
+//Tests a batch of points against a prepared oriented bounding box
+//
+//Overview:
+//	Every point is tested on all three axes without early outs, so the loop
+//	has no branches and is run four points at a time where SSE is available.
+//	Each projection is always summed as (ax * px + ay * py) + az * pz, the same
+//	order glm::dot uses, so a point gets the same answer here as from
+//	TestCollision no matter which path or batch it went through.
+//
+//Parameters:
+//	collider: The prepared OBB to test
+//	x, y, z: The worldspace coordinates of the points
+//	count: The number of points
+//	results: Receives 1 for each point inside the box, else 0
+void TestCollisions(const OBBCollider &collider, const float* x, const float* y, const float* z, int count, unsigned char* results);
+
+#endif _COLLISION_H
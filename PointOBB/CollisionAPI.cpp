@@ -0,0 +1,273 @@
+/*
+Title: Point - OBB
+File Name: CollisionAPI.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A plain C interface to the collision tests. See CollisionAPI.h.
+*/
+
+#include "CollisionAPI.h"
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <vector>
+#include "ColliderBVH.h"
+
+//How many points are tested at once when they have to be gathered from a stride
+static const int GATHER_BLOCK = 256;
+
+//How many points are sorted and sent through the tree in packets at once
+static const int FIND_BLOCK = 1 << 16;
+
+//The number of points in a packet sent through the tree
+static const int FIND_PACKET_SIZE = 8;
+
+static_assert(sizeof(int) == sizeof(int32_t), "results are written as int32_t");
+
+//The most colliders a BVH leaf holds
+static const int LEAF_SIZE = 4;
+
+struct POBB_Scene
+{
+	CollisionScene scene;
+	ColliderBVH bvh;
+	bool built;
+
+	//Queries share this, changes take it alone
+	mutable std::shared_timed_mutex lock;
+};
+
+///
+//Reads a point out of the caller's buffers
+static glm::vec3 ReadPoint(const float* x, const float* y, const float* z, size_t stride, int64_t i)
+{
+	size_t offset = (size_t)i * stride;
+	return glm::vec3(*(const float*)((const char*)x + offset), *(const float*)((const char*)y + offset), *(const float*)((const char*)z + offset));
+}
+
+///
+//Makes an OBBCollider from the arrays given to POBB_AddCollider
+static OBBCollider MakeCollider(const float center[3], const float axes[9], const float min[3], const float max[3])
+{
+	OBBCollider collider;
+	collider.center = glm::vec3(center[0], center[1], center[2]);
+	for (int a = 0; a < 3; a++)
+	{
+		collider.axes[a] = glm::vec3(axes[3 * a + 0], axes[3 * a + 1], axes[3 * a + 2]);
+		collider.min[a] = min[a];
+		collider.max[a] = max[a];
+	}
+	return collider;
+}
+
+///
+//Makes a glm matrix from 16 column-major floats
+static glm::mat4 MakeMatrix(const float m[16])
+{
+	glm::mat4 matrix;
+	for (int c = 0; c < 4; c++)
+		matrix[c] = glm::vec4(m[4 * c + 0], m[4 * c + 1], m[4 * c + 2], m[4 * c + 3]);
+	return matrix;
+}
+
+///
+//Adds a collider to a scene
+static int32_t AddCollider(POBB_Scene* scene, const OBBCollider &collider, int32_t* index)
+{
+	try
+	{
+		std::unique_lock<std::shared_timed_mutex> guard(scene->lock);
+		int added = scene->scene.Add(collider);
+		scene->built = false;
+		if (index != nullptr)
+			*index = added;
+		return POBB_OK;
+	}
+	catch (const std::bad_alloc &)
+	{
+		return POBB_ERROR_OUT_OF_MEMORY;
+	}
+}
+
+int32_t POBB_Version(void)
+{
+	return POBB_API_VERSION;
+}
+
+POBB_Scene* POBB_CreateScene(void)
+{
+	POBB_Scene* scene = new (std::nothrow) POBB_Scene();
+	if (scene != nullptr)
+		scene->built = false;
+	return scene;
+}
+
+void POBB_DestroyScene(POBB_Scene* scene)
+{
+	delete scene;
+}
+
+int32_t POBB_AddCollider(POBB_Scene* scene, const float center[3], const float axes[9], const float min[3], const float max[3], int32_t* index)
+{
+	if (scene == nullptr || center == nullptr || axes == nullptr || min == nullptr || max == nullptr)
+		return POBB_ERROR_INVALID_ARGUMENT;
+
+	return AddCollider(scene, MakeCollider(center, axes, min, max), index);
+}
+
+int32_t POBB_AddOBB(POBB_Scene* scene, float width, float height, float depth, const float translation[16], const float rotation[16], const float scale[16], int32_t* index)
+{
+	if (scene == nullptr || translation == nullptr || rotation == nullptr || scale == nullptr)
+		return POBB_ERROR_INVALID_ARGUMENT;
+
+	OBB box(width, height, depth);
+	return AddCollider(scene, PrepareCollider(box, MakeMatrix(translation), MakeMatrix(rotation), MakeMatrix(scale)), index);
+}
+
+int32_t POBB_SetCollider(POBB_Scene* scene, int32_t index, const float center[3], const float axes[9], const float min[3], const float max[3])
+{
+	if (scene == nullptr || center == nullptr || axes == nullptr || min == nullptr || max == nullptr)
+		return POBB_ERROR_INVALID_ARGUMENT;
+
+	std::unique_lock<std::shared_timed_mutex> guard(scene->lock);
+	if (index < 0 || index >= scene->scene.Size())
+		return POBB_ERROR_INVALID_ARGUMENT;
+
+	OBBCollider collider = MakeCollider(center, axes, min, max);
+	scene->scene.colliders[index] = collider;
+	scene->scene.bounds[index] = ComputeWorldAABB(collider);
+	scene->built = false;
+	return POBB_OK;
+}
+
+int32_t POBB_SceneSize(const POBB_Scene* scene)
+{
+	if (scene == nullptr)
+		return 0;
+
+	std::shared_lock<std::shared_timed_mutex> guard(scene->lock);
+	return scene->scene.Size();
+}
+
+int32_t POBB_BuildScene(POBB_Scene* scene)
+{
+	if (scene == nullptr)
+		return POBB_ERROR_INVALID_ARGUMENT;
+
+	try
+	{
+		std::unique_lock<std::shared_timed_mutex> guard(scene->lock);
+		scene->bvh.Build(scene->scene, LEAF_SIZE);
+		scene->built = true;
+		return POBB_OK;
+	}
+	catch (const std::bad_alloc &)
+	{
+		return POBB_ERROR_OUT_OF_MEMORY;
+	}
+}
+
+int32_t POBB_TestBox(const POBB_Scene* scene, int32_t box, const float* x, const float* y, const float* z, size_t stride, int64_t count, uint8_t* results)
+{
+	if (scene == nullptr || count < 0 || (count > 0 && (x == nullptr || y == nullptr || z == nullptr || results == nullptr)))
+		return POBB_ERROR_INVALID_ARGUMENT;
+
+	std::shared_lock<std::shared_timed_mutex> guard(scene->lock);
+	if (box < 0 || box >= scene->scene.Size())
+		return POBB_ERROR_INVALID_ARGUMENT;
+	const OBBCollider &collider = scene->scene.colliders[box];
+
+	//Separate arrays can go straight into the batch test
+	if (stride == sizeof(float))
+	{
+		for (int64_t start = 0; start < count; start += 1 << 30)
+		{
+			int n = (int)std::min<int64_t>(count - start, 1 << 30);
+			TestCollisions(collider, x + start, y + start, z + start, n, results + start);
+		}
+		return POBB_OK;
+	}
+
+	//Anything else is gathered a block at a time into arrays on the stack
+	float blockX[GATHER_BLOCK], blockY[GATHER_BLOCK], blockZ[GATHER_BLOCK];
+	for (int64_t start = 0; start < count; start += GATHER_BLOCK)
+	{
+		int n = (int)std::min<int64_t>(count - start, GATHER_BLOCK);
+		for (int i = 0; i < n; i++)
+		{
+			glm::vec3 point = ReadPoint(x, y, z, stride, start + i);
+			blockX[i] = point.x;
+			blockY[i] = point.y;
+			blockZ[i] = point.z;
+		}
+		TestCollisions(collider, blockX, blockY, blockZ, n, results + start);
+	}
+	return POBB_OK;
+}
+
+int32_t POBB_FindContaining(const POBB_Scene* scene, const float* x, const float* y, const float* z, size_t stride, int64_t count, int32_t* results)
+{
+	if (scene == nullptr || count < 0 || (count > 0 && (x == nullptr || y == nullptr || z == nullptr || results == nullptr)))
+		return POBB_ERROR_INVALID_ARGUMENT;
+
+	std::shared_lock<std::shared_timed_mutex> guard(scene->lock);
+	if (!scene->built)
+		return POBB_ERROR_NOT_BUILT;
+
+	//The calling thread does all the work, callers wanting more threads can split the batch
+	try
+	{
+		std::vector<float> blockX, blockY, blockZ;
+		if (stride != sizeof(float))
+		{
+			size_t size = (size_t)std::min<int64_t>(count, FIND_BLOCK);
+			blockX.resize(size);
+			blockY.resize(size);
+			blockZ.resize(size);
+		}
+
+		for (int64_t start = 0; start < count; start += FIND_BLOCK)
+		{
+			int n = (int)std::min<int64_t>(count - start, FIND_BLOCK);
+			if (stride == sizeof(float))
+			{
+				scene->bvh.FindContaining(x + start, y + start, z + start, n, (int*)results + start, FIND_PACKET_SIZE, 1);
+				continue;
+			}
+
+			for (int i = 0; i < n; i++)
+			{
+				glm::vec3 point = ReadPoint(x, y, z, stride, start + i);
+				blockX[i] = point.x;
+				blockY[i] = point.y;
+				blockZ[i] = point.z;
+			}
+			scene->bvh.FindContaining(blockX.data(), blockY.data(), blockZ.data(), n, (int*)results + start, FIND_PACKET_SIZE, 1);
+		}
+		return POBB_OK;
+	}
+	catch (const std::bad_alloc &)
+	{
+		return POBB_ERROR_OUT_OF_MEMORY;
+	}
+}
@@ -0,0 +1,155 @@
+/*
+Title: Point - OBB
+File Name: CollisionAPI.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A plain C interface to the collision tests, for calling from other languages
+(Python, Rust, C#) through their foreign function interfaces. Nothing here uses
+glm, references, or classes: boxes and points go in as float arrays, scenes are
+opaque handles, and every call returns a status code.
+
+Points are read out of the caller's buffers. Each of x, y, and z is a pointer to
+the first value and a stride in bytes to the next, so both separate arrays (stride
+sizeof(float)) and interleaved x, y, z triples (stride 3 * sizeof(float), with
+y = x + 1 and z = x + 2) work. Separate arrays are read in place with nothing
+copied. Any other stride costs a copy: POBB_TestBox gathers the points a few
+hundred at a time into separate arrays on the stack, which stay in the L1 cache,
+and POBB_FindContaining gathers them in larger blocks on the heap. Results are
+always written straight into the caller's array.
+
+Any number of threads may run queries on a scene at once. Adding or moving boxes
+waits for queries in progress and blocks new ones until it is done.
+
+The PointOBBLibrary project builds this interface into a DLL, defining POBB_EXPORTS.
+Programs which link against that DLL from C or C++ should define POBB_IMPORTS.
+*/
+
+#ifndef _COLLISION_API_H
+#define _COLLISION_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(POBB_EXPORTS)
+#define POBB_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(POBB_IMPORTS)
+#define POBB_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define POBB_API __attribute__((visibility("default")))
+#else
+#define POBB_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Bumped whenever a function's signature or behavior changes
+#define POBB_API_VERSION 1
+
+//Status codes
+#define POBB_OK 0
+#define POBB_ERROR_INVALID_ARGUMENT -1	//A null handle or pointer, or an index out of range
+#define POBB_ERROR_NOT_BUILT -2			//The scene has changed since POBB_BuildScene
+#define POBB_ERROR_OUT_OF_MEMORY -3
+
+//A scene of boxes
+typedef struct POBB_Scene POBB_Scene;
+
+///
+//Gets the version of the API the library was built with
+POBB_API int32_t POBB_Version(void);
+
+///
+//Makes an empty scene
+//
+//Returns:
+//	The scene, or null if it could not be allocated
+POBB_API POBB_Scene* POBB_CreateScene(void);
+
+///
+//Destroys a scene. No queries may be running on it.
+POBB_API void POBB_DestroyScene(POBB_Scene* scene);
+
+///
+//Adds a box to a scene, in the form of an OBBCollider
+//
+//Parameters:
+//	scene: The scene
+//	center: The x, y, z of the box's center in worldspace
+//	axes: The box's local X, Y, and Z axes in worldspace, 3 floats each
+//	min, max: The box's bounds along each of its axes, 3 floats each
+//	index: Receives the index of the new box, may be null
+POBB_API int32_t POBB_AddCollider(POBB_Scene* scene, const float center[3], const float axes[9], const float min[3], const float max[3], int32_t* index);
+
+///
+//Adds a box to a scene, in the form the demo keeps its box in
+//
+//Parameters:
+//	scene: The scene
+//	width, height, depth: The size of the OBB
+//	translation, rotation, scale: The box's transformation matrices, as 16 floats
+//		in column-major order (as given by glm::value_ptr)
+//	index: Receives the index of the new box, may be null
+POBB_API int32_t POBB_AddOBB(POBB_Scene* scene, float width, float height, float depth, const float translation[16], const float rotation[16], const float scale[16], int32_t* index);
+
+///
+//Moves a box already in a scene. The arguments are as for POBB_AddCollider.
+POBB_API int32_t POBB_SetCollider(POBB_Scene* scene, int32_t index, const float center[3], const float axes[9], const float min[3], const float max[3]);
+
+///
+//Gets the number of boxes in a scene
+POBB_API int32_t POBB_SceneSize(const POBB_Scene* scene);
+
+///
+//Builds the tree used by POBB_FindContaining. Call after adding or moving boxes.
+POBB_API int32_t POBB_BuildScene(POBB_Scene* scene);
+
+///
+//Tests a batch of points against one box of a scene
+//
+//Parameters:
+//	scene: The scene
+//	box: The index of the box
+//	x, y, z: The worldspace coordinates of the first point
+//	stride: The number of bytes from one point's coordinates to the next
+//	count: The number of points
+//	results: Receives 1 for each point inside the box, else 0
+POBB_API int32_t POBB_TestBox(const POBB_Scene* scene, int32_t box, const float* x, const float* y, const float* z, size_t stride, int64_t count, uint8_t* results);
+
+///
+//Finds a box containing each of a batch of points. The points are sorted along a
+//Z-order curve and sent through the scene's tree in packets of nearby points.
+//
+//Parameters:
+//	scene: The scene, which must have been built since it last changed
+//	x, y, z: The worldspace coordinates of the first point
+//	stride: The number of bytes from one point's coordinates to the next
+//	count: The number of points
+//	results: Receives the index of a box containing each point, or -1 if there is none
+POBB_API int32_t POBB_FindContaining(const POBB_Scene* scene, const float* x, const float* y, const float* z, size_t stride, int64_t count, int32_t* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif _COLLISION_API_H
@@ -0,0 +1,121 @@
+/*
+Title: Point - OBB
+File Name: CollisionAwait.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Lets a C++20 coroutine co_await a batch of point - OBB queries:
+
+	co_await CollisionQuery(workers, collider, x, y, z, count, results);
+
+The coroutine is suspended while the batch waits in the CollisionWorkers queue and
+is resumed, on the worker thread which ran the batch, as soon as the results are
+written. The QueryBatch lives inside the awaiter, which lives inside the coroutine
+frame, so a query allocates nothing of its own and any number of them may be in
+flight at once. If the queue is full the batch is run on the awaiting thread
+instead and the coroutine carries on without suspending, so awaiting from inside
+a worker can never wait on the workers themselves.
+
+Only available when the compiler supports C++20 coroutines.
+*/
+
+#ifndef _COLLISION_AWAIT_H
+#define _COLLISION_AWAIT_H
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define COLLISION_COROUTINES
+#endif
+#endif
+
+#ifdef COLLISION_COROUTINES
+
+#include <coroutine>
+#include "CollisionWorkers.h"
+
+class CollisionQuery
+{
+public:
+	///
+	//Sets up a batch of points to test against one box.
+	//Nothing is submitted until the query is awaited.
+	//
+	//Parameters:
+	//	workers: The pool to run the batch on
+	//	collider: The prepared OBB to test
+	//	x, y, z: The worldspace coordinates of the points
+	//	count: The number of points
+	//	results: Receives 1 for each point inside the box, else 0
+	CollisionQuery(CollisionWorkers &workers, const OBBCollider &collider, const float* x, const float* y, const float* z, int count, unsigned char* results)
+		: workers(workers)
+	{
+		this->batch.collider = collider;
+		this->batch.x = x;
+		this->batch.y = y;
+		this->batch.z = z;
+		this->batch.count = count;
+		this->batch.results = results;
+		this->batch.callback = &CollisionQuery::Resume;
+	}
+
+	///
+	//An empty batch has nothing to wait for
+	bool await_ready(void) const noexcept
+	{
+		return this->batch.count <= 0;
+	}
+
+	///
+	//Hands the batch to the workers along with the coroutine to resume
+	//
+	//Returns:
+	//	false if the queue was full and the batch was run here instead,
+	//	which resumes the coroutine straight away
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		this->batch.userData = handle.address();
+		if (this->workers.TrySubmit(&this->batch))
+			return true;
+
+		TestCollisions(this->batch.collider, this->batch.x, this->batch.y, this->batch.z, this->batch.count, this->batch.results);
+		return false;
+	}
+
+	void await_resume(void) const noexcept
+	{
+	}
+
+private:
+	///
+	//Runs on the worker thread once the batch is finished
+	static void Resume(QueryBatch* batch, void* userData)
+	{
+		(void)batch;
+		std::coroutine_handle<>::from_address(userData).resume();
+	}
+
+	CollisionWorkers &workers;
+	QueryBatch batch;
+};
+
+#endif COLLISION_COROUTINES
+
+#endif _COLLISION_AWAIT_H
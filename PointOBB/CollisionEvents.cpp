@@ -0,0 +1,167 @@
+/*
+Title: Point - OBB
+File Name: CollisionEvents.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Turns per-frame hit results into enter and exit events. See CollisionEvents.h.
+*/
+
+#include "CollisionEvents.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_SSE
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+///
+//Gets the index of the lowest set bit of a nonzero word
+static int LowestBit(uint64_t word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)word))
+		return (int)index;
+	_BitScanForward(&index, (unsigned long)(word >> 32));
+	return (int)index + 32;
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+///
+//Adds the index of every set bit in a word to a list
+static void ListBits(uint64_t word, int base, std::vector<int> &list)
+{
+	while (word != 0)
+	{
+		list.push_back(base + LowestBit(word));
+		word &= word - 1;
+	}
+}
+
+CollisionEvents::CollisionEvents(int numQueries)
+{
+	//Round up to a whole number of 128 bit blocks, so the SSE loop needs no tail
+	size_t numWords = ((size_t)std::max(numQueries, 0) + 127) / 128 * 2;
+	this->numQueries = numQueries;
+	this->last.assign(numWords, 0);
+	this->current.assign(numWords, 0);
+}
+
+void CollisionEvents::Update(const unsigned char* results)
+{
+	std::swap(this->last, this->current);
+
+	//Pack the result bytes into bits
+	uint64_t* bits = this->current.data();
+	std::fill(this->current.begin(), this->current.end(), 0);
+	int i = 0;
+
+#ifdef COLLISION_SSE
+	__m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= this->numQueries; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(results + i));
+		uint64_t mask = (uint64_t)(~_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)) & 0xffff);
+		bits[i >> 6] |= mask << (i & 63);
+	}
+#endif
+
+	for (; i < this->numQueries; i++)
+	{
+		if (results[i] != 0)
+			bits[i >> 6] |= (uint64_t)1 << (i & 63);
+	}
+
+	//Diff against the last frame and list the changes
+	this->entered.clear();
+	this->exited.clear();
+	const uint64_t* lastBits = this->last.data();
+	size_t numWords = this->current.size();
+	size_t w = 0;
+
+#ifdef COLLISION_SSE
+	for (; w + 2 <= numWords; w += 2)
+	{
+		__m128i now = _mm_loadu_si128((const __m128i*)(bits + w));
+		__m128i before = _mm_loadu_si128((const __m128i*)(lastBits + w));
+		__m128i changed = _mm_xor_si128(now, before);
+
+		//Nothing changed in these 128 queries, which is the common case
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(changed, zero)) == 0xffff)
+			continue;
+
+		uint64_t enter[2], exit[2];
+		_mm_storeu_si128((__m128i*)enter, _mm_and_si128(changed, now));
+		_mm_storeu_si128((__m128i*)exit, _mm_and_si128(changed, before));
+		for (int half = 0; half < 2; half++)
+		{
+			ListBits(enter[half], (int)(w + half) * 64, this->entered);
+			ListBits(exit[half], (int)(w + half) * 64, this->exited);
+		}
+	}
+#endif
+
+	for (; w < numWords; w++)
+	{
+		uint64_t changed = bits[w] ^ lastBits[w];
+		ListBits(changed & bits[w], (int)w * 64, this->entered);
+		ListBits(changed & lastBits[w], (int)w * 64, this->exited);
+	}
+}
+
+const std::vector<int> &CollisionEvents::Entered(void) const
+{
+	return this->entered;
+}
+
+const std::vector<int> &CollisionEvents::Exited(void) const
+{
+	return this->exited;
+}
+
+bool CollisionEvents::IsHit(int query) const
+{
+	return ((this->current[query >> 6] >> (query & 63)) & 1) != 0;
+}
+
+void CollisionEvents::Reset(void)
+{
+	std::fill(this->last.begin(), this->last.end(), 0);
+	std::fill(this->current.begin(), this->current.end(), 0);
+	this->entered.clear();
+	this->exited.clear();
+}
+
+int CollisionEvents::NumQueries(void) const
+{
+	return this->numQueries;
+}
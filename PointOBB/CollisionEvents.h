@@ -0,0 +1,85 @@
+/*
+Title: Point - OBB
+File Name: CollisionEvents.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Turns per-frame hit results into enter and exit events, so that code which only
+cares when a point starts or stops touching a box (like the demo's color change)
+does not have to keep the last frame's answers and compare them itself.
+
+The hits of the current and the last frame are each kept as a bitset, one bit per
+query. Which queries changed is then the XOR of the two, entered is changed AND
+current, and exited is changed AND last. This is done 128 queries at a time where
+SSE is available, and since most queries do not change from one frame to the
+next, the all-zero words are skipped over quickly when the events are listed.
+*/
+
+#ifndef _COLLISION_EVENTS_H
+#define _COLLISION_EVENTS_H
+
+#include <cstdint>
+#include <vector>
+
+class CollisionEvents
+{
+public:
+	///
+	//Makes an event tracker with no hits
+	//
+	//Parameters:
+	//	numQueries: The number of queries (for example points) in the set
+	CollisionEvents(int numQueries);
+
+	///
+	//Takes the results of a new frame and works out the events
+	//
+	//Parameters:
+	//	results: One byte per query, nonzero for a hit, as written by TestCollisions
+	void Update(const unsigned char* results);
+
+	///
+	//Gets the queries which hit this frame but not last frame, in ascending order
+	const std::vector<int> &Entered(void) const;
+
+	///
+	//Gets the queries which hit last frame but not this frame, in ascending order
+	const std::vector<int> &Exited(void) const;
+
+	///
+	//Gets whether a query hit this frame
+	bool IsHit(int query) const;
+
+	///
+	//Forgets every hit, so anything hitting next frame is an enter event
+	void Reset(void);
+
+	int NumQueries(void) const;
+
+private:
+	int numQueries;
+	std::vector<uint64_t> last;
+	std::vector<uint64_t> current;
+	std::vector<int> entered;
+	std::vector<int> exited;
+};
+
+#endif _COLLISION_EVENTS_H
@@ -0,0 +1,149 @@
+/*
+Title: Point - OBB
+File Name: CollisionScene.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A scene of many boxes for points to be tested against. See CollisionScene.h.
+*/
+
+//So PrepareColliders can match ComputeWorldAABB bit for bit
+#include "NoContract.h"
+#include "CollisionScene.h"
+
+int CollisionScene::Add(const OBBCollider &collider)
+{
+	this->colliders.push_back(collider);
+	this->bounds.push_back(ComputeWorldAABB(collider));
+	return (int)this->colliders.size() - 1;
+}
+
+void CollisionScene::UpdateBounds(void)
+{
+	this->bounds.resize(this->colliders.size());
+	for (size_t i = 0; i < this->colliders.size(); i++)
+		this->bounds[i] = ComputeWorldAABB(this->colliders[i]);
+}
+
+///
+//Computes the worldspace AABB which bounds a prepared OBB
+//
+//Overview:
+//	The box spans [min, max] along each of its axes. Its middle is moved off
+//	the center by the axes scaled by the middle of each span, and it reaches
+//	out from there by half of each span along each axis. Along a world axis,
+//	an OBB axis reaches out by the absolute value of its component on that axis.
+AABB ComputeWorldAABB(const OBBCollider &collider)
+{
+	glm::vec3 middle = collider.center;
+	glm::vec3 reach(0.0f);
+
+	for (int a = 0; a < 3; a++)
+	{
+		float mid = (collider.min[a] + collider.max[a]) * 0.5f;
+		float half = (collider.max[a] - collider.min[a]) * 0.5f;
+
+		middle += collider.axes[a] * mid;
+		reach += glm::abs(collider.axes[a]) * half;
+	}
+
+	AABB box;
+	box.min = middle - reach;
+	box.max = middle + reach;
+	return box;
+}
+
+bool Overlaps(const OBBCollider &collider, const AABB &box)
+{
+	//A tiny bit of slack so boxes with parallel edges are not wrongly
+	//separated by a cross product which is nearly zero
+	const float epsilon = 1e-6f;
+
+	glm::vec3 boxCenter = (box.min + box.max) * 0.5f;
+	glm::vec3 boxHalf = (box.max - box.min) * 0.5f;
+
+	//The middle of the OBB and its half extents along its own axes
+	glm::vec3 middle = collider.center;
+	glm::vec3 half;
+	for (int a = 0; a < 3; a++)
+	{
+		middle += collider.axes[a] * ((collider.min[a] + collider.max[a]) * 0.5f);
+		half[a] = (collider.max[a] - collider.min[a]) * 0.5f;
+	}
+
+	//R[i][j] is the OBB's axis j along world axis i
+	float R[3][3], absR[3][3];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			R[i][j] = collider.axes[j][i];
+			absR[i][j] = glm::abs(R[i][j]) + epsilon;
+		}
+	}
+
+	glm::vec3 t = middle - boxCenter;
+
+	//The world axes
+	for (int i = 0; i < 3; i++)
+	{
+		float reach = boxHalf[i] + half[0] * absR[i][0] + half[1] * absR[i][1] + half[2] * absR[i][2];
+		if (glm::abs(t[i]) > reach)
+			return false;
+	}
+
+	//The OBB's axes
+	for (int j = 0; j < 3; j++)
+	{
+		float reach = boxHalf[0] * absR[0][j] + boxHalf[1] * absR[1][j] + boxHalf[2] * absR[2][j] + half[j];
+		float distance = t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j];
+		if (glm::abs(distance) > reach)
+			return false;
+	}
+
+	//World axis i crossed with OBB axis j
+	for (int i = 0; i < 3; i++)
+	{
+		int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; j++)
+		{
+			int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+			float reach = boxHalf[i1] * absR[i2][j] + boxHalf[i2] * absR[i1][j] + half[j1] * absR[i][j2] + half[j2] * absR[i][j1];
+			float distance = t[i2] * R[i1][j] - t[i1] * R[i2][j];
+			if (glm::abs(distance) > reach)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+int FindContainingCollider(const CollisionScene &scene, glm::vec3 point)
+{
+	for (int i = 0; i < scene.Size(); i++)
+	{
+		//Only do the OBB test if the cheaper AABB test passes
+		if (Contains(scene.bounds[i], point) && TestCollision(scene.colliders[i], point))
+			return i;
+	}
+
+	return -1;
+}
@@ -0,0 +1,114 @@
+/*
+Title: Point - OBB
+File Name: CollisionScene.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A scene of many boxes for points to be tested against. Each box is kept as a
+prepared OBBCollider along with the axis-aligned box which bounds it in worldspace,
+which is much cheaper to test and lets most boxes be skipped without doing the
+full OBB test.
+*/
+
+#ifndef _COLLISION_SCENE_H
+#define _COLLISION_SCENE_H
+
+#include <vector>
+#include "Collision.h"
+#include "HugePages.h"
+
+//An axis-aligned bounding box in worldspace
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct CollisionScene
+{
+	HugeVector<OBBCollider> colliders;
+	HugeVector<AABB> bounds;	//bounds[i] holds colliders[i]
+
+	///
+	//Adds a box to the scene
+	//
+	//Returns:
+	//	The index of the new collider
+	int Add(const OBBCollider &collider);
+
+	///
+	//Recomputes the bounds of every collider, after they have been moved
+	void UpdateBounds(void);
+
+	///
+	//Gets the number of colliders in the scene
+	int Size(void) const
+	{
+		return (int)this->colliders.size();
+	}
+};
+
+///
+//Computes the worldspace AABB which bounds a prepared OBB
+AABB ComputeWorldAABB(const OBBCollider &collider);
+
+///
+//Tests whether a point is inside an AABB
+inline bool Contains(const AABB &box, const glm::vec3 &point)
+{
+	return box.min.x <= point.x && point.x <= box.max.x &&
+		box.min.y <= point.y && point.y <= box.max.y &&
+		box.min.z <= point.z && point.z <= box.max.z;
+}
+
+///
+//Gets the squared distance from a point to the closest point in an AABB
+inline float DistanceSquared(const AABB &box, const glm::vec3 &point)
+{
+	glm::vec3 outside = point - glm::clamp(point, box.min, box.max);
+	return glm::dot(outside, outside);
+}
+
+///
+//Tests whether a prepared OBB and an AABB overlap
+//
+//Overview:
+//	By the separating axis theorem, two boxes are apart exactly when there is a
+//	line they can both be projected onto without their projections overlapping.
+//	For two boxes it is enough to try the 3 axes of each box and the 9 cross
+//	products of an axis from each, 15 lines in all.
+//
+//Parameters:
+//	collider: The prepared OBB, whose axes must be unit length and perpendicular
+//	box: The AABB
+//
+//Returns:
+//	true if they overlap or touch, else false
+bool Overlaps(const OBBCollider &collider, const AABB &box);
+
+///
+//Finds a collider containing a point by testing every collider in the scene
+//
+//Returns:
+//	The index of the first collider containing the point, or -1 if there is none
+int FindContainingCollider(const CollisionScene &scene, glm::vec3 point);
+
+#endif _COLLISION_SCENE_H
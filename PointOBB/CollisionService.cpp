@@ -0,0 +1,534 @@
+/*
+Title: Point - OBB
+File Name: CollisionService.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Runs the point - OBB tests as a service for other processes on the same machine.
+See CollisionService.h.
+*/
+
+#include "CollisionService.h"
+#include "CollisionWorkers.h"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//The most requests read from a client in one go
+static const int MAX_PIPELINED = 64;
+//How often, in milliseconds, the service checks for a shutdown
+static const int SHUTDOWN_POLL_MS = 100;
+
+///
+//Writes all of a buffer to a socket
+static bool WriteAll(int fd, const void* data, size_t size)
+{
+	const char* bytes = (const char*)data;
+	while (size > 0)
+	{
+		ssize_t written = send(fd, bytes, size, MSG_NOSIGNAL);
+		if (written <= 0)
+			return false;
+		bytes += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+///
+//Reads all of a buffer from a socket
+static bool ReadAll(int fd, void* data, size_t size)
+{
+	char* bytes = (char*)data;
+	while (size > 0)
+	{
+		ssize_t got = read(fd, bytes, size);
+		if (got <= 0)
+			return false;
+		bytes += got;
+		size -= (size_t)got;
+	}
+	return true;
+}
+
+///
+//Checks that an array of count elements of the given size fits in the shared memory
+static bool InBounds(uint64_t offset, uint32_t count, size_t elementSize, size_t sharedBytes)
+{
+	uint64_t bytes = (uint64_t)count * elementSize;
+	return offset <= sharedBytes && bytes <= sharedBytes - offset;
+}
+
+///
+//Checks that an array of floats starts in the shared memory on a float boundary.
+//The mapping itself starts on a page boundary, so only the offset matters.
+static bool FloatsInBounds(uint64_t offset, uint32_t count, size_t sharedBytes)
+{
+	return offset % sizeof(float) == 0 && InBounds(offset, count, sizeof(float), sharedBytes);
+}
+
+//The most descriptors accepted in the message carrying the memfd. Only one is
+//wanted, but room for a few more lets extra ones be seen and closed instead of
+//being dropped by the kernel with only a truncation flag to show for it.
+static const int MAX_PASSED_FDS = 4;
+
+//A connected client
+struct Connection
+{
+	int socket;
+	unsigned char* shared;		//Null until the client has sent its memfd
+	size_t sharedBytes;
+
+	//Requests read so far, the last of which may only be partly read
+	ServiceRequest requests[MAX_PIPELINED];
+	size_t buffered;
+
+	//The batches and responses of the requests being answered
+	QueryBatch batches[MAX_PIPELINED];
+	ServiceResponse responses[MAX_PIPELINED];
+	int numRequests;
+
+	//Set while the workers run a round of requests. The service neither reads
+	//from nor closes the connection until the round's responses are sent.
+	std::atomic<bool> busy;
+	//Counts down the round's batches, plus one held by the service while posting
+	std::atomic<int> pending;
+	//Set if the responses could not be sent, so the connection should be closed
+	std::atomic<bool> failed;
+
+	//Signalled when a round finishes, so the service polls the connection again
+	int wakeFd;
+
+	Connection(int socket, int wakeFd)
+	{
+		this->socket = socket;
+		this->shared = nullptr;
+		this->sharedBytes = 0;
+		this->buffered = 0;
+		this->numRequests = 0;
+		this->busy.store(false);
+		this->pending.store(0);
+		this->failed.store(false);
+		this->wakeFd = wakeFd;
+	}
+
+	~Connection(void)
+	{
+		if (this->shared != nullptr)
+			munmap(this->shared, this->sharedBytes);
+		close(this->socket);
+	}
+
+private:
+	Connection(const Connection &);
+	Connection &operator=(const Connection &);
+};
+
+///
+//Reads the client's first message, which carries its memfd, and maps the memory
+//
+//Overview:
+//	Descriptors arrive already marked close-on-exec. Every descriptor received is
+//	closed again, whether or not it is used: the mapping keeps the memory alive on
+//	its own, and a message with more than one descriptor, or with some of them cut
+//	off, is refused.
+//
+//Returns:
+//	false if the message or the memory was not what the service expects
+static bool ReceiveMemory(Connection &connection)
+{
+	char byte;
+	char control[CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)];
+	struct iovec iov = { &byte, 1 };
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	if (recvmsg(connection.socket, &msg, MSG_CMSG_CLOEXEC) <= 0)
+		return false;
+
+	int fds[MAX_PASSED_FDS];
+	int numFds = 0;
+	for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+		int count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+		for (int i = 0; i < count && numFds < MAX_PASSED_FDS; i++)
+			memcpy(&fds[numFds++], CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+	}
+
+	//Only map memory the client can no longer shrink, or a later access past
+	//its new end would kill the whole service with SIGBUS
+	if (numFds == 1 && (msg.msg_flags & MSG_CTRUNC) == 0)
+	{
+		struct stat info;
+		int seals = fcntl(fds[0], F_GET_SEALS);
+		if (seals >= 0 && (seals & F_SEAL_SHRINK) != 0 && fstat(fds[0], &info) == 0 && info.st_size > 0)
+		{
+			void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+			if (mapped != MAP_FAILED)
+			{
+				connection.shared = (unsigned char*)mapped;
+				connection.sharedBytes = (size_t)info.st_size;
+			}
+		}
+	}
+
+	for (int i = 0; i < numFds; i++)
+		close(fds[i]);
+	return connection.shared != nullptr;
+}
+
+///
+//Sends a finished round's responses and lets the service read from the client again.
+//Runs on whichever thread finished the round's last batch.
+static void FinishRound(Connection* connection)
+{
+	if (!WriteAll(connection->socket, connection->responses, connection->numRequests * sizeof(ServiceResponse)))
+		connection->failed.store(true);
+
+	//The service may close the connection as soon as it is not busy
+	int wakeFd = connection->wakeFd;
+	connection->busy.store(false);
+	uint64_t one = 1;
+	ssize_t written = write(wakeFd, &one, sizeof(one));
+	(void)written;
+}
+
+///
+//Called on a worker thread when one request's batch is finished
+static void BatchFinished(QueryBatch* batch, void* userData)
+{
+	Connection* connection = (Connection*)userData;
+	ServiceResponse &response = connection->responses[batch - connection->batches];
+	for (int p = 0; p < batch->count; p++)
+		response.hits += batch->results[p];
+
+	if (connection->pending.fetch_sub(1) == 1)
+		FinishRound(connection);
+}
+
+///
+//Reads whatever requests have arrived from a client and hands them to the workers
+//
+//Returns:
+//	false if the client has disconnected
+static bool ReadRequests(Connection &connection, CollisionWorkers &workers)
+{
+	ssize_t got = read(connection.socket, (char*)connection.requests + connection.buffered, sizeof(connection.requests) - connection.buffered);
+	if (got <= 0)
+		return false;
+	connection.buffered += (size_t)got;
+
+	//Take every whole request which has arrived, so pipelined requests are run together
+	int numRequests = (int)(connection.buffered / sizeof(ServiceRequest));
+	if (numRequests == 0)
+		return true;
+
+	connection.numRequests = numRequests;
+	connection.busy.store(true);
+	connection.pending.store(1);
+	for (int i = 0; i < numRequests; i++)
+	{
+		const ServiceRequest &request = connection.requests[i];
+		ServiceResponse &response = connection.responses[i];
+		response.id = request.id;
+		response.hits = 0;
+		response.status = 0;
+
+		if (!FloatsInBounds(request.xOffset, request.count, connection.sharedBytes) ||
+			!FloatsInBounds(request.yOffset, request.count, connection.sharedBytes) ||
+			!FloatsInBounds(request.zOffset, request.count, connection.sharedBytes) ||
+			!InBounds(request.resultOffset, request.count, 1, connection.sharedBytes))
+		{
+			response.status = -1;
+			continue;
+		}
+
+		QueryBatch &batch = connection.batches[i];
+		batch = QueryBatch();
+		batch.collider = request.collider;
+		batch.x = (const float*)(connection.shared + request.xOffset);
+		batch.y = (const float*)(connection.shared + request.yOffset);
+		batch.z = (const float*)(connection.shared + request.zOffset);
+		batch.count = (int)request.count;
+		batch.results = connection.shared + request.resultOffset;
+		batch.callback = BatchFinished;
+		batch.userData = &connection;
+
+		connection.pending.fetch_add(1);
+		workers.Post(&batch);
+	}
+
+	//Keep any partial request for the next read. The buffer is not read into
+	//again until the round is over, so it is safe to move now.
+	size_t used = numRequests * sizeof(ServiceRequest);
+	memmove(connection.requests, (char*)connection.requests + used, connection.buffered - used);
+	connection.buffered -= used;
+
+	//Let go of the service's hold on the round, finishing it if the workers already have
+	if (connection.pending.fetch_sub(1) == 1)
+		FinishRound(&connection);
+	return true;
+}
+
+bool RunCollisionService(const char* socketPath, int numThreads, const std::atomic<bool> &running)
+{
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(socketPath) >= sizeof(address.sun_path))
+		return false;
+	strcpy(address.sun_path, socketPath);
+
+	int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listener < 0)
+		return false;
+
+	unlink(socketPath);
+	if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 16) != 0)
+	{
+		close(listener);
+		return false;
+	}
+
+	int wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (wakeFd < 0)
+	{
+		close(listener);
+		return false;
+	}
+
+	std::vector<std::unique_ptr<Connection> > connections;
+	{
+		//Room for every connection's whole round before Post has to wait
+		CollisionWorkers workers(numThreads, MAX_PIPELINED * 16);
+
+		std::vector<struct pollfd> waiting;
+		std::vector<Connection*> polled;
+		while (running.load())
+		{
+			//Drop clients which have disconnected or could not be answered,
+			//once the workers are done with them
+			for (size_t i = 0; i < connections.size();)
+			{
+				if (connections[i]->failed.load() && !connections[i]->busy.load())
+				{
+					connections[i] = std::move(connections.back());
+					connections.pop_back();
+				}
+				else
+					i++;
+			}
+
+			//Wait on the listener, the wake signal, and every client not in a round
+			waiting.clear();
+			polled.clear();
+			struct pollfd listening = { listener, POLLIN, 0 };
+			struct pollfd woken = { wakeFd, POLLIN, 0 };
+			waiting.push_back(listening);
+			waiting.push_back(woken);
+			for (size_t i = 0; i < connections.size(); i++)
+			{
+				if (connections[i]->busy.load())
+					continue;
+				struct pollfd client = { connections[i]->socket, POLLIN, 0 };
+				waiting.push_back(client);
+				polled.push_back(connections[i].get());
+			}
+
+			//Wake up now and then to notice a shutdown
+			int ready = poll(waiting.data(), waiting.size(), SHUTDOWN_POLL_MS);
+			if (ready <= 0)
+				continue;
+
+			if (waiting[1].revents != 0)
+			{
+				uint64_t count;
+				ssize_t got = read(wakeFd, &count, sizeof(count));
+				(void)got;
+			}
+
+			for (size_t i = 0; i < polled.size(); i++)
+			{
+				if (waiting[i + 2].revents == 0)
+					continue;
+				Connection &connection = *polled[i];
+				bool ok = connection.shared == nullptr ? ReceiveMemory(connection) : ReadRequests(connection, workers);
+				if (!ok)
+					connection.failed.store(true);
+			}
+
+			if (waiting[0].revents != 0)
+			{
+				int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+				if (client >= 0)
+					connections.push_back(std::unique_ptr<Connection>(new Connection(client, wakeFd)));
+			}
+		}
+
+		//Leaving this block finishes every batch already posted, which sends
+		//the last responses before the connections are closed
+	}
+
+	//Stop accepting and drop every client
+	connections.clear();
+	close(wakeFd);
+	close(listener);
+	unlink(socketPath);
+	return true;
+}
+
+CollisionServiceClient::CollisionServiceClient(void)
+{
+	this->socket = -1;
+	this->memory = -1;
+	this->shared = nullptr;
+	this->sharedBytes = 0;
+}
+
+CollisionServiceClient::~CollisionServiceClient(void)
+{
+	if (this->shared != nullptr)
+		munmap(this->shared, this->sharedBytes);
+	if (this->memory >= 0)
+		close(this->memory);
+	if (this->socket >= 0)
+		close(this->socket);
+}
+
+bool CollisionServiceClient::Connect(const char* socketPath, size_t sharedBytes)
+{
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(socketPath) >= sizeof(address.sun_path))
+		return false;
+	strcpy(address.sun_path, socketPath);
+
+	//Sealed at its size, so the service can map it without fearing it shrinks
+	this->memory = memfd_create("point-obb", MFD_ALLOW_SEALING | MFD_CLOEXEC);
+	if (this->memory < 0 || ftruncate(this->memory, (off_t)sharedBytes) != 0 ||
+		fcntl(this->memory, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0)
+		return false;
+
+	void* mapped = mmap(nullptr, sharedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->memory, 0);
+	if (mapped == MAP_FAILED)
+		return false;
+	this->shared = (unsigned char*)mapped;
+	this->sharedBytes = sharedBytes;
+
+	this->socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (this->socket < 0 || connect(this->socket, (struct sockaddr*)&address, sizeof(address)) != 0)
+		return false;
+
+	//Pass the memfd to the service
+	char byte = 0;
+	char control[CMSG_SPACE(sizeof(int))];
+	memset(control, 0, sizeof(control));
+	struct iovec iov = { &byte, 1 };
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &this->memory, sizeof(int));
+
+	return sendmsg(this->socket, &msg, 0) == 1;
+}
+
+unsigned char* CollisionServiceClient::Shared(void) const
+{
+	return this->shared;
+}
+
+bool CollisionServiceClient::Send(const ServiceRequest &request)
+{
+	return WriteAll(this->socket, &request, sizeof(request));
+}
+
+bool CollisionServiceClient::Receive(ServiceResponse &response)
+{
+	return ReadAll(this->socket, &response, sizeof(response));
+}
+
+#else
+
+bool RunCollisionService(const char* socketPath, int numThreads, const std::atomic<bool> &running)
+{
+	return false;
+}
+
+CollisionServiceClient::CollisionServiceClient(void)
+{
+	this->socket = -1;
+	this->memory = -1;
+	this->shared = nullptr;
+	this->sharedBytes = 0;
+}
+
+CollisionServiceClient::~CollisionServiceClient(void)
+{
+}
+
+bool CollisionServiceClient::Connect(const char* socketPath, size_t sharedBytes)
+{
+	return false;
+}
+
+unsigned char* CollisionServiceClient::Shared(void) const
+{
+	return nullptr;
+}
+
+bool CollisionServiceClient::Send(const ServiceRequest &request)
+{
+	return false;
+}
+
+bool CollisionServiceClient::Receive(ServiceResponse &response)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+Title: Point - OBB
+File Name: CollisionService.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Runs the point - OBB tests as a service for other processes on the same machine.
+Clients connect over a Unix domain socket. Each client makes a memfd, maps it, and
+passes the descriptor to the service when it connects, so both processes see the
+same memory. Points and results are never sent over the socket: a request only
+says where in the shared memory the x, y, z, and result arrays are, and the
+service writes its results straight into that memory. Requests carry an id and
+a client may send as many as it likes before reading any responses, which are
+sent back in the order the requests arrived.
+
+One thread serves every client. It waits on all of their sockets at once, and
+each round of requests it reads from a client goes to a CollisionWorkers pool as
+one batch per request. The worker which finishes a round's last batch sends the
+round's responses, and the client is read from again after that.
+
+Linux only; on other platforms RunCollisionService and Connect just return false.
+*/
+
+#ifndef _COLLISION_SERVICE_H
+#define _COLLISION_SERVICE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Collision.h"
+
+//A request to test count points against one box.
+//The offsets are in bytes from the start of the shared memory.
+struct ServiceRequest
+{
+	uint32_t id;
+	uint32_t count;
+	uint64_t xOffset;
+	uint64_t yOffset;
+	uint64_t zOffset;
+	uint64_t resultOffset;
+	OBBCollider collider;
+};
+
+//The answer to a request with the same id
+struct ServiceResponse
+{
+	uint32_t id;
+	uint32_t hits;		//The number of points inside the box
+	int32_t status;		//0 on success, -1 if an array was outside the shared memory or a float array was misaligned
+};
+
+///
+//Accepts clients on a Unix domain socket and answers their requests
+//until running is set to false. Connected clients are then disconnected.
+//
+//Parameters:
+//	socketPath: The path to create the socket at, replacing any old one
+//	numThreads: The number of worker threads, or 0 for one per hardware thread
+//	running: Cleared by another thread to shut the service down
+//
+//Returns:
+//	false if the socket could not be created, else true once shut down
+bool RunCollisionService(const char* socketPath, int numThreads, const std::atomic<bool> &running);
+
+//One client's connection to the service
+class CollisionServiceClient
+{
+public:
+	CollisionServiceClient(void);
+	~CollisionServiceClient(void);
+
+	///
+	//Connects to the service and sets up the shared memory
+	//
+	//Parameters:
+	//	socketPath: The path the service is listening on
+	//	sharedBytes: The size of the shared memory to create
+	//
+	//Returns:
+	//	false if the connection or the shared memory could not be made
+	bool Connect(const char* socketPath, size_t sharedBytes);
+
+	///
+	//Gets the start of the shared memory. Point and result arrays for
+	//requests must be placed inside it.
+	unsigned char* Shared(void) const;
+
+	///
+	//Sends a request without waiting for its response
+	bool Send(const ServiceRequest &request);
+
+	///
+	//Waits for the next response
+	bool Receive(ServiceResponse &response);
+
+private:
+	int socket;
+	int memory;
+	unsigned char* shared;
+	size_t sharedBytes;
+};
+
+#endif _COLLISION_SERVICE_H
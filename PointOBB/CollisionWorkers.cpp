@@ -0,0 +1,313 @@
+/*
+Title: Point - OBB
+File Name: CollisionWorkers.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A pool of threads which run batches of point - OBB queries for any number of
+clients at once. See CollisionWorkers.h.
+*/
+
+#include "CollisionWorkers.h"
+#include <cstdint>
+#include <cstring>
+
+//How many times an idle worker polls the queue before going to sleep
+static const int SPINS_BEFORE_SLEEP = 64;
+
+CollisionWorkers::CollisionWorkers(int numThreads, size_t queueCapacity)
+	: CollisionWorkers(numThreads, queueCapacity, false)
+{
+}
+
+CollisionWorkers::CollisionWorkers(int numThreads, size_t queueCapacity, bool numaAware)
+	: queue(queueCapacity)
+{
+	if (numThreads <= 0)
+	{
+		numThreads = (int)std::thread::hardware_concurrency();
+		if (numThreads <= 0)
+			numThreads = 1;
+	}
+
+	this->running.store(true);
+	this->sleeping.store(0);
+	this->pushes.store(0);
+	this->waitingProducers.store(0);
+	this->pops.store(0);
+
+	int numNodes = numaAware ? NumaNodeCount() : 1;
+	if (numNodes > 1)
+	{
+		for (int node = 0; node < numNodes; node++)
+			this->nodeQueues.push_back(new QueryQueue<QueryBatch*>(queueCapacity));
+	}
+
+	//Spread the workers evenly over the nodes
+	for (int i = 0; i < numThreads; i++)
+	{
+		int node = this->nodeQueues.empty() ? -1 : i * numNodes / numThreads;
+		this->threads.push_back(std::thread(&CollisionWorkers::WorkerLoop, this, node));
+	}
+}
+
+CollisionWorkers::~CollisionWorkers(void)
+{
+	this->running.store(false);
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+		this->wake.notify_all();
+	}
+
+	for (size_t i = 0; i < this->threads.size(); i++)
+		this->threads[i].join();
+
+	for (size_t node = 0; node < this->nodeQueues.size(); node++)
+		delete this->nodeQueues[node];
+}
+
+std::future<void> CollisionWorkers::Submit(QueryBatch* batch)
+{
+	//Take the future first, the batch may be finished as soon as it is pushed
+	batch->promise = new std::promise<void>();
+	std::future<void> future = batch->promise->get_future();
+
+	this->Post(batch);
+	return future;
+}
+
+void CollisionWorkers::Post(QueryBatch* batch)
+{
+	//Back-pressure: sleep until a worker has popped a batch, then try again
+	QueryQueue<QueryBatch*> &queue = this->QueueFor(batch);
+	while (!queue.TryPush(batch))
+	{
+		//Taken before trying again, so a pop made after a failed push is noticed
+		unsigned long long seen = this->pops.load();
+		this->WakeWorker();
+		if (queue.TryPush(batch))
+			break;
+
+		std::unique_lock<std::mutex> lock(this->roomMutex);
+		this->waitingProducers.fetch_add(1);
+		this->room.wait(lock, [this, seen] { return this->pops.load() != seen; });
+		this->waitingProducers.fetch_sub(1);
+	}
+
+	this->WakeWorker();
+}
+
+bool CollisionWorkers::TrySubmit(QueryBatch* batch)
+{
+	if (!this->QueueFor(batch).TryPush(batch))
+		return false;
+
+	this->WakeWorker();
+	return true;
+}
+
+int CollisionWorkers::NumThreads(void) const
+{
+	return (int)this->threads.size();
+}
+
+int CollisionWorkers::NumNodes(void) const
+{
+	return (int)this->nodeQueues.size();
+}
+
+///
+//Gets the queue a batch should go into
+QueryQueue<QueryBatch*> &CollisionWorkers::QueueFor(const QueryBatch* batch)
+{
+	if (batch->node >= 0 && batch->node < (int)this->nodeQueues.size())
+		return *this->nodeQueues[batch->node];
+	return this->queue;
+}
+
+///
+//Takes the next batch for a worker on a node: its own node's first, then the
+//shared queue, and only then another node's
+bool CollisionWorkers::PopAny(int node, QueryBatch* &batch)
+{
+	if (node >= 0 && this->nodeQueues[node]->TryPop(batch))
+		return true;
+	if (this->queue.TryPop(batch))
+		return true;
+
+	for (size_t other = 0; other < this->nodeQueues.size(); other++)
+	{
+		if ((int)other != node && this->nodeQueues[other]->TryPop(batch))
+			return true;
+	}
+	return false;
+}
+
+void SplitBatchByNode(const OBBCollider &collider, const float* x, const float* y, const float* z, int count, unsigned char* results, int maxBatch, std::vector<QueryBatch> &batches)
+{
+	if (maxBatch <= 0)
+		maxBatch = count;
+
+	size_t pageBytes;
+	std::vector<int> pageNodes = NumaPageNodes(x, (size_t)count * sizeof(float), pageBytes);
+	size_t firstPage = (size_t)((uintptr_t)x / pageBytes);
+
+	int start = 0;
+	while (start < count)
+	{
+		//Run on until the node changes or the batch is full
+		int node = pageNodes[(uintptr_t)(x + start) / pageBytes - firstPage];
+		int end = start + 1;
+		while (end < count && end - start < maxBatch && pageNodes[(uintptr_t)(x + end) / pageBytes - firstPage] == node)
+			end++;
+
+		QueryBatch batch;
+		batch.collider = collider;
+		batch.x = x + start;
+		batch.y = y + start;
+		batch.z = z + start;
+		batch.count = end - start;
+		batch.results = results + start;
+		batch.node = node;
+		batches.push_back(batch);
+		start = end;
+	}
+}
+
+///
+//Wakes one sleeping worker, if there are any, after a push
+//
+//Overview:
+//	Both this and a worker going to sleep use sequentially consistent operations
+//	on pushes and sleeping. Either the worker sees the new push count and does
+//	not sleep, or this sees the worker counted in sleeping and notifies it. The
+//	notify takes the mutex, so it cannot land between the worker's last check
+//	and its wait.
+void CollisionWorkers::WakeWorker(void)
+{
+	this->pushes.fetch_add(1);
+	if (this->sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+		this->wake.notify_one();
+	}
+}
+
+///
+//Wakes the producers waiting for room, if there are any, after a pop
+//
+//Overview:
+//	The same handshake as WakeWorker, on pops and waitingProducers. Every
+//	waiting producer is woken, since with NUMA queues the room made may be
+//	in any one of their queues.
+void CollisionWorkers::SignalRoom(void)
+{
+	this->pops.fetch_add(1);
+	if (this->waitingProducers.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(this->roomMutex);
+		this->room.notify_all();
+	}
+}
+
+///
+//Tests a batch's points against every box of its replicated array, reading the
+//copy on the calling worker's node
+//
+//Parameters:
+//	batch: The batch
+//	inside: Scratch space for one box's results
+static void TestReplicated(const QueryBatch &batch, std::vector<unsigned char> &inside)
+{
+	const OBBCollider* colliders = batch.colliders->Local();
+	size_t numColliders = batch.colliders->Size();
+
+	memset(batch.results, 0, (size_t)batch.count);
+	inside.resize((size_t)batch.count);
+	for (size_t c = 0; c < numColliders; c++)
+	{
+		TestCollisions(colliders[c], batch.x, batch.y, batch.z, batch.count, inside.data());
+		for (int i = 0; i < batch.count; i++)
+			batch.results[i] |= inside[i];
+	}
+}
+
+///
+//Runs on each worker thread until the pool is destroyed
+//
+//Parameters:
+//	node: The NUMA node the worker belongs to, or -1 if the pool is not NUMA-aware
+void CollisionWorkers::WorkerLoop(int node)
+{
+	int idleSpins = 0;
+	QueryBatch* batch;
+	std::vector<unsigned char> inside;
+
+	if (node >= 0)
+		PinThreadToNode(node);
+
+	for (;;)
+	{
+		//Taken before looking, so a push made after a failed look is noticed
+		unsigned long long seen = this->pushes.load();
+
+		if (this->PopAny(node, batch))
+		{
+			idleSpins = 0;
+			this->SignalRoom();
+
+			if (batch->colliders != nullptr)
+				TestReplicated(*batch, inside);
+			else
+				TestCollisions(batch->collider, batch->x, batch->y, batch->z, batch->count, batch->results);
+
+			//The batch may be freed by whoever is told it is done,
+			//so nothing may touch it after this
+			std::promise<void>* promise = batch->promise;
+			batch->promise = nullptr;
+			if (batch->callback != nullptr)
+				batch->callback(batch, batch->userData);
+			if (promise != nullptr)
+			{
+				promise->set_value();
+				delete promise;
+			}
+			continue;
+		}
+
+		//Only stop once the queue is empty, so nothing submitted is dropped
+		if (!this->running.load())
+			return;
+
+		if (++idleSpins < SPINS_BEFORE_SLEEP)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		//Sleep until something has been pushed since we last looked, or the pool stops
+		std::unique_lock<std::mutex> lock(this->sleepMutex);
+		this->sleeping.fetch_add(1);
+		this->wake.wait(lock, [this, seen] { return !this->running.load() || this->pushes.load() != seen; });
+		this->sleeping.fetch_sub(1);
+		idleSpins = 0;
+	}
+}
@@ -0,0 +1,201 @@
+/*
+Title: Point - OBB
+File Name: CollisionWorkers.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A pool of threads which run batches of point - OBB queries for any number of
+clients at once. Clients fill out a QueryBatch and submit it; the batch goes into
+a lock-free QueryQueue and the first idle worker to pop it runs TestCollisions on it.
+When the batch is finished the worker either calls the batch's callback or, if it
+was submitted with Submit, fulfills the promise behind the future Submit returned.
+
+The queue is bounded. TrySubmit fails straight away when it is full, while Submit
+and Post wait until a worker has made room, which keeps fast producers from running
+arbitrarily far ahead of the workers. A waiting producer sleeps on a condition
+variable which the workers signal as they pop batches, rather than spinning.
+
+On a machine with more than one NUMA node the pool can be made NUMA-aware. Its
+workers are then spread evenly over the nodes and pinned there, and each node gets
+a queue of its own. A batch whose points were allocated on a node (see Numa.h) can
+name that node, and it will be run by one of that node's workers, which read the
+points from local memory. A worker only takes another node's batch when its own
+node's queue and the shared queue are both empty. SplitBatchByNode cuts a large
+array of points, wherever it was allocated, into batches which each lie on one
+node and are named for it. A batch may also test its points
+against a whole array of boxes kept in a NumaReplicated, and each worker then reads
+the copy of the boxes on its own node.
+*/
+
+#ifndef _COLLISION_WORKERS_H
+#define _COLLISION_WORKERS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Collision.h"
+#include "Numa.h"
+#include "QueryQueue.h"
+
+//A batch of points to test against one box.
+//The point and result arrays belong to the client and must stay alive
+//until the batch has completed.
+struct QueryBatch
+{
+	OBBCollider collider;
+	const float* x;
+	const float* y;
+	const float* z;
+	int count;
+	unsigned char* results;
+
+	//If not null, the points are tested against every box in it instead of against
+	//collider, and a result is 1 if the point is inside any of them
+	const NumaReplicated<OBBCollider>* colliders;
+
+	//Called on the worker thread once the results are written, may be null
+	void (*callback)(QueryBatch* batch, void* userData);
+	void* userData;
+
+	//Set by Submit, fulfilled once the results are written
+	std::promise<void>* promise;
+
+	//The NUMA node whose workers should run the batch, or -1 for any
+	int node;
+
+	QueryBatch()
+	{
+		x = y = z = nullptr;
+		count = 0;
+		results = nullptr;
+		colliders = nullptr;
+		callback = nullptr;
+		userData = nullptr;
+		promise = nullptr;
+		node = -1;
+	}
+};
+
+///
+//Splits an array of points into batches which each have their points on one NUMA
+//node, so that a NUMA-aware pool runs each batch on the node holding its points.
+//Where the pages of x lie decides the node; a batch whose pages have not been
+//touched yet, or whose node is not known, gets -1.
+//
+//Parameters:
+//	collider: The box every batch tests against
+//	x, y, z: The worldspace coordinates of the points
+//	count: The number of points
+//	results: Receives 1 for each point inside the box, else 0
+//	maxBatch: The most points to put in one batch
+//	batches: The batches are added to the end of this. They are submitted by
+//		address, so the vector must not grow while any of them are in flight.
+void SplitBatchByNode(const OBBCollider &collider, const float* x, const float* y, const float* z, int count, unsigned char* results, int maxBatch, std::vector<QueryBatch> &batches);
+
+class CollisionWorkers
+{
+public:
+	///
+	//Starts the worker threads
+	//
+	//Parameters:
+	//	numThreads: The number of workers, or 0 for one per hardware thread
+	//	queueCapacity: The number of batches which may be waiting at once
+	CollisionWorkers(int numThreads, size_t queueCapacity);
+
+	///
+	//Starts the worker threads
+	//
+	//Parameters:
+	//	numThreads: The number of workers, or 0 for one per hardware thread
+	//	queueCapacity: The number of batches which may be waiting at once, in each queue
+	//	numaAware: Whether to pin the workers to NUMA nodes and give each node a queue.
+	//		This does nothing on a machine with one node.
+	CollisionWorkers(int numThreads, size_t queueCapacity, bool numaAware);
+
+	///
+	//Finishes every batch already submitted and then stops the workers
+	~CollisionWorkers(void);
+
+	///
+	//Submits a batch, waiting for room in the queue if it is full
+	//
+	//Returns:
+	//	A future which becomes ready when the batch is finished
+	std::future<void> Submit(QueryBatch* batch);
+
+	///
+	//Submits a batch, waiting for room in the queue if it is full.
+	//Nothing is allocated; the batch's callback is how the client
+	//finds out that it is finished.
+	void Post(QueryBatch* batch);
+
+	///
+	//Submits a batch only if there is room in the queue.
+	//The batch's callback is how the client finds out that it is finished.
+	//
+	//Returns:
+	//	false if the queue was full and the batch was not submitted
+	bool TrySubmit(QueryBatch* batch);
+
+	///
+	//Gets the number of worker threads
+	int NumThreads(void) const;
+
+	///
+	//Gets the number of NUMA nodes with a queue of their own, 0 if not NUMA-aware
+	int NumNodes(void) const;
+
+private:
+	void WorkerLoop(int node);
+	void WakeWorker(void);
+	void SignalRoom(void);
+	QueryQueue<QueryBatch*> &QueueFor(const QueryBatch* batch);
+	bool PopAny(int node, QueryBatch* &batch);
+
+	QueryQueue<QueryBatch*> queue;
+	std::vector<QueryQueue<QueryBatch*>*> nodeQueues;	//One per NUMA node, if NUMA-aware
+	std::vector<std::thread> threads;
+	std::atomic<bool> running;
+
+	//Idle workers sleep here instead of spinning
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<int> sleeping;
+
+	//Bumped after every push, so a worker can tell whether anything has
+	//arrived since it last found the queues empty
+	std::atomic<unsigned long long> pushes;
+
+	//Producers waiting for room in a full queue sleep here
+	std::mutex roomMutex;
+	std::condition_variable room;
+	std::atomic<int> waitingProducers;
+
+	//Bumped after every pop, so a producer can tell whether room has
+	//been made since it last found its queue full
+	std::atomic<unsigned long long> pops;
+};
+
+#endif _COLLISION_WORKERS_H
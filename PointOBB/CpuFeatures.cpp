@@ -0,0 +1,100 @@
+/*
+Title: Point - OBB
+File Name: CpuFeatures.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finds out which instruction sets the CPU has. See CpuFeatures.h.
+*/
+
+#include "CpuFeatures.h"
+
+#if defined(CPU_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+
+///
+//Asks the CPU for one of its feature registers
+//
+//Parameters:
+//	leaf: The cpuid leaf
+//	reg: 1 for ebx, 2 for ecx
+//	bit: The bit to read
+static bool CpuidBit(int leaf, int reg, int bit)
+{
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < leaf)
+		return false;
+	__cpuidex(info, leaf, 0);
+	return (info[reg] & (1 << bit)) != 0;
+}
+
+static bool DetectSSE42(void)
+{
+	return CpuidBit(1, 2, 20);
+}
+
+static bool DetectAVX2(void)
+{
+	//The operating system must save the upper halves of the registers
+	if (!CpuidBit(1, 2, 27) || !CpuidBit(1, 2, 28) || (_xgetbv(0) & 6) != 6)
+		return false;
+	return CpuidBit(7, 1, 5);
+}
+
+#elif defined(CPU_X86)
+
+static bool DetectSSE42(void)
+{
+	return __builtin_cpu_supports("sse4.2") != 0;
+}
+
+static bool DetectAVX2(void)
+{
+	return __builtin_cpu_supports("avx2") != 0;
+}
+
+#else
+
+static bool DetectSSE42(void)
+{
+	return false;
+}
+
+static bool DetectAVX2(void)
+{
+	return false;
+}
+
+#endif
+
+bool CpuHasSSE42(void)
+{
+	static const bool supported = DetectSSE42();
+	return supported;
+}
+
+bool CpuHasAVX2(void)
+{
+	static const bool supported = DetectAVX2();
+	return supported;
+}
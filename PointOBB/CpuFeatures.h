@@ -0,0 +1,54 @@
+/*
+Title: Point - OBB
+File Name: CpuFeatures.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finds out when the program runs which instruction sets the CPU has, so a SIMD
+kernel can be built into every x86 binary and only used where it works. Kernels
+which need more than the compiler's default are marked TARGET_SSE42 or
+TARGET_AVX2, which lets GCC and Clang build them without turning the instruction
+set on for the whole program; MSVC builds any intrinsic without being asked.
+*/
+
+#ifndef _CPU_FEATURES_H
+#define _CPU_FEATURES_H
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_SSE42
+#define TARGET_AVX2
+#else
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+///
+//Gets whether the CPU has SSE4.2
+bool CpuHasSSE42(void);
+
+///
+//Gets whether the CPU has AVX2 and the operating system saves the AVX registers
+bool CpuHasAVX2(void);
+
+#endif _CPU_FEATURES_H
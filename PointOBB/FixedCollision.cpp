@@ -0,0 +1,205 @@
+/*
+Title: Point - OBB
+File Name: FixedCollision.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A fixed-point version of the point - OBB test. See FixedCollision.h.
+*/
+
+#include "FixedCollision.h"
+#include <cmath>
+#include "CpuFeatures.h"
+#include "Prefetch.h"
+
+//The number of coordinates in one cache line of a stream
+static const int VALUES_PER_LINE = CACHE_LINE_SIZE / sizeof(int32_t);
+
+//The SSE 4.2 kernel is built on any x86 compiler, and only used if the CPU has SSE 4.2
+#ifdef CPU_X86
+#include <nmmintrin.h>
+#define FIXED_COLLISION_SSE
+#endif
+
+int32_t ToFixed(float value)
+{
+	//The comparisons are written so that NaN fails the first one
+	double scaled = std::round((double)value * (double)(1 << FIXED_POSITION_BITS));
+	if (!(scaled >= (double)INT32_MIN))
+		return INT32_MIN;
+	if (scaled > (double)INT32_MAX)
+		return INT32_MAX;
+	return (int32_t)scaled;
+}
+
+bool InFixedRange(float value)
+{
+	double scaled = std::round((double)value * (double)(1 << FIXED_POSITION_BITS));
+	return scaled >= (double)INT32_MIN && scaled <= (double)INT32_MAX;
+}
+
+float FromFixed(int32_t value)
+{
+	return (float)((double)value / (double)(1 << FIXED_POSITION_BITS));
+}
+
+FixedOBBCollider PrepareFixedCollider(const OBBCollider &collider)
+{
+	FixedOBBCollider fixed;
+
+	for (int a = 0; a < 3; a++)
+	{
+		fixed.center[a] = ToFixed(collider.center[a]);
+
+		for (int c = 0; c < 3; c++)
+			fixed.axes[a][c] = (int32_t)std::lround((double)collider.axes[a][c] * (double)(1 << FIXED_AXIS_BITS));
+
+		fixed.min[a] = (int64_t)ToFixed(collider.min[a]) * ((int64_t)1 << FIXED_AXIS_BITS);
+		fixed.max[a] = (int64_t)ToFixed(collider.max[a]) * ((int64_t)1 << FIXED_AXIS_BITS);
+	}
+
+	return fixed;
+}
+
+bool TestCollision(const FixedOBBCollider &collider, const int32_t point[3])
+{
+	int64_t dx = (int64_t)point[0] - collider.center[0];
+	int64_t dy = (int64_t)point[1] - collider.center[1];
+	int64_t dz = (int64_t)point[2] - collider.center[2];
+
+	for (int a = 0; a < 3; a++)
+	{
+		int64_t sProj = collider.axes[a][0] * dx + collider.axes[a][1] * dy + collider.axes[a][2] * dz;
+		if (sProj < collider.min[a] || collider.max[a] < sProj)
+			return false;
+	}
+
+	return true;
+}
+
+#ifdef FIXED_COLLISION_SSE
+//Sets the sign bit of every lane where a - b did not fit in 32 bits
+static inline __m128i SubtractOverflows(__m128i a, __m128i b, __m128i difference)
+{
+	return _mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, difference));
+}
+
+///
+//Tests every whole group of 4 points with SSE 4.2.
+//Only call this if CpuHasSSE42 says so.
+//
+//Returns:
+//	The number of points tested, a multiple of 4
+TARGET_SSE42 static int TestCollisionsSSE42(const FixedOBBCollider &collider, const int32_t* x, const int32_t* y, const int32_t* z, int count, unsigned char* results)
+{
+	int i = 0;
+
+	__m128i cx = _mm_set1_epi32(collider.center[0]);
+	__m128i cy = _mm_set1_epi32(collider.center[1]);
+	__m128i cz = _mm_set1_epi32(collider.center[2]);
+
+	int ahead = PrefetchDistance() * VALUES_PER_LINE;
+	for (; i + 4 <= count; i += 4)
+	{
+		//Ask for the next streams' lines once per cache line of points
+		if (ahead > 0 && (i & (VALUES_PER_LINE - 1)) == 0 && i + ahead < count)
+		{
+			Prefetch(x + i + ahead);
+			Prefetch(y + i + ahead);
+			Prefetch(z + i + ahead);
+		}
+
+		__m128i dx = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(x + i)), cx);
+		__m128i dy = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(y + i)), cy);
+		__m128i dz = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(z + i)), cz);
+
+		//A point too far from the center wraps in 32 bits, those lanes are done below
+		if (_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(
+			SubtractOverflows(_mm_loadu_si128((const __m128i*)(x + i)), cx, dx),
+			SubtractOverflows(_mm_loadu_si128((const __m128i*)(y + i)), cy, dy)),
+			SubtractOverflows(_mm_loadu_si128((const __m128i*)(z + i)), cz, dz)))) != 0)
+		{
+			for (int j = i; j < i + 4; j++)
+			{
+				int32_t point[3] = { x[j], y[j], z[j] };
+				results[j] = TestCollision(collider, point) ? 1 : 0;
+			}
+			continue;
+		}
+
+		//_mm_mul_epi32 only multiplies the even lanes, so the odd lanes
+		//are shifted down and done separately
+		__m128i dxOdd = _mm_srli_epi64(dx, 32);
+		__m128i dyOdd = _mm_srli_epi64(dy, 32);
+		__m128i dzOdd = _mm_srli_epi64(dz, 32);
+
+		__m128i outEven = _mm_setzero_si128();
+		__m128i outOdd = _mm_setzero_si128();
+		for (int a = 0; a < 3; a++)
+		{
+			__m128i ax = _mm_set1_epi32(collider.axes[a][0]);
+			__m128i ay = _mm_set1_epi32(collider.axes[a][1]);
+			__m128i az = _mm_set1_epi32(collider.axes[a][2]);
+			__m128i lo = _mm_set1_epi64x(collider.min[a]);
+			__m128i hi = _mm_set1_epi64x(collider.max[a]);
+
+			__m128i even = _mm_add_epi64(_mm_add_epi64(_mm_mul_epi32(ax, dx), _mm_mul_epi32(ay, dy)), _mm_mul_epi32(az, dz));
+			__m128i odd = _mm_add_epi64(_mm_add_epi64(_mm_mul_epi32(ax, dxOdd), _mm_mul_epi32(ay, dyOdd)), _mm_mul_epi32(az, dzOdd));
+
+			outEven = _mm_or_si128(outEven, _mm_or_si128(_mm_cmpgt_epi64(lo, even), _mm_cmpgt_epi64(even, hi)));
+			outOdd = _mm_or_si128(outOdd, _mm_or_si128(_mm_cmpgt_epi64(lo, odd), _mm_cmpgt_epi64(odd, hi)));
+		}
+
+		int maskEven = _mm_movemask_pd(_mm_castsi128_pd(outEven));
+		int maskOdd = _mm_movemask_pd(_mm_castsi128_pd(outOdd));
+		results[i + 0] = (unsigned char)(~maskEven & 1);
+		results[i + 1] = (unsigned char)(~maskOdd & 1);
+		results[i + 2] = (unsigned char)((~maskEven >> 1) & 1);
+		results[i + 3] = (unsigned char)((~maskOdd >> 1) & 1);
+	}
+	return i;
+}
+#endif
+
+void TestCollisions(const FixedOBBCollider &collider, const int32_t* x, const int32_t* y, const int32_t* z, int count, unsigned char* results)
+{
+	int i = 0;
+
+#ifdef FIXED_COLLISION_SSE
+	if (CpuHasSSE42())
+		i = TestCollisionsSSE42(collider, x, y, z, count, results);
+#endif
+
+	for (; i < count; i++)
+	{
+		int64_t dx = (int64_t)x[i] - collider.center[0];
+		int64_t dy = (int64_t)y[i] - collider.center[1];
+		int64_t dz = (int64_t)z[i] - collider.center[2];
+
+		bool inside = true;
+		for (int a = 0; a < 3; a++)
+		{
+			int64_t sProj = collider.axes[a][0] * dx + collider.axes[a][1] * dy + collider.axes[a][2] * dz;
+			inside &= (collider.min[a] <= sProj) & (sProj <= collider.max[a]);
+		}
+		results[i] = inside ? 1 : 0;
+	}
+}
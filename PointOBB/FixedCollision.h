@@ -0,0 +1,96 @@
+/*
+Title: Point - OBB
+File Name: FixedCollision.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A fixed-point version of the point - OBB test, for when results must be
+bit-for-bit identical on every machine (replays, lockstep networking).
+
+Points and box centers are stored as 32-bit integers with 16 fractional bits,
+and the box's axes with 30 fractional bits. The scalar projection of a point onto
+an axis is then a sum of three 64-bit products which is exact, so there is no
+rounding at all and the order the sum is done in cannot matter. The bounds are
+shifted up to the same 46 fractional bits and compared directly.
+
+Positions run from -32768 to just under 32768 units; ToFixed clamps anything
+outside that, and InFixedRange tells whether a value will be clamped. The offset
+from the center is taken in 64 bits, so any pair of fixed-point positions works.
+Points within 16384 units of the center take the fast path, since their offset
+still fits in 32 bits. The batch test uses SSE 4.2 on any x86 CPU which has it,
+and integer arithmetic gives the same answers with or without it.
+*/
+
+#ifndef _FIXED_COLLISION_H
+#define _FIXED_COLLISION_H
+
+#include <cstdint>
+#include "Collision.h"
+
+//The number of fractional bits in a fixed-point position
+#define FIXED_POSITION_BITS 16
+//The number of fractional bits in a fixed-point axis
+#define FIXED_AXIS_BITS 30
+
+//An OBBCollider in fixed-point
+struct FixedOBBCollider
+{
+	int32_t center[3];
+	int32_t axes[3][3];
+	int64_t min[3];		//Already shifted to FIXED_POSITION_BITS + FIXED_AXIS_BITS
+	int64_t max[3];
+};
+
+///
+//Converts a worldspace coordinate to fixed-point, rounding to nearest.
+//Values outside the fixed-point range are clamped to its ends, and NaN becomes the lowest value.
+int32_t ToFixed(float value);
+
+///
+//Gets whether a worldspace coordinate can be converted to fixed-point without being clamped
+bool InFixedRange(float value);
+
+///
+//Converts a fixed-point coordinate back to a float
+float FromFixed(int32_t value);
+
+///
+//Converts a prepared collider to fixed-point
+FixedOBBCollider PrepareFixedCollider(const OBBCollider &collider);
+
+///
+//Tests for collisions between a fixed-point point and a fixed-point OBB
+//
+//Returns:
+//	true if a collision is detected, else false
+bool TestCollision(const FixedOBBCollider &collider, const int32_t point[3]);
+
+///
+//Tests a batch of fixed-point points against a fixed-point OBB
+//
+//Parameters:
+//	collider: The fixed-point OBB to test
+//	x, y, z: The fixed-point coordinates of the points
+//	count: The number of points
+//	results: Receives 1 for each point inside the box, else 0
+void TestCollisions(const FixedOBBCollider &collider, const int32_t* x, const int32_t* y, const int32_t* z, int count, unsigned char* results);
+
+#endif _FIXED_COLLISION_H
@@ -0,0 +1,249 @@
+/*
+Title: Point - OBB
+File Name: HugePages.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+An allocator backed by huge pages where the system allows it. See HugePages.h.
+*/
+
+#include "HugePages.h"
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+void* AlignedAllocate(size_t bytes, size_t alignment)
+{
+#ifdef _WIN32
+	return _aligned_malloc(bytes, alignment);
+#else
+	//posix_memalign wants at least the alignment of a pointer
+	if (alignment < sizeof(void*))
+		alignment = sizeof(void*);
+	void* memory = nullptr;
+	if (posix_memalign(&memory, alignment, bytes) != 0)
+		return nullptr;
+	return memory;
+#endif
+}
+
+void AlignedFree(void* memory)
+{
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+//Every big block HugePageAllocator holds, by its memory, and the totals of them.
+//Made on first use, and never destroyed, since HugeVectors with static storage
+//may still free their blocks after this file's statics are gone.
+struct AllocatorBlocks
+{
+	std::mutex mutex;
+	std::unordered_map<const void*, HugeAllocation> blocks;
+	HugeAllocatorUsage usage;
+};
+
+static AllocatorBlocks &Blocks(void)
+{
+	static AllocatorBlocks* blocks = []()
+	{
+		AllocatorBlocks* made = new AllocatorBlocks();
+		memset(&made->usage, 0, sizeof(made->usage));
+		return made;
+	}();
+	return *blocks;
+}
+
+void* HugeAllocatorAllocate(size_t bytes)
+{
+	HugeAllocation allocation = HugeAllocate(bytes, false);
+	if (allocation.memory == nullptr)
+		return nullptr;
+
+	AllocatorBlocks &blocks = Blocks();
+	std::lock_guard<std::mutex> lock(blocks.mutex);
+	blocks.blocks[allocation.memory] = allocation;
+	blocks.usage.blocks[allocation.kind]++;
+	blocks.usage.bytes[allocation.kind] += allocation.bytes;
+	return allocation.memory;
+}
+
+void HugeAllocatorFree(void* memory)
+{
+	HugeAllocation allocation;
+	{
+		AllocatorBlocks &blocks = Blocks();
+		std::lock_guard<std::mutex> lock(blocks.mutex);
+		std::unordered_map<const void*, HugeAllocation>::iterator found = blocks.blocks.find(memory);
+		if (found == blocks.blocks.end())
+			return;
+		allocation = found->second;
+		blocks.blocks.erase(found);
+		blocks.usage.blocks[allocation.kind]--;
+		blocks.usage.bytes[allocation.kind] -= allocation.bytes;
+	}
+	HugeFree(allocation);
+}
+
+bool HugeAllocatorFind(const void* memory, HugeAllocation &allocation)
+{
+	AllocatorBlocks &blocks = Blocks();
+	std::lock_guard<std::mutex> lock(blocks.mutex);
+	std::unordered_map<const void*, HugeAllocation>::const_iterator found = blocks.blocks.find(memory);
+	if (found == blocks.blocks.end())
+		return false;
+	allocation = found->second;
+	return true;
+}
+
+HugeAllocatorUsage HugeAllocatorStats(void)
+{
+	AllocatorBlocks &blocks = Blocks();
+	std::lock_guard<std::mutex> lock(blocks.mutex);
+	return blocks.usage;
+}
+
+#ifdef __linux__
+
+#include <cstdint>
+#include <cstdio>
+#include <sys/mman.h>
+
+HugeAllocation HugeAllocate(size_t bytes, bool allowExplicit)
+{
+	HugeAllocation allocation;
+	allocation.bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	allocation.kind = HUGE_PAGES_NONE;
+	allocation.memory = nullptr;
+	if (allocation.bytes == 0)
+		return allocation;
+
+#ifdef MAP_HUGETLB
+	if (allowExplicit)
+	{
+		void* memory = mmap(nullptr, allocation.bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (memory != MAP_FAILED)
+		{
+			allocation.memory = memory;
+			allocation.kind = HUGE_PAGES_EXPLICIT;
+			return allocation;
+		}
+	}
+#endif
+
+	//Map an extra huge page so an aligned run can be cut out, then unmap the ends
+	size_t mapped = allocation.bytes + HUGE_PAGE_SIZE;
+	void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+		return allocation;
+
+	uintptr_t start = (uintptr_t)memory;
+	uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+	if (aligned > start)
+		munmap(memory, aligned - start);
+	uintptr_t end = start + mapped;
+	if (end > aligned + allocation.bytes)
+		munmap((void*)(aligned + allocation.bytes), end - (aligned + allocation.bytes));
+	allocation.memory = (void*)aligned;
+
+#ifdef MADV_HUGEPAGE
+	if (madvise(allocation.memory, allocation.bytes, MADV_HUGEPAGE) == 0)
+		allocation.kind = HUGE_PAGES_TRANSPARENT;
+#endif
+
+	return allocation;
+}
+
+void HugeFree(const HugeAllocation &allocation)
+{
+	if (allocation.memory != nullptr)
+		munmap(allocation.memory, allocation.bytes);
+}
+
+size_t HugePageBytes(const HugeAllocation &allocation)
+{
+	if (allocation.memory == nullptr)
+		return 0;
+	if (allocation.kind == HUGE_PAGES_EXPLICIT)
+		return allocation.bytes;
+
+	FILE* file = fopen("/proc/self/smaps", "r");
+	if (file == nullptr)
+		return 0;
+
+	//Find the mapping's header line, then its AnonHugePages line
+	uintptr_t address = (uintptr_t)allocation.memory;
+	bool inside = false;
+	size_t hugeBytes = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		unsigned long long start, end;
+		if (sscanf(line, "%llx-%llx ", &start, &end) == 2)
+		{
+			inside = start <= address && address < end;
+			continue;
+		}
+
+		unsigned long long kilobytes;
+		if (inside && sscanf(line, "AnonHugePages: %llu kB", &kilobytes) == 1)
+		{
+			hugeBytes = (size_t)kilobytes * 1024;
+			break;
+		}
+	}
+
+	fclose(file);
+	return hugeBytes;
+}
+
+#else
+
+HugeAllocation HugeAllocate(size_t bytes, bool allowExplicit)
+{
+	HugeAllocation allocation;
+	allocation.bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	allocation.kind = HUGE_PAGES_NONE;
+	allocation.memory = allocation.bytes > 0 ? AlignedAllocate(allocation.bytes, HUGE_PAGE_SIZE) : nullptr;
+	if (allocation.memory != nullptr)
+		memset(allocation.memory, 0, allocation.bytes);
+	return allocation;
+}
+
+void HugeFree(const HugeAllocation &allocation)
+{
+	AlignedFree(allocation.memory);
+}
+
+size_t HugePageBytes(const HugeAllocation &allocation)
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,208 @@
+/*
+Title: Point - OBB
+File Name: HugePages.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+An allocator for very large arrays of points and colliders, backed by 2 MiB huge
+pages where the system allows it. A sweep over gigabytes of points touches a new
+4 KiB page every thousand floats, and the TLB cannot hold that many pages; with
+2 MiB pages it needs 512 times fewer entries.
+
+Memory is asked for in two ways, on Linux:
+	explicit:		mmap with MAP_HUGETLB, from the pool of huge pages the administrator
+				has reserved (vm.nr_hugepages). This fails if the pool is empty.
+	transparent:	an ordinary mapping aligned to 2 MiB, with madvise(MADV_HUGEPAGE)
+				asking the kernel to back it with huge pages as it is touched.
+Either may be unavailable, so the allocation says what it got, and HugePageBytes
+reads back from /proc how much of a transparent allocation really is huge pages.
+Elsewhere the memory is ordinary pages.
+
+HugePageAllocator lets standard containers use this for their big blocks, and
+HugeVector is a std::vector which uses it. The scene's colliders and bounds, the
+BVH nodes, and the k-d tree's points are all kept in HugeVectors. The allocator
+is stateless, so what backs each of its big blocks is remembered globally:
+HugeAllocatorFind gives the allocation behind a container's storage, and
+HugeAllocatorStats how many blocks and bytes of each kind are held.
+*/
+
+#ifndef _HUGE_PAGES_H
+#define _HUGE_PAGES_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//The size of a huge page, and the alignment of every huge allocation
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+//What backs an allocation
+enum HugePageKind
+{
+	HUGE_PAGES_NONE,		//Ordinary pages
+	HUGE_PAGES_TRANSPARENT,	//Transparent huge pages were asked for with madvise
+	HUGE_PAGES_EXPLICIT,	//Reserved huge pages, from MAP_HUGETLB
+	NUM_HUGE_PAGE_KINDS
+};
+
+struct HugeAllocation
+{
+	void* memory;		//Aligned to HUGE_PAGE_SIZE where huge pages are supported
+	size_t bytes;		//The size asked for, rounded up to a whole number of huge pages
+	HugePageKind kind;
+};
+
+///
+//Allocates zeroed memory backed by huge pages if possible
+//
+//Parameters:
+//	bytes: The size of the memory
+//	allowExplicit: Whether to try the reserved pool with MAP_HUGETLB first
+//
+//Returns:
+//	The allocation, whose memory is null if nothing could be allocated
+HugeAllocation HugeAllocate(size_t bytes, bool allowExplicit);
+
+///
+//Frees memory from HugeAllocate
+void HugeFree(const HugeAllocation &allocation);
+
+///
+//Gets how many bytes of an allocation are currently backed by huge pages.
+//Transparent huge pages only appear as the memory is touched.
+//
+//Returns:
+//	The number of bytes, or 0 if it cannot be told
+size_t HugePageBytes(const HugeAllocation &allocation);
+
+///
+//Allocates memory from the ordinary heap with a given alignment
+//
+//Parameters:
+//	bytes: The size of the memory
+//	alignment: A power of two
+//
+//Returns:
+//	The memory, or null if it could not be allocated
+void* AlignedAllocate(size_t bytes, size_t alignment);
+
+///
+//Frees memory from AlignedAllocate
+void AlignedFree(void* memory);
+
+//The big blocks HugePageAllocator holds at the moment, by what backs them
+struct HugeAllocatorUsage
+{
+	size_t blocks[NUM_HUGE_PAGE_KINDS];
+	size_t bytes[NUM_HUGE_PAGE_KINDS];
+};
+
+///
+//Allocates a big block for HugePageAllocator with HugeAllocate, and remembers it
+//
+//Returns:
+//	The memory, or null if it could not be allocated
+void* HugeAllocatorAllocate(size_t bytes);
+
+///
+//Frees a block from HugeAllocatorAllocate
+void HugeAllocatorFree(void* memory);
+
+///
+//Finds the allocation behind a big block of HugePageAllocator's, such as the
+//storage of a HugeVector of at least a huge page
+//
+//Parameters:
+//	memory: The start of the block
+//	allocation: Receives the allocation, with the kind of pages backing it
+//
+//Returns:
+//	false if the memory is not a big block the allocator holds
+bool HugeAllocatorFind(const void* memory, HugeAllocation &allocation);
+
+///
+//Gets the big blocks HugePageAllocator holds at the moment
+HugeAllocatorUsage HugeAllocatorStats(void);
+
+//A standard allocator which puts blocks of at least one huge page in huge pages,
+//and smaller ones on the ordinary heap, aligned for T even if T asks for more
+//alignment than the heap gives by itself
+template <typename T>
+struct HugePageAllocator
+{
+	typedef T value_type;
+
+	HugePageAllocator(void)
+	{
+	}
+
+	template <typename U>
+	HugePageAllocator(const HugePageAllocator<U> &)
+	{
+	}
+
+	T* allocate(size_t n)
+	{
+		size_t bytes = n * sizeof(T);
+		if (bytes < HUGE_PAGE_SIZE)
+		{
+			void* memory = AlignedAllocate(bytes, alignof(T));
+			if (memory == nullptr)
+				throw std::bad_alloc();
+			return (T*)memory;
+		}
+
+		void* memory = HugeAllocatorAllocate(bytes);
+		if (memory == nullptr)
+			throw std::bad_alloc();
+		return (T*)memory;
+	}
+
+	void deallocate(T* p, size_t n)
+	{
+		size_t bytes = n * sizeof(T);
+		if (bytes < HUGE_PAGE_SIZE)
+		{
+			AlignedFree(p);
+			return;
+		}
+
+		HugeAllocatorFree(p);
+	}
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T> &, const HugePageAllocator<U> &)
+{
+	return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T> &, const HugePageAllocator<U> &)
+{
+	return false;
+}
+
+//A vector whose storage is in huge pages once it reaches a huge page in size
+template <typename T>
+using HugeVector = std::vector<T, HugePageAllocator<T> >;
+
+#endif _HUGE_PAGES_H
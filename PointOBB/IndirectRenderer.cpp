@@ -0,0 +1,273 @@
+/*
+Title: Point - OBB
+File Name: IndirectRenderer.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Draws many meshes with a handful of indirect draw calls. See IndirectRenderer.h.
+*/
+
+#include "IndirectRenderer.h"
+#include <chrono>
+#include <cstring>
+
+//The number of floats in a vertex: x, y, z, r, g, b, a
+static const int VERTEX_FLOATS = 7;
+
+IndirectRenderer::IndirectRenderer(void)
+{
+	glGenVertexArrays(1, &this->VAO);
+	glGenBuffers(1, &this->vertexBuffer);
+	glGenBuffers(1, &this->indexBuffer);
+	glGenBuffers(1, &this->instanceBuffer);
+	glGenBuffers(1, &this->commandBuffer);
+
+	glBindVertexArray(this->VAO);
+
+	//Position and color from the shared vertex buffer
+	glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+
+	//The MVP matrix, a column per attribute, stepping once per instance
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceBuffer);
+	for (int column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(2 + column);
+		glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(2 + column, 1);
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indexBuffer);
+	glBindVertexArray(0);
+
+	this->dirty = false;
+	memset(&this->stats, 0, sizeof(this->stats));
+}
+
+IndirectRenderer::~IndirectRenderer(void)
+{
+	glDeleteVertexArrays(1, &this->VAO);
+	glDeleteBuffers(1, &this->vertexBuffer);
+	glDeleteBuffers(1, &this->indexBuffer);
+	glDeleteBuffers(1, &this->instanceBuffer);
+	glDeleteBuffers(1, &this->commandBuffer);
+}
+
+int IndirectRenderer::AddMesh(const float* vertices, int numVertices, const GLuint* indices, int numIndices, GLenum primitive)
+{
+	MeshRange mesh;
+	mesh.primitive = primitive;
+	mesh.indexed = indices != nullptr;
+	mesh.baseVertex = (GLint)(this->vertices.size() / VERTEX_FLOATS);
+	if (mesh.indexed)
+	{
+		mesh.first = (GLuint)this->indices.size();
+		mesh.count = (GLuint)numIndices;
+		this->indices.insert(this->indices.end(), indices, indices + numIndices);
+	}
+	else
+	{
+		mesh.first = (GLuint)mesh.baseVertex;
+		mesh.count = (GLuint)numVertices;
+	}
+	this->vertices.insert(this->vertices.end(), vertices, vertices + (size_t)numVertices * VERTEX_FLOATS);
+
+	mesh.bounds.min = mesh.bounds.max = glm::vec3(0.0f);
+	for (int i = 0; i < numVertices; i++)
+	{
+		glm::vec3 position(vertices[i * VERTEX_FLOATS], vertices[i * VERTEX_FLOATS + 1], vertices[i * VERTEX_FLOATS + 2]);
+		mesh.bounds.min = i == 0 ? position : glm::min(mesh.bounds.min, position);
+		mesh.bounds.max = i == 0 ? position : glm::max(mesh.bounds.max, position);
+	}
+
+	this->meshes.push_back(mesh);
+	this->dirty = true;
+	return (int)this->meshes.size() - 1;
+}
+
+void IndirectRenderer::Submit(int mesh, const glm::mat4 &model)
+{
+	Instance instance;
+	instance.mesh = mesh;
+	instance.model = model;
+	this->instances.push_back(instance);
+}
+
+///
+//Refills the shared vertex and index buffers after meshes were added
+void IndirectRenderer::Upload(void)
+{
+	//The element array binding belongs to whichever VAO is bound, so bind ours
+	//rather than overwrite another's
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(float), this->vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(GLuint), this->indices.data(), GL_STATIC_DRAW);
+	glBindVertexArray(0);
+	this->dirty = false;
+}
+
+///
+//Tests whether a box is at least partly inside the view frustum
+//
+//Overview:
+//	Each row of the view projection matrix added to or taken from its last row
+//	gives one of the six planes of the frustum. The box is outside if it is all
+//	on the outside of any one plane, which is the case when even its corner
+//	furthest along the plane's normal is behind the plane.
+static bool InFrustum(const glm::mat4 &VP, const AABB &box)
+{
+	for (int plane = 0; plane < 6; plane++)
+	{
+		int row = plane / 2;
+		float sign = plane % 2 == 0 ? 1.0f : -1.0f;
+		glm::vec4 p(VP[0][3] + sign * VP[0][row], VP[1][3] + sign * VP[1][row], VP[2][3] + sign * VP[2][row], VP[3][3] + sign * VP[3][row]);
+
+		glm::vec3 furthest(p.x >= 0.0f ? box.max.x : box.min.x, p.y >= 0.0f ? box.max.y : box.min.y, p.z >= 0.0f ? box.max.z : box.min.z);
+		if (p.x * furthest.x + p.y * furthest.y + p.z * furthest.z + p.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+///
+//Gets the worldspace AABB of a mesh's local bounds after a model matrix
+static AABB Transform(const glm::mat4 &model, const AABB &local)
+{
+	glm::vec3 middle = (local.min + local.max) * 0.5f;
+	glm::vec3 half = (local.max - local.min) * 0.5f;
+
+	AABB box;
+	glm::vec3 center(model * glm::vec4(middle, 1.0f));
+	glm::vec3 reach = glm::abs(glm::vec3(model[0])) * half.x + glm::abs(glm::vec3(model[1])) * half.y + glm::abs(glm::vec3(model[2])) * half.z;
+	box.min = center - reach;
+	box.max = center + reach;
+	return box;
+}
+
+void IndirectRenderer::Draw(const glm::mat4 &VP)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	if (this->dirty)
+		this->Upload();
+
+	//Keep the copies in view, sorted so each batch of commands, and each mesh
+	//within a batch, is together
+	this->order.clear();
+	for (int i = 0; i < (int)this->instances.size(); i++)
+	{
+		const Instance &instance = this->instances[i];
+		if (InFrustum(VP, Transform(instance.model, this->meshes[instance.mesh].bounds)))
+			this->order.push_back(i);
+	}
+	std::sort(this->order.begin(), this->order.end(), [this](int a, int b)
+	{
+		const MeshRange &meshA = this->meshes[this->instances[a].mesh];
+		const MeshRange &meshB = this->meshes[this->instances[b].mesh];
+		if (meshA.primitive != meshB.primitive)
+			return meshA.primitive < meshB.primitive;
+		if (meshA.indexed != meshB.indexed)
+			return meshA.indexed < meshB.indexed;
+		return this->instances[a].mesh < this->instances[b].mesh;
+	});
+
+	//One command per mesh, drawing each of its copies as an instance
+	struct Batch
+	{
+		GLenum primitive;
+		bool indexed;
+		size_t offset;	//Bytes into the command buffer
+		GLsizei count;
+	};
+	std::vector<Batch> batches;
+	this->matrices.resize(this->order.size());
+	this->commands.clear();
+	for (size_t i = 0; i < this->order.size(); )
+	{
+		int mesh = this->instances[this->order[i]].mesh;
+		const MeshRange &range = this->meshes[mesh];
+
+		size_t first = i;
+		for (; i < this->order.size() && this->instances[this->order[i]].mesh == mesh; i++)
+			this->matrices[i] = VP * this->instances[this->order[i]].model;
+		GLuint instanceCount = (GLuint)(i - first);
+
+		if (batches.empty() || batches.back().primitive != range.primitive || batches.back().indexed != range.indexed)
+		{
+			Batch batch = { range.primitive, range.indexed, this->commands.size(), 0 };
+			batches.push_back(batch);
+		}
+		batches.back().count++;
+
+		size_t offset = this->commands.size();
+		if (range.indexed)
+		{
+			ElementsCommand command = { range.count, instanceCount, range.first, range.baseVertex, (GLuint)first };
+			this->commands.resize(offset + sizeof(command));
+			memcpy(&this->commands[offset], &command, sizeof(command));
+		}
+		else
+		{
+			ArraysCommand command = { range.count, instanceCount, range.first, (GLuint)first };
+			this->commands.resize(offset + sizeof(command));
+			memcpy(&this->commands[offset], &command, sizeof(command));
+		}
+	}
+
+	//Send the matrices and commands, then the whole frame in a call per batch
+	glBindVertexArray(this->VAO);
+	if (!batches.empty())
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, this->matrices.size() * sizeof(glm::mat4), this->matrices.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->commandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, this->commands.size(), this->commands.data(), GL_STREAM_DRAW);
+
+		for (size_t b = 0; b < batches.size(); b++)
+		{
+			if (batches[b].indexed)
+				glMultiDrawElementsIndirect(batches[b].primitive, GL_UNSIGNED_INT, (void*)batches[b].offset, batches[b].count, 0);
+			else
+				glMultiDrawArraysIndirect(batches[b].primitive, (void*)batches[b].offset, batches[b].count, 0);
+		}
+	}
+
+	this->stats.submitted = (int)this->instances.size();
+	this->stats.visible = (int)this->order.size();
+	this->stats.commands = 0;
+	for (size_t b = 0; b < batches.size(); b++)
+		this->stats.commands += batches[b].count;
+	this->stats.calls = (int)batches.size();
+	this->instances.clear();
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	this->stats.cpuMilliseconds = elapsed.count();
+}
+
+const RenderStats &IndirectRenderer::Stats(void) const
+{
+	return this->stats;
+}
@@ -0,0 +1,154 @@
+/*
+Title: Point - OBB
+File Name: IndirectRenderer.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Draws many meshes of many kinds with a handful of draw calls.
+
+Every kind of mesh is packed into one shared vertex buffer, and those with indices
+into one shared index buffer, so switching from one mesh to the next never means
+binding anything. A mesh is queued with Submit once per frame for each place it
+is drawn. Draw then works out which of them are in view, sorts them by mesh, and
+builds the frame's list of indirect draw commands on the CPU: one command per mesh,
+drawing every visible copy of it as an instance. Each copy's MVP matrix goes in a
+per-instance vertex attribute, and a command's baseInstance points it at its own
+run of matrices. The commands are sent with one glMultiDrawArraysIndirect or
+glMultiDrawElementsIndirect call for each primitive type in use.
+
+Copies are culled against the view frustum by the worldspace AABB of their mesh's
+local bounds, using the planes of the view projection matrix (Gribb and Hartmann).
+
+The vertex shader must take the position at location 0, the color at location 1,
+and the MVP matrix at locations 2 to 5, as Assets/VertexShader.glsl does. This
+needs OpenGL 4.3.
+*/
+
+#ifndef _INDIRECT_RENDERER_H
+#define _INDIRECT_RENDERER_H
+
+#include "GLIncludes.h"
+#include "CollisionScene.h"
+
+//How long the last Draw took and how much it sent
+struct RenderStats
+{
+	int submitted;		//The number of copies queued with Submit
+	int visible;		//The number of copies left after culling
+	int commands;		//The number of indirect draw commands
+	int calls;			//The number of multi-draw calls
+	double cpuMilliseconds;	//The time spent culling, building, and sending the commands
+};
+
+class IndirectRenderer
+{
+public:
+	///
+	//Makes the shared buffers. Needs a current OpenGL context.
+	IndirectRenderer(void);
+	~IndirectRenderer(void);
+
+	///
+	//Adds a kind of mesh to the shared buffers
+	//
+	//Parameters:
+	//	vertices: x, y, z, r, g, b, a for each vertex, as in the demo's Vertex
+	//	numVertices: The number of vertices
+	//	indices: The indices into vertices, or null to draw the vertices in order
+	//	numIndices: The number of indices
+	//	primitive: The primitive type, such as GL_LINES
+	//
+	//Returns:
+	//	The mesh's id, for Submit
+	int AddMesh(const float* vertices, int numVertices, const GLuint* indices, int numIndices, GLenum primitive);
+
+	///
+	//Queues a copy of a mesh to be drawn this frame
+	//
+	//Parameters:
+	//	mesh: The id from AddMesh
+	//	model: The copy's model matrix
+	void Submit(int mesh, const glm::mat4 &model);
+
+	///
+	//Culls and draws every copy queued since the last Draw
+	//
+	//Parameters:
+	//	VP: The view projection matrix
+	void Draw(const glm::mat4 &VP);
+
+	///
+	//Gets the numbers from the last Draw
+	const RenderStats &Stats(void) const;
+
+private:
+	IndirectRenderer(const IndirectRenderer &);
+	IndirectRenderer &operator=(const IndirectRenderer &);
+
+	//Where a mesh lies in the shared buffers
+	struct MeshRange
+	{
+		GLenum primitive;
+		bool indexed;
+		GLuint first;	//The first vertex, or the first index if indexed
+		GLuint count;	//The number of vertices, or of indices if indexed
+		GLint baseVertex;
+		AABB bounds;	//In the mesh's local space
+	};
+
+	//A queued copy of a mesh
+	struct Instance
+	{
+		int mesh;
+		glm::mat4 model;
+	};
+
+	//One of the two kinds of indirect command, as OpenGL lays them out
+	struct ArraysCommand
+	{
+		GLuint count, instanceCount, first, baseInstance;
+	};
+	struct ElementsCommand
+	{
+		GLuint count, instanceCount, firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	void Upload(void);
+
+	GLuint VAO;
+	GLuint vertexBuffer, indexBuffer, instanceBuffer, commandBuffer;
+
+	std::vector<float> vertices;
+	std::vector<GLuint> indices;
+	std::vector<MeshRange> meshes;
+	bool dirty;	//Whether meshes were added since the buffers were filled
+
+	std::vector<Instance> instances;
+	std::vector<int> order;
+	std::vector<glm::mat4> matrices;
+	std::vector<unsigned char> commands;
+
+	RenderStats stats;
+};
+
+#endif _INDIRECT_RENDERER_H
@@ -0,0 +1,234 @@
+/*
+Title: Point - OBB
+File Name: KDOP.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Discrete oriented polytopes (k-DOPs): colliders bounded by k/2 pairs of planes at
+right angles to a fixed set of worldspace directions. An OBB gets 3 directions
+which turn with the box. A k-DOP keeps its directions still and uses more of them,
+so it can wrap a shape more tightly and needs no transforming before a test.
+
+The supported sets of directions, which are the usual ones:
+	6:	the X, Y, and Z axes (an AABB)
+	14:	those, and the 4 diagonals through the corners of a cube
+	18:	those of 6, and the 6 diagonals through the edges of a cube
+	26:	all 13 of the above
+
+The point test is the same one the OBB uses: the scalar projection of the point
+onto each direction must lie between the bounds for that direction. K is a template
+parameter, so the loops over the directions are fixed length and the compiler can
+unroll them, and one batch kernel serves every k.
+*/
+
+#ifndef _KDOP_H
+#define _KDOP_H
+
+#include <cfloat>
+#include "Collision.h"
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <emmintrin.h>
+#define KDOP_SSE
+#endif
+
+//Every direction, in the order the sets above take them: the 3 axes, the 4 corner
+//diagonals, then the 6 edge diagonals. They are left unnormalized, so a projection
+//is only sums and differences of the coordinates.
+static const float KDOP_DIRECTIONS[13][3] =
+{
+	{ 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+	{ 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f },
+	{ 1.0f, 1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 1.0f },
+	{ 1.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 1.0f }, { 0.0f, 1.0f, -1.0f }
+};
+
+//A k-DOP collider
+template<int K>
+struct KDOP
+{
+	static_assert(K == 6 || K == 14 || K == 18 || K == 26, "k-DOPs have 6, 14, 18, or 26 planes");
+	static const int NUM_DIRECTIONS = K / 2;
+
+	float min[K / 2];	//The minimum bound along each direction
+	float max[K / 2];	//The maximum bound along each direction
+
+	///
+	//Gets one of this k-DOP's directions
+	//
+	//Parameters:
+	//	i: The direction, from 0 to K / 2 - 1
+	static const float* Direction(int i)
+	{
+		//The 18-DOP skips the corner diagonals
+		return KDOP_DIRECTIONS[(K == 18 && i >= 3) ? i + 4 : i];
+	}
+
+	///
+	//Gets the scalar projection of a point onto one of the directions
+	static float Project(int i, float x, float y, float z)
+	{
+		const float* d = Direction(i);
+		return (d[0] * x + d[1] * y) + d[2] * z;
+	}
+};
+
+///
+//Makes the tightest k-DOP around a set of vertices
+//
+//Parameters:
+//	positions: The x, y, z of the first vertex
+//	count: The number of vertices
+//	stride: The number of floats from one vertex to the next
+//
+//Returns:
+//	The k-DOP. With no vertices every bound is inverted, so nothing is inside.
+template<int K>
+KDOP<K> FitKDOP(const float* positions, int count, int stride)
+{
+	KDOP<K> kdop;
+	for (int d = 0; d < K / 2; d++)
+	{
+		kdop.min[d] = FLT_MAX;
+		kdop.max[d] = -FLT_MAX;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		const float* p = positions + (size_t)i * stride;
+		for (int d = 0; d < K / 2; d++)
+		{
+			float sProj = KDOP<K>::Project(d, p[0], p[1], p[2]);
+			kdop.min[d] = sProj < kdop.min[d] ? sProj : kdop.min[d];
+			kdop.max[d] = sProj > kdop.max[d] ? sProj : kdop.max[d];
+		}
+	}
+
+	return kdop;
+}
+
+///
+//Makes the tightest k-DOP around a prepared OBB, from its 8 corners
+template<int K>
+KDOP<K> FitKDOP(const OBBCollider &collider)
+{
+	float corners[8][3];
+	for (int c = 0; c < 8; c++)
+	{
+		glm::vec3 corner = collider.center
+			+ collider.axes[0] * ((c & 1) ? collider.max[0] : collider.min[0])
+			+ collider.axes[1] * ((c & 2) ? collider.max[1] : collider.min[1])
+			+ collider.axes[2] * ((c & 4) ? collider.max[2] : collider.min[2]);
+		corners[c][0] = corner.x;
+		corners[c][1] = corner.y;
+		corners[c][2] = corner.z;
+	}
+
+	return FitKDOP<K>(&corners[0][0], 8, 3);
+}
+
+///
+//Tests for collisions between a point and a k-DOP
+//
+//Parameters:
+//	kdop: The k-DOP to test
+//	point: The point in worldspace
+//
+//Returns:
+//	true if a collision is detected, else false
+template<int K>
+bool TestCollision(const KDOP<K> &kdop, glm::vec3 point)
+{
+	for (int d = 0; d < K / 2; d++)
+	{
+		float sProj = KDOP<K>::Project(d, point.x, point.y, point.z);
+		if (sProj < kdop.min[d] || sProj > kdop.max[d])
+			return false;
+	}
+	return true;
+}
+
+///
+//Tests a batch of points against a k-DOP
+//
+//Overview:
+//	Like TestCollisions for OBBs, every point is tested on every direction without
+//	early outs, four points at a time where SSE is available, and each projection
+//	is summed in the same order as in TestCollision.
+//
+//Parameters:
+//	kdop: The k-DOP to test
+//	x, y, z: The worldspace coordinates of the points
+//	count: The number of points
+//	results: Receives 1 for each point inside the k-DOP, else 0
+template<int K>
+void TestCollisions(const KDOP<K> &kdop, const float* x, const float* y, const float* z, int count, unsigned char* results)
+{
+	int i = 0;
+
+#ifdef KDOP_SSE
+	//Splat the directions and bounds into registers once for the whole batch
+	__m128 dx[K / 2], dy[K / 2], dz[K / 2], lo[K / 2], hi[K / 2];
+	for (int d = 0; d < K / 2; d++)
+	{
+		const float* direction = KDOP<K>::Direction(d);
+		dx[d] = _mm_set1_ps(direction[0]);
+		dy[d] = _mm_set1_ps(direction[1]);
+		dz[d] = _mm_set1_ps(direction[2]);
+		lo[d] = _mm_set1_ps(kdop.min[d]);
+		hi[d] = _mm_set1_ps(kdop.max[d]);
+	}
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px = _mm_loadu_ps(x + i);
+		__m128 py = _mm_loadu_ps(y + i);
+		__m128 pz = _mm_loadu_ps(z + i);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int d = 0; d < K / 2; d++)
+		{
+			__m128 sProj = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx[d], px), _mm_mul_ps(dy[d], py)), _mm_mul_ps(dz[d], pz));
+			inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(lo[d], sProj), _mm_cmple_ps(sProj, hi[d])));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		results[i + 0] = (unsigned char)(mask & 1);
+		results[i + 1] = (unsigned char)((mask >> 1) & 1);
+		results[i + 2] = (unsigned char)((mask >> 2) & 1);
+		results[i + 3] = (unsigned char)((mask >> 3) & 1);
+	}
+#endif
+
+	//Whatever is left over (or everything, without SSE)
+	for (; i < count; i++)
+	{
+		bool inside = true;
+		for (int d = 0; d < K / 2; d++)
+		{
+			float sProj = KDOP<K>::Project(d, x[i], y[i], z[i]);
+			inside &= (kdop.min[d] <= sProj) & (sProj <= kdop.max[d]);
+		}
+		results[i] = inside ? 1 : 0;
+	}
+}
+
+#endif _KDOP_H
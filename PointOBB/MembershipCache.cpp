@@ -0,0 +1,205 @@
+/*
+Title: Point - OBB
+File Name: MembershipCache.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Remembers which box each tracked point was inside last frame. See MembershipCache.h.
+*/
+
+#include "MembershipCache.h"
+#include <algorithm>
+#include <chrono>
+
+///
+//Gets the time in seconds since some fixed point
+static double Seconds(void)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MembershipCache::MembershipCache(const CollisionScene &scene, int numPoints, float neighborMargin)
+	: scene(scene), neighborMargin(neighborMargin), lastBox(numPoints, -1)
+{
+	this->ResetStats();
+	this->RebuildNeighbors();
+}
+
+///
+//Rebuilds the neighbor lists after the boxes in the scene have moved
+//
+//Overview:
+//	The boxes are sorted by the low X edge of their AABBs. Walking through them
+//	in that order, a box can only be near the boxes after it whose low X edge is
+//	within its high X edge (plus the margin), so each box stops looking as soon
+//	as it reaches one which starts too far along.
+void MembershipCache::RebuildNeighbors(void)
+{
+	int numColliders = this->scene.Size();
+	const HugeVector<AABB> &bounds = this->scene.bounds;
+
+	std::vector<int> order(numColliders);
+	for (int i = 0; i < numColliders; i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&bounds](int a, int b) { return bounds[a].min.x < bounds[b].min.x; });
+
+	std::vector<std::vector<int> > lists(numColliders);
+	float margin = this->neighborMargin;
+	for (int i = 0; i < numColliders; i++)
+	{
+		const AABB &a = bounds[order[i]];
+		for (int j = i + 1; j < numColliders; j++)
+		{
+			const AABB &b = bounds[order[j]];
+			if (b.min.x > a.max.x + margin)
+				break;
+
+			if (b.min.y <= a.max.y + margin && a.min.y <= b.max.y + margin &&
+				b.min.z <= a.max.z + margin && a.min.z <= b.max.z + margin)
+			{
+				lists[order[i]].push_back(order[j]);
+				lists[order[j]].push_back(order[i]);
+			}
+		}
+	}
+
+	//Pack the lists into one array
+	this->neighborStart.resize(numColliders + 1);
+	this->neighbors.clear();
+	for (int i = 0; i < numColliders; i++)
+	{
+		this->neighborStart[i] = (int)this->neighbors.size();
+		this->neighbors.insert(this->neighbors.end(), lists[i].begin(), lists[i].end());
+	}
+	this->neighborStart[numColliders] = (int)this->neighbors.size();
+
+	//Remembered boxes may no longer exist
+	for (size_t p = 0; p < this->lastBox.size(); p++)
+	{
+		if (this->lastBox[p] >= numColliders)
+			this->lastBox[p] = -1;
+	}
+}
+
+int MembershipCache::Query(int pointIndex, glm::vec3 point)
+{
+	//Boxes added or removed since the lists were built would be read out of range
+	if (this->neighborStart.size() != (size_t)this->scene.Size() + 1)
+		this->RebuildNeighbors();
+
+	int last = this->lastBox[pointIndex];
+
+	if (last >= 0)
+	{
+		//Most of the time the point has not left its box
+		this->stats.boxTests++;
+		if (TestCollision(this->scene.colliders[last], point))
+		{
+			this->stats.lastBoxHits++;
+			this->stats.boxTestsSaved += last;
+			this->testsAvoided += last + 1;
+			return last;
+		}
+
+		//Otherwise it has probably only moved next door
+		int tests = 1;
+		for (int n = this->neighborStart[last]; n < this->neighborStart[last + 1]; n++)
+		{
+			int candidate = this->neighbors[n];
+			tests++;
+			if (Contains(this->scene.bounds[candidate], point) && TestCollision(this->scene.colliders[candidate], point))
+			{
+				this->stats.boxTests += tests - 1;
+				this->stats.neighborHits++;
+				this->stats.boxTestsSaved += (candidate + 1) - tests;
+				this->testsAvoided += candidate + 1;
+				this->lastBox[pointIndex] = candidate;
+				return candidate;
+			}
+		}
+		this->stats.boxTests += tests - 1;
+	}
+
+	int found = this->FullSearch(point);
+	this->lastBox[pointIndex] = found;
+	return found;
+}
+
+void MembershipCache::Query(const float* x, const float* y, const float* z, int* results)
+{
+	double searchSeconds = this->stats.fullSearchSeconds;
+	long long avoided = this->testsAvoided;
+	double start = Seconds();
+
+	for (size_t p = 0; p < this->lastBox.size(); p++)
+		results[p] = this->Query((int)p, glm::vec3(x[p], y[p], z[p]));
+
+	double elapsed = Seconds() - start;
+	this->stats.querySeconds += elapsed;
+
+	//Price the full searches the cache avoided at what the ones it made cost per box
+	if (this->fullSearchTests > 0)
+	{
+		double secondsPerTest = this->stats.fullSearchSeconds / this->fullSearchTests;
+		double cachedSeconds = elapsed - (this->stats.fullSearchSeconds - searchSeconds);
+		this->stats.secondsSaved += (this->testsAvoided - avoided) * secondsPerTest - cachedSeconds;
+	}
+}
+
+void MembershipCache::Clear(void)
+{
+	std::fill(this->lastBox.begin(), this->lastBox.end(), -1);
+}
+
+const MembershipStats &MembershipCache::Stats(void) const
+{
+	return this->stats;
+}
+
+void MembershipCache::ResetStats(void)
+{
+	this->stats.lastBoxHits = 0;
+	this->stats.neighborHits = 0;
+	this->stats.fullSearches = 0;
+	this->stats.boxTests = 0;
+	this->stats.boxTestsSaved = 0;
+	this->stats.querySeconds = 0.0;
+	this->stats.fullSearchSeconds = 0.0;
+	this->stats.secondsSaved = 0.0;
+	this->fullSearchTests = 0;
+	this->testsAvoided = 0;
+}
+
+///
+//Searches the whole scene, counting every box looked at
+int MembershipCache::FullSearch(glm::vec3 point)
+{
+	this->stats.fullSearches++;
+
+	double start = Seconds();
+	int found = FindContainingCollider(this->scene, point);
+	this->stats.fullSearchSeconds += Seconds() - start;
+
+	int tests = found >= 0 ? found + 1 : this->scene.Size();
+	this->stats.boxTests += tests;
+	this->fullSearchTests += tests;
+	return found;
+}
@@ -0,0 +1,132 @@
+/*
+Title: Point - OBB
+File Name: MembershipCache.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Remembers which box each tracked point was inside last frame. Points usually
+move only a little between frames, so the box a point was in last frame is very
+likely the box it is in now, and if not, one of the boxes next to it probably is.
+Each query tests the remembered box first, then its neighbors, and only searches
+the whole scene if neither finds the point.
+
+When boxes overlap, a point inside more than one of them is answered with the
+box it was remembered in, or the first neighbor found holding it, as long as
+that box still holds it. This is not necessarily the lowest numbered box holding
+the point, which is what FindContainingCollider and a full search return, so the
+answer for a point in an overlap depends on where it has been.
+
+Two boxes are neighbors when their worldspace AABBs come within a margin of each
+other. The neighbor lists are built once from the scene with a sweep along the
+X axis and must be rebuilt if the boxes move.
+
+The cache counts how each query was answered, so the hit rate and the number of
+box tests saved can be read off after playing back a recorded trajectory. It
+also times the queries made for every point at once and the full searches, and
+from those estimates how much time the cache saved.
+*/
+
+#ifndef _MEMBERSHIP_CACHE_H
+#define _MEMBERSHIP_CACHE_H
+
+#include <vector>
+#include "CollisionScene.h"
+
+//How the queries made through a MembershipCache were answered
+struct MembershipStats
+{
+	long long lastBoxHits;		//Found in the box from last frame
+	long long neighborHits;		//Found in a neighbor of that box
+	long long fullSearches;		//Needed a search of the whole scene
+	long long boxTests;			//Boxes looked at in total
+	long long boxTestsSaved;	//Boxes a search of the whole scene would have looked at
+								//for the cached answers, minus the ones the cache did
+	double querySeconds;		//Time spent querying every point at once
+	double fullSearchSeconds;	//Time spent searching the whole scene, by either Query
+	double secondsSaved;		//Estimated time the queries of every point at once saved:
+								//what full searches would have taken for the cached answers,
+								//at the measured time per box, minus what the cache took
+};
+
+class MembershipCache
+{
+public:
+	///
+	//Creates a cache for a number of tracked points
+	//
+	//Parameters:
+	//	scene: The boxes the points are tested against, which must outlive the cache
+	//	numPoints: The number of points being tracked
+	//	neighborMargin: How close two boxes must be to count as neighbors
+	MembershipCache(const CollisionScene &scene, int numPoints, float neighborMargin);
+
+	///
+	//Rebuilds the neighbor lists after the boxes in the scene have moved.
+	//Query notices boxes being added or removed and rebuilds them itself.
+	void RebuildNeighbors(void);
+
+	///
+	//Finds the box containing a tracked point and remembers it for next time
+	//
+	//Parameters:
+	//	pointIndex: Which tracked point this is
+	//	point: Where the point is this frame
+	//
+	//Returns:
+	//	The index of the containing collider, or -1 if there is none
+	int Query(int pointIndex, glm::vec3 point);
+
+	///
+	//Queries every tracked point at once
+	//
+	//Parameters:
+	//	x, y, z: The positions of the tracked points this frame
+	//	results: Receives the containing collider of each point, or -1
+	void Query(const float* x, const float* y, const float* z, int* results);
+
+	///
+	//Forgets every remembered box
+	void Clear(void);
+
+	///
+	//Gets the counts and times of the queries since the stats were last reset.
+	//Only the query of every point at once is timed as a whole, so querySeconds
+	//and secondsSaved leave out single queries.
+	const MembershipStats &Stats(void) const;
+	void ResetStats(void);
+
+private:
+	int FullSearch(glm::vec3 point);
+
+	const CollisionScene &scene;
+	float neighborMargin;
+	std::vector<int> lastBox;
+
+	//The neighbors of collider i are neighbors[neighborStart[i]] up to neighbors[neighborStart[i + 1]]
+	std::vector<int> neighborStart;
+	std::vector<int> neighbors;
+
+	MembershipStats stats;
+	long long fullSearchTests;	//Boxes looked at by full searches, for the time per box
+	long long testsAvoided;		//Boxes full searches would have looked at for the cached answers
+};
+
+#endif _MEMBERSHIP_CACHE_H
@@ -0,0 +1,69 @@
+/*
+Title: Point - OBB
+File Name: Morton.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Morton codes (Z-order curve) for 3D grid cells. The bits of the X, Y, and Z
+cell coordinates are interleaved into one number, so sorting by the code puts
+cells which are close together in space close together in the list.
+Each coordinate may use up to 10 bits, giving a 30 bit code.
+*/
+
+#ifndef _MORTON_H
+#define _MORTON_H
+
+#include <cstdint>
+#include "glm\glm.hpp"
+
+//The most bits of each coordinate a code can hold
+#define MORTON_BITS 10
+
+///
+//Spreads the low 10 bits of a number out so there are two 0 bits between each
+inline uint32_t ExpandBits(uint32_t v)
+{
+	v &= 0x3ff;
+	v = (v | (v << 16)) & 0x030000ff;
+	v = (v | (v << 8)) & 0x0300f00f;
+	v = (v | (v << 4)) & 0x030c30c3;
+	v = (v | (v << 2)) & 0x09249249;
+	return v;
+}
+
+///
+//Gets the Morton code of a grid cell
+inline uint32_t MortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+	return (ExpandBits(x) << 2) | (ExpandBits(y) << 1) | ExpandBits(z);
+}
+
+///
+//Gets the grid cell holding a point, on a grid of 2^bits cells along each
+//axis spread over the box [min, min + size]. Points outside are clamped in.
+inline glm::uvec3 MortonCell(const glm::vec3 &point, const glm::vec3 &min, const glm::vec3 &invSize, int bits)
+{
+	float cells = (float)(1 << bits);
+	glm::vec3 cell = glm::clamp((point - min) * invSize * cells, glm::vec3(0.0f), glm::vec3(cells - 1.0f));
+	return glm::uvec3(cell);
+}
+
+#endif _MORTON_H
@@ -0,0 +1,294 @@
+/*
+Title: Point - OBB
+File Name: Narrowphase.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Tests (point, shape) pairs for a scene of mixed shapes. See Narrowphase.h.
+*/
+
+//So the SSE kernels and the scalar tests always round the same way
+#include "NoContract.h"
+#include "Narrowphase.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_SSE
+#endif
+
+//The arrays each bucket copies out for a pair. Every bucket starts with the point.
+enum SphereField { SPHERE_PX, SPHERE_PY, SPHERE_PZ, SPHERE_CX, SPHERE_CY, SPHERE_CZ, SPHERE_R2, NUM_SPHERE_FIELDS };
+enum CapsuleField { CAPSULE_PX, CAPSULE_PY, CAPSULE_PZ, CAPSULE_AX, CAPSULE_AY, CAPSULE_AZ, CAPSULE_ABX, CAPSULE_ABY, CAPSULE_ABZ, CAPSULE_INV_LENGTH2, CAPSULE_R2, NUM_CAPSULE_FIELDS };
+enum OBBField { OBB_PX, OBB_PY, OBB_PZ, OBB_CX, OBB_CY, OBB_CZ, OBB_AXES, OBB_MIN = OBB_AXES + 9, OBB_MAX = OBB_MIN + 3, NUM_OBB_FIELDS = OBB_MAX + 3 };
+
+static const int NUM_FIELDS[NUM_SHAPE_TYPES] = { NUM_SPHERE_FIELDS, NUM_CAPSULE_FIELDS, NUM_OBB_FIELDS };
+
+int ShapeScene::Add(const Sphere &sphere)
+{
+	ShapeRef ref = { SHAPE_SPHERE, (int)this->spheres.size() };
+	this->spheres.push_back(sphere);
+	this->shapes.push_back(ref);
+	return (int)this->shapes.size() - 1;
+}
+
+int ShapeScene::Add(const Capsule &capsule)
+{
+	ShapeRef ref = { SHAPE_CAPSULE, (int)this->capsules.size() };
+	this->capsules.push_back(capsule);
+	this->shapes.push_back(ref);
+	return (int)this->shapes.size() - 1;
+}
+
+int ShapeScene::Add(const OBBCollider &box)
+{
+	ShapeRef ref = { SHAPE_OBB, (int)this->boxes.size() };
+	this->boxes.push_back(box);
+	this->shapes.push_back(ref);
+	return (int)this->shapes.size() - 1;
+}
+
+///
+//Gets 1 / |ab|^2 for a capsule's segment, or 0 if it is a single point
+static float InverseLengthSquared(const glm::vec3 &ab)
+{
+	float length2 = (ab.x * ab.x + ab.y * ab.y) + ab.z * ab.z;
+	return length2 > 0.0f ? 1.0f / length2 : 0.0f;
+}
+
+bool TestCollision(const Sphere &sphere, glm::vec3 point)
+{
+	glm::vec3 d = point - sphere.center;
+	return (d.x * d.x + d.y * d.y) + d.z * d.z <= sphere.radius * sphere.radius;
+}
+
+bool TestCollision(const Capsule &capsule, glm::vec3 point)
+{
+	//Find the closest point on the segment, then measure to it like a sphere
+	glm::vec3 ab = capsule.b - capsule.a;
+	glm::vec3 d = point - capsule.a;
+	float t = ((d.x * ab.x + d.y * ab.y) + d.z * ab.z) * InverseLengthSquared(ab);
+	t = std::min(std::max(t, 0.0f), 1.0f);
+
+	glm::vec3 e = d - ab * t;
+	return (e.x * e.x + e.y * e.y) + e.z * e.z <= capsule.radius * capsule.radius;
+}
+
+///
+//Tests a bucket of point - sphere pairs
+static void SphereKernel(const float* f, int n, unsigned char* results)
+{
+	const float* px = f + SPHERE_PX * n, *py = f + SPHERE_PY * n, *pz = f + SPHERE_PZ * n;
+	const float* cx = f + SPHERE_CX * n, *cy = f + SPHERE_CY * n, *cz = f + SPHERE_CZ * n;
+	const float* r2 = f + SPHERE_R2 * n;
+	int i = 0;
+
+#ifdef COLLISION_SSE
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(px + i), _mm_loadu_ps(cx + i));
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(py + i), _mm_loadu_ps(cy + i));
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(pz + i), _mm_loadu_ps(cz + i));
+		__m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+		int mask = _mm_movemask_ps(_mm_cmple_ps(distance2, _mm_loadu_ps(r2 + i)));
+		for (int lane = 0; lane < 4; lane++)
+			results[i + lane] = (unsigned char)((mask >> lane) & 1);
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		float dx = px[i] - cx[i], dy = py[i] - cy[i], dz = pz[i] - cz[i];
+		results[i] = (dx * dx + dy * dy) + dz * dz <= r2[i] ? 1 : 0;
+	}
+}
+
+///
+//Tests a bucket of point - capsule pairs
+static void CapsuleKernel(const float* f, int n, unsigned char* results)
+{
+	const float* px = f + CAPSULE_PX * n, *py = f + CAPSULE_PY * n, *pz = f + CAPSULE_PZ * n;
+	const float* ax = f + CAPSULE_AX * n, *ay = f + CAPSULE_AY * n, *az = f + CAPSULE_AZ * n;
+	const float* abx = f + CAPSULE_ABX * n, *aby = f + CAPSULE_ABY * n, *abz = f + CAPSULE_ABZ * n;
+	const float* invLength2 = f + CAPSULE_INV_LENGTH2 * n;
+	const float* r2 = f + CAPSULE_R2 * n;
+	int i = 0;
+
+#ifdef COLLISION_SSE
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(px + i), _mm_loadu_ps(ax + i));
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(py + i), _mm_loadu_ps(ay + i));
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(pz + i), _mm_loadu_ps(az + i));
+		__m128 sx = _mm_loadu_ps(abx + i), sy = _mm_loadu_ps(aby + i), sz = _mm_loadu_ps(abz + i);
+
+		__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, sx), _mm_mul_ps(dy, sy)), _mm_mul_ps(dz, sz));
+		t = _mm_min_ps(_mm_max_ps(_mm_mul_ps(t, _mm_loadu_ps(invLength2 + i)), zero), one);
+
+		__m128 ex = _mm_sub_ps(dx, _mm_mul_ps(sx, t));
+		__m128 ey = _mm_sub_ps(dy, _mm_mul_ps(sy, t));
+		__m128 ez = _mm_sub_ps(dz, _mm_mul_ps(sz, t));
+		__m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez));
+
+		int mask = _mm_movemask_ps(_mm_cmple_ps(distance2, _mm_loadu_ps(r2 + i)));
+		for (int lane = 0; lane < 4; lane++)
+			results[i + lane] = (unsigned char)((mask >> lane) & 1);
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		float dx = px[i] - ax[i], dy = py[i] - ay[i], dz = pz[i] - az[i];
+		float t = ((dx * abx[i] + dy * aby[i]) + dz * abz[i]) * invLength2[i];
+		t = std::min(std::max(t, 0.0f), 1.0f);
+
+		float ex = dx - abx[i] * t, ey = dy - aby[i] * t, ez = dz - abz[i] * t;
+		results[i] = (ex * ex + ey * ey) + ez * ez <= r2[i] ? 1 : 0;
+	}
+}
+
+///
+//Tests a bucket of point - OBB pairs
+static void OBBKernel(const float* f, int n, unsigned char* results)
+{
+	const float* px = f + OBB_PX * n, *py = f + OBB_PY * n, *pz = f + OBB_PZ * n;
+	const float* cx = f + OBB_CX * n, *cy = f + OBB_CY * n, *cz = f + OBB_CZ * n;
+	const float* axes = f + OBB_AXES * n;
+	const float* lo = f + OBB_MIN * n;
+	const float* hi = f + OBB_MAX * n;
+	int i = 0;
+
+#ifdef COLLISION_SSE
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(px + i), _mm_loadu_ps(cx + i));
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(py + i), _mm_loadu_ps(cy + i));
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(pz + i), _mm_loadu_ps(cz + i));
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int a = 0; a < 3; a++)
+		{
+			__m128 ax = _mm_loadu_ps(axes + (3 * a + 0) * n + i);
+			__m128 ay = _mm_loadu_ps(axes + (3 * a + 1) * n + i);
+			__m128 az = _mm_loadu_ps(axes + (3 * a + 2) * n + i);
+			__m128 sProj = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, dx), _mm_mul_ps(ay, dy)), _mm_mul_ps(az, dz));
+			inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(lo + a * n + i), sProj), _mm_cmple_ps(sProj, _mm_loadu_ps(hi + a * n + i))));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; lane++)
+			results[i + lane] = (unsigned char)((mask >> lane) & 1);
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		float dx = px[i] - cx[i], dy = py[i] - cy[i], dz = pz[i] - cz[i];
+		bool inside = true;
+		for (int a = 0; a < 3; a++)
+		{
+			float sProj = (axes[(3 * a + 0) * n + i] * dx + axes[(3 * a + 1) * n + i] * dy) + axes[(3 * a + 2) * n + i] * dz;
+			inside &= (lo[a * n + i] <= sProj) & (sProj <= hi[a * n + i]);
+		}
+		results[i] = inside ? 1 : 0;
+	}
+}
+
+void Narrowphase::Run(const ShapeScene &scene, const float* x, const float* y, const float* z, const CandidatePair* pairs, int count, unsigned char* results)
+{
+	//Sort the pairs into buckets by the kind of shape
+	for (int type = 0; type < NUM_SHAPE_TYPES; type++)
+		this->buckets[type].slots.clear();
+	for (int i = 0; i < count; i++)
+		this->buckets[scene.shapes[pairs[i].shape].type].slots.push_back(i);
+
+	//Copy each bucket's points and shapes out into its arrays
+	for (int type = 0; type < NUM_SHAPE_TYPES; type++)
+	{
+		Bucket &bucket = this->buckets[type];
+		int n = (int)bucket.slots.size();
+		bucket.fields.resize((size_t)n * NUM_FIELDS[type]);
+		bucket.results.resize(n);
+		float* f = bucket.fields.data();
+
+		for (int i = 0; i < n; i++)
+		{
+			const CandidatePair &pair = pairs[bucket.slots[i]];
+			int shape = scene.shapes[pair.shape].index;
+			f[0 * n + i] = x[pair.point];
+			f[1 * n + i] = y[pair.point];
+			f[2 * n + i] = z[pair.point];
+
+			if (type == SHAPE_SPHERE)
+			{
+				const Sphere &sphere = scene.spheres[shape];
+				f[SPHERE_CX * n + i] = sphere.center.x;
+				f[SPHERE_CY * n + i] = sphere.center.y;
+				f[SPHERE_CZ * n + i] = sphere.center.z;
+				f[SPHERE_R2 * n + i] = sphere.radius * sphere.radius;
+			}
+			else if (type == SHAPE_CAPSULE)
+			{
+				const Capsule &capsule = scene.capsules[shape];
+				glm::vec3 ab = capsule.b - capsule.a;
+				f[CAPSULE_AX * n + i] = capsule.a.x;
+				f[CAPSULE_AY * n + i] = capsule.a.y;
+				f[CAPSULE_AZ * n + i] = capsule.a.z;
+				f[CAPSULE_ABX * n + i] = ab.x;
+				f[CAPSULE_ABY * n + i] = ab.y;
+				f[CAPSULE_ABZ * n + i] = ab.z;
+				f[CAPSULE_INV_LENGTH2 * n + i] = InverseLengthSquared(ab);
+				f[CAPSULE_R2 * n + i] = capsule.radius * capsule.radius;
+			}
+			else
+			{
+				const OBBCollider &box = scene.boxes[shape];
+				f[OBB_CX * n + i] = box.center.x;
+				f[OBB_CY * n + i] = box.center.y;
+				f[OBB_CZ * n + i] = box.center.z;
+				for (int a = 0; a < 3; a++)
+				{
+					f[(OBB_AXES + 3 * a + 0) * n + i] = box.axes[a].x;
+					f[(OBB_AXES + 3 * a + 1) * n + i] = box.axes[a].y;
+					f[(OBB_AXES + 3 * a + 2) * n + i] = box.axes[a].z;
+					f[(OBB_MIN + a) * n + i] = box.min[a];
+					f[(OBB_MAX + a) * n + i] = box.max[a];
+				}
+			}
+		}
+	}
+
+	//Run one kernel per bucket
+	SphereKernel(this->buckets[SHAPE_SPHERE].fields.data(), (int)this->buckets[SHAPE_SPHERE].slots.size(), this->buckets[SHAPE_SPHERE].results.data());
+	CapsuleKernel(this->buckets[SHAPE_CAPSULE].fields.data(), (int)this->buckets[SHAPE_CAPSULE].slots.size(), this->buckets[SHAPE_CAPSULE].results.data());
+	OBBKernel(this->buckets[SHAPE_OBB].fields.data(), (int)this->buckets[SHAPE_OBB].slots.size(), this->buckets[SHAPE_OBB].results.data());
+
+	//Scatter the answers back to where the pairs came from
+	for (int type = 0; type < NUM_SHAPE_TYPES; type++)
+	{
+		const Bucket &bucket = this->buckets[type];
+		for (size_t i = 0; i < bucket.slots.size(); i++)
+			results[bucket.slots[i]] = bucket.results[i];
+	}
+}
@@ -0,0 +1,136 @@
+/*
+Title: Point - OBB
+File Name: Narrowphase.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Tests (point, shape) pairs for a scene holding spheres, capsules, and OBBs side by
+side, without a virtual call or a switch for every pair.
+
+The pairs, as they come out of a broadphase, are first sorted into one bucket per
+kind of shape. Each bucket then copies out its points and the shapes they are
+paired with into separate arrays (structure of arrays), so one branch-free kernel
+can run over the whole bucket four pairs at a time where SSE is available. Every
+bucket remembers where its pairs came from and writes its answers back there, so
+the results come out in the same order as the pairs went in.
+
+The OBB kernel is the one TestCollisions uses, except that each of the four lanes
+may be testing a different box.
+*/
+
+#ifndef _NARROWPHASE_H
+#define _NARROWPHASE_H
+
+#include <vector>
+#include "Collision.h"
+
+//A sphere in worldspace
+struct Sphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+//A capsule in worldspace: every point within radius of the segment from a to b
+struct Capsule
+{
+	glm::vec3 a;
+	glm::vec3 b;
+	float radius;
+};
+
+enum ShapeType
+{
+	SHAPE_SPHERE,
+	SHAPE_CAPSULE,
+	SHAPE_OBB,
+	NUM_SHAPE_TYPES
+};
+
+//A shape in a ShapeScene: which array it is in, and where
+struct ShapeRef
+{
+	ShapeType type;
+	int index;
+};
+
+//A scene of mixed shapes
+struct ShapeScene
+{
+	std::vector<Sphere> spheres;
+	std::vector<Capsule> capsules;
+	std::vector<OBBCollider> boxes;
+	std::vector<ShapeRef> shapes;	//Every shape, in the order they were added
+
+	///
+	//Adds a shape to the scene
+	//
+	//Returns:
+	//	The index of the new shape in shapes
+	int Add(const Sphere &sphere);
+	int Add(const Capsule &capsule);
+	int Add(const OBBCollider &box);
+};
+
+//A point which may be inside a shape
+struct CandidatePair
+{
+	int point;	//The index of the point
+	int shape;	//The index of the shape in the ShapeScene's shapes
+};
+
+///
+//Tests for collisions between a point and a sphere
+bool TestCollision(const Sphere &sphere, glm::vec3 point);
+
+///
+//Tests for collisions between a point and a capsule
+bool TestCollision(const Capsule &capsule, glm::vec3 point);
+
+class Narrowphase
+{
+public:
+	///
+	//Tests a list of candidate pairs
+	//
+	//Parameters:
+	//	scene: The shapes
+	//	x, y, z: The worldspace coordinates of the points
+	//	pairs: The pairs to test
+	//	count: The number of pairs
+	//	results: Receives 1 for each pair whose point is inside its shape, else 0,
+	//		in the same order as pairs
+	void Run(const ShapeScene &scene, const float* x, const float* y, const float* z, const CandidatePair* pairs, int count, unsigned char* results);
+
+private:
+	//The pairs of one kind of shape, as structure of arrays
+	struct Bucket
+	{
+		std::vector<int> slots;				//Where each pair came from in the input
+		std::vector<float> fields;			//numFields arrays of slots.size() floats, one after the other
+		std::vector<unsigned char> results;
+	};
+
+	//Kept between runs so the buckets do not need allocating every time
+	Bucket buckets[NUM_SHAPE_TYPES];
+};
+
+#endif _NARROWPHASE_H
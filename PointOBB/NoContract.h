@@ -0,0 +1,49 @@
+/*
+Title: Point - OBB
+File Name: NoContract.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Stops the compiler fusing a multiply and an add into one instruction for the rest
+of the file it is included in.
+
+A fused multiply-add rounds once where a separate multiply and add round twice, so
+whether the compiler fuses them changes the last bit of a result. The SIMD kernels
+and their scalar versions only give bit for bit the same answers if neither is
+fused, whatever the build flags or instruction set.
+
+Include this before every other header. With GCC it only applies to the functions
+which follow it, and the inline functions of glm need it too. GCC's default is
+-ffp-contract=fast.
+*/
+
+#ifndef _NO_CONTRACT_H
+#define _NO_CONTRACT_H
+
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#endif _NO_CONTRACT_H
@@ -0,0 +1,293 @@
+/*
+Title: Point - OBB
+File Name: Numa.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Helpers for machines with more than one NUMA node. See Numa.h.
+*/
+
+#include "Numa.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "HugePages.h"
+#include <thread>
+
+//The node each thread was pinned to
+static thread_local int currentNode = 0;
+
+///
+//Counts the pages some memory touches
+static size_t CountPages(const void* memory, size_t bytes, size_t pageBytes)
+{
+	if (bytes == 0)
+		return 0;
+	uintptr_t first = (uintptr_t)memory / pageBytes;
+	uintptr_t last = ((uintptr_t)memory + bytes - 1) / pageBytes;
+	return (size_t)(last - first + 1);
+}
+
+#ifdef __linux__
+
+#include <cstdio>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+//From linux/mempolicy.h
+static const int MPOL_BIND_POLICY = 2;
+
+///
+//Reads a sysfs list of ranges like "0-7,16-23"
+//
+//Returns:
+//	Every number in the ranges, empty if the file could not be read
+static std::vector<int> ReadRangeList(const char* path)
+{
+	std::vector<int> numbers;
+	FILE* file = fopen(path, "r");
+	if (file == nullptr)
+		return numbers;
+
+	int first, last;
+	while (fscanf(file, "%d", &first) == 1)
+	{
+		last = first;
+		int next = fgetc(file);
+		if (next == '-')
+		{
+			if (fscanf(file, "%d", &last) != 1)
+				break;
+			next = fgetc(file);
+		}
+		for (int number = first; number <= last; number++)
+			numbers.push_back(number);
+		if (next != ',')
+			break;
+	}
+
+	fclose(file);
+	return numbers;
+}
+
+///
+//Gets the system's numbers for the online nodes, in order.
+//The list may have gaps, so the nodes cannot simply be counted up from node0.
+static const std::vector<int> &OnlineNodes(void)
+{
+	static const std::vector<int> nodes = []()
+	{
+		std::vector<int> online = ReadRangeList("/sys/devices/system/node/online");
+		if (online.empty())
+			online.push_back(0);
+		return online;
+	}();
+	return nodes;
+}
+
+///
+//Turns the system's number for a node into ours
+//
+//Returns:
+//	The node, or -1 if the system's number is not an online node
+static int NodeFromId(int id)
+{
+	const std::vector<int> &nodes = OnlineNodes();
+	for (size_t node = 0; node < nodes.size(); node++)
+	{
+		if (nodes[node] == id)
+			return (int)node;
+	}
+	return -1;
+}
+
+int NumaNodeCount(void)
+{
+	return (int)OnlineNodes().size();
+}
+
+int NumaNodeId(int node)
+{
+	const std::vector<int> &nodes = OnlineNodes();
+	return node >= 0 && node < (int)nodes.size() ? nodes[node] : -1;
+}
+
+std::vector<int> NumaNodeCpus(int node)
+{
+	int id = NumaNodeId(node);
+	if (id < 0)
+		return std::vector<int>();
+
+	char path[64];
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+	return ReadRangeList(path);
+}
+
+bool PinThreadToNode(int node)
+{
+	std::vector<int> cpus = NumaNodeCpus(node);
+	if (cpus.empty())
+		return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (size_t i = 0; i < cpus.size(); i++)
+	{
+		if (cpus[i] < CPU_SETSIZE)
+			CPU_SET(cpus[i], &set);
+	}
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+		return false;
+
+	currentNode = node;
+	return true;
+}
+
+void* NumaAllocate(size_t bytes, int node)
+{
+	//Big arrays go in huge pages, which the binding below still applies to
+	void* memory;
+	if (bytes >= HUGE_PAGE_SIZE)
+	{
+		memory = HugeAllocate(bytes, false).memory;
+		if (memory == nullptr)
+			return nullptr;
+		bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	}
+	else
+	{
+		memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (memory == MAP_FAILED)
+			return nullptr;
+	}
+
+	//Nothing to place on a single node machine, and fresh pages are already zero
+	if (NumaNodeCount() <= 1)
+		return memory;
+
+#ifdef SYS_mbind
+	unsigned long mask[4] = {};
+	int id = NumaNodeId(node);
+	if (id >= 0 && id < (int)(sizeof(mask) * 8))
+	{
+		mask[id / (8 * sizeof(unsigned long))] |= 1UL << (id % (8 * sizeof(unsigned long)));
+		syscall(SYS_mbind, memory, bytes, MPOL_BIND_POLICY, mask, sizeof(mask) * 8, 0);
+	}
+#endif
+
+	//Fault the pages in from the node itself
+	std::thread toucher([memory, bytes, node]()
+	{
+		PinThreadToNode(node);
+		memset(memory, 0, bytes);
+	});
+	toucher.join();
+
+	return memory;
+}
+
+void NumaFree(void* memory, size_t bytes)
+{
+	if (memory == nullptr)
+		return;
+
+	if (bytes >= HUGE_PAGE_SIZE)
+		bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	munmap(memory, bytes);
+}
+
+std::vector<int> NumaPageNodes(const void* memory, size_t bytes, size_t &pageBytes)
+{
+	pageBytes = (size_t)sysconf(_SC_PAGESIZE);
+	uintptr_t first = (uintptr_t)memory / pageBytes * pageBytes;
+	size_t numPages = CountPages(memory, bytes, pageBytes);
+
+	//Everything is on the one node, if it has been touched at all
+	std::vector<int> nodes(numPages, 0);
+	if (NumaNodeCount() <= 1)
+		return nodes;
+
+#ifdef SYS_move_pages
+	//With no target nodes, move_pages only reports where each page is
+	std::vector<void*> pages(numPages);
+	std::vector<int> status(numPages);
+	for (size_t p = 0; p < numPages; p++)
+		pages[p] = (void*)(first + p * pageBytes);
+	if (numPages > 0 && syscall(SYS_move_pages, 0, (unsigned long)numPages, pages.data(), nullptr, status.data(), 0) == 0)
+	{
+		for (size_t p = 0; p < numPages; p++)
+			nodes[p] = status[p] >= 0 ? NodeFromId(status[p]) : -1;
+		return nodes;
+	}
+#endif
+
+	std::fill(nodes.begin(), nodes.end(), -1);
+	return nodes;
+}
+
+#else
+
+int NumaNodeCount(void)
+{
+	return 1;
+}
+
+int NumaNodeId(int node)
+{
+	return node == 0 ? 0 : -1;
+}
+
+std::vector<int> NumaNodeCpus(int node)
+{
+	return std::vector<int>();
+}
+
+bool PinThreadToNode(int node)
+{
+	return false;
+}
+
+void* NumaAllocate(size_t bytes, int node)
+{
+	return calloc(bytes, 1);
+}
+
+void NumaFree(void* memory, size_t bytes)
+{
+	free(memory);
+}
+
+std::vector<int> NumaPageNodes(const void* memory, size_t bytes, size_t &pageBytes)
+{
+	//Everything is on the only node
+	pageBytes = 4096;
+	return std::vector<int>(CountPages(memory, bytes, pageBytes), 0);
+}
+
+#endif
+
+int CurrentNumaNode(void)
+{
+	return currentNode;
+}
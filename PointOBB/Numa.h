@@ -0,0 +1,168 @@
+/*
+Title: Point - OBB
+File Name: Numa.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Helpers for machines with more than one NUMA node (for example two sockets), where
+each node's memory is quick for that node's cores and slow for the others'. They
+find the nodes and their CPUs, pin a thread to a node, allocate memory on a node,
+and keep a copy of read-only data on every node.
+
+Nodes are numbered 0 up to NumaNodeCount() - 1 here, in the order of the system's
+own node numbers. Those can have gaps, for example when a node is offline or has
+no memory, so NumaNodeId gives the system's number for a node where it matters.
+
+Only Linux is supported, by reading /sys/devices/system/node and calling mbind
+and move_pages directly, so libnuma is not needed. Anywhere else, or on a machine with one node,
+everything acts as if there is a single node 0, so code using these helpers
+needs no special cases.
+*/
+
+#ifndef _NUMA_H
+#define _NUMA_H
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+///
+//Gets the number of NUMA nodes, which is 1 if NUMA is not available
+int NumaNodeCount(void);
+
+///
+//Gets the system's number for a node, which is only different from node when
+//the system's node numbers have gaps
+//
+//Returns:
+//	The number, or -1 if there is no such node
+int NumaNodeId(int node);
+
+///
+//Gets the CPUs which belong to a node
+//
+//Returns:
+//	The CPU numbers, empty if they are not known
+std::vector<int> NumaNodeCpus(int node);
+
+///
+//Pins the calling thread to the CPUs of a node, and remembers the node as the
+//thread's own for CurrentNumaNode
+//
+//Returns:
+//	true if the thread was pinned, else false
+bool PinThreadToNode(int node);
+
+///
+//Gets the node the calling thread was pinned to by PinThreadToNode, or 0
+int CurrentNumaNode(void);
+
+///
+//Allocates memory whose pages are placed on a node
+//
+//Overview:
+//	The pages are bound to the node with mbind, and then touched by a thread
+//	pinned to the node, so they land there even where binding is not allowed.
+//	Allocations of a huge page or more are made with HugeAllocate.
+//
+//Parameters:
+//	bytes: The size of the memory
+//	node: The node to place it on
+//
+//Returns:
+//	The memory, zeroed, or null if it could not be allocated. Free with NumaFree.
+void* NumaAllocate(size_t bytes, int node);
+
+///
+//Frees memory from NumaAllocate
+void NumaFree(void* memory, size_t bytes);
+
+///
+//Finds the node each page of some memory is on
+//
+//Parameters:
+//	memory: The start of the memory
+//	bytes: The size of the memory
+//	pageBytes: Receives the size of the pages the nodes are given for
+//
+//Returns:
+//	The node of each page, starting with the page memory is in, or -1 for
+//	a page which has not been touched yet or whose node is not known
+std::vector<int> NumaPageNodes(const void* memory, size_t bytes, size_t &pageBytes);
+
+//A copy of a read-only array on every node, so each thread reads its own node's
+template <typename T>
+class NumaReplicated
+{
+public:
+	///
+	//Copies an array to every node
+	//
+	//Parameters:
+	//	data: The array, which may be freed afterwards
+	//	count: The number of items in it
+	NumaReplicated(const T* data, size_t count)
+	{
+		this->count = count;
+		int numNodes = NumaNodeCount();
+		for (int node = 0; node < numNodes; node++)
+		{
+			T* copy = (T*)NumaAllocate(count * sizeof(T) + 1, node);
+			if (copy != nullptr && count > 0)
+				memcpy(copy, data, count * sizeof(T));
+			this->copies.push_back(copy);
+		}
+	}
+
+	~NumaReplicated(void)
+	{
+		for (size_t node = 0; node < this->copies.size(); node++)
+			NumaFree(this->copies[node], this->count * sizeof(T) + 1);
+	}
+
+	NumaReplicated(const NumaReplicated &) = delete;
+	NumaReplicated &operator=(const NumaReplicated &) = delete;
+
+	///
+	//Gets the copy on a node
+	const T* OnNode(int node) const
+	{
+		return this->copies[(size_t)node < this->copies.size() ? node : 0];
+	}
+
+	///
+	//Gets the copy on the calling thread's node
+	const T* Local(void) const
+	{
+		return this->OnNode(CurrentNumaNode());
+	}
+
+	size_t Size(void) const
+	{
+		return this->count;
+	}
+
+private:
+	std::vector<T*> copies;
+	size_t count;
+};
+
+#endif _NUMA_H
@@ -0,0 +1,339 @@
+/*
+Title: Point - OBB
+File Name: OBBFitting.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Fits an OBB around a set of vertices. See OBBFitting.h.
+*/
+
+#include "OBBFitting.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "Parallel.h"
+
+//A box along a set of axes, before it is turned into a FittedOBB
+struct AxisBox
+{
+	glm::vec3 axes[3];
+	glm::vec3 min, max;
+
+	float Volume(void) const
+	{
+		glm::vec3 size = this->max - this->min;
+		return size.x * size.y * size.z;
+	}
+};
+
+///
+//Works out the mean and covariance matrix of the vertices
+//
+//Overview:
+//	The sums are split between four sets of accumulators, one per vertex in each
+//	group of four, so the additions do not all wait on each other and the compiler
+//	is free to run them side by side.
+static void Covariance(const float* positions, int count, int stride, glm::dvec3 &mean, double covariance[3][3])
+{
+	double sum[4][9] = {};
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		for (int lane = 0; lane < 4; lane++)
+		{
+			const float* p = positions + (size_t)(i + lane) * stride;
+			double x = p[0], y = p[1], z = p[2];
+			double* s = sum[lane];
+			s[0] += x; s[1] += y; s[2] += z;
+			s[3] += x * x; s[4] += x * y; s[5] += x * z;
+			s[6] += y * y; s[7] += y * z; s[8] += z * z;
+		}
+	}
+	for (; i < count; i++)
+	{
+		const float* p = positions + (size_t)i * stride;
+		double x = p[0], y = p[1], z = p[2];
+		double* s = sum[0];
+		s[0] += x; s[1] += y; s[2] += z;
+		s[3] += x * x; s[4] += x * y; s[5] += x * z;
+		s[6] += y * y; s[7] += y * z; s[8] += z * z;
+	}
+
+	double total[9];
+	for (int k = 0; k < 9; k++)
+		total[k] = (sum[0][k] + sum[1][k]) + (sum[2][k] + sum[3][k]);
+
+	double n = (double)count;
+	mean = glm::dvec3(total[0], total[1], total[2]) / n;
+
+	covariance[0][0] = total[3] / n - mean.x * mean.x;
+	covariance[0][1] = total[4] / n - mean.x * mean.y;
+	covariance[0][2] = total[5] / n - mean.x * mean.z;
+	covariance[1][1] = total[6] / n - mean.y * mean.y;
+	covariance[1][2] = total[7] / n - mean.y * mean.z;
+	covariance[2][2] = total[8] / n - mean.z * mean.z;
+	covariance[1][0] = covariance[0][1];
+	covariance[2][0] = covariance[0][2];
+	covariance[2][1] = covariance[1][2];
+}
+
+///
+//Finds the eigenvectors of a symmetric 3x3 matrix with Jacobi rotations
+//
+//Overview:
+//	Each step picks the largest entry off the diagonal and rotates it away.
+//	The product of all the rotations ends up holding the eigenvectors.
+static void Eigenvectors(double a[3][3], glm::vec3 axes[3])
+{
+	double v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+	for (int iteration = 0; iteration < 50; iteration++)
+	{
+		int p = 0, q = 1;
+		if (std::fabs(a[0][2]) > std::fabs(a[p][q]))
+		{
+			p = 0;
+			q = 2;
+		}
+		if (std::fabs(a[1][2]) > std::fabs(a[p][q]))
+		{
+			p = 1;
+			q = 2;
+		}
+		if (std::fabs(a[p][q]) < 1e-12)
+			break;
+
+		double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+		double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+		double c = 1.0 / std::sqrt(t * t + 1.0);
+		double s = t * c;
+
+		for (int k = 0; k < 3; k++)
+		{
+			double akp = a[k][p], akq = a[k][q];
+			a[k][p] = c * akp - s * akq;
+			a[k][q] = s * akp + c * akq;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			double apk = a[p][k], aqk = a[q][k];
+			a[p][k] = c * apk - s * aqk;
+			a[q][k] = s * apk + c * aqk;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			double vkp = v[k][p], vkq = v[k][q];
+			v[k][p] = c * vkp - s * vkq;
+			v[k][q] = s * vkp + c * vkq;
+		}
+	}
+
+	for (int i = 0; i < 3; i++)
+		axes[i] = glm::vec3((float)v[0][i], (float)v[1][i], (float)v[2][i]);
+}
+
+///
+//Makes a set of axes exactly unit length, perpendicular, and right-handed,
+//so they form a proper rotation
+static void Orthonormalize(glm::vec3 axes[3])
+{
+	axes[0] = glm::normalize(axes[0]);
+	axes[1] = glm::normalize(axes[1] - axes[0] * glm::dot(axes[0], axes[1]));
+	axes[2] = glm::cross(axes[0], axes[1]);
+}
+
+///
+//Makes the box along a set of axes just big enough to hold every vertex
+static AxisBox BoundAlong(const float* positions, int count, int stride, const glm::vec3 axes[3])
+{
+	AxisBox box;
+	box.axes[0] = axes[0];
+	box.axes[1] = axes[1];
+	box.axes[2] = axes[2];
+	box.min = glm::vec3(FLT_MAX);
+	box.max = glm::vec3(-FLT_MAX);
+
+	for (int i = 0; i < count; i++)
+	{
+		const float* p = positions + (size_t)i * stride;
+		glm::vec3 point(p[0], p[1], p[2]);
+		glm::vec3 projection(glm::dot(axes[0], point), glm::dot(axes[1], point), glm::dot(axes[2], point));
+		box.min = glm::min(box.min, projection);
+		box.max = glm::max(box.max, projection);
+	}
+
+	return box;
+}
+
+///
+//Cross product of (b - a) and (c - a) in 2D
+static float Turn(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c)
+{
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+///
+//Finds the convex hull of a set of 2D points with Andrew's monotone chain
+static std::vector<glm::vec2> ConvexHull(std::vector<glm::vec2> &points)
+{
+	std::sort(points.begin(), points.end(), [](const glm::vec2 &a, const glm::vec2 &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+
+	std::vector<glm::vec2> hull(2 * points.size());
+	size_t k = 0;
+
+	//Lower hull, then upper hull
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		while (k >= 2 && Turn(hull[k - 2], hull[k - 1], points[i]) <= 0.0f)
+			k--;
+		hull[k++] = points[i];
+	}
+	for (size_t i = points.size() - 1, lower = k + 1; i > 0; i--)
+	{
+		while (k >= lower && Turn(hull[k - 2], hull[k - 1], points[i - 1]) <= 0.0f)
+			k--;
+		hull[k++] = points[i - 1];
+	}
+
+	hull.resize(k > 1 ? k - 1 : k);
+	return hull;
+}
+
+///
+//Fits the smallest box which has one particular axis as "up"
+//
+//Parameters:
+//	up: Which of the PCA axes to keep
+static AxisBox FitAroundAxis(const float* positions, int count, int stride, const glm::vec3 pca[3], int up)
+{
+	glm::vec3 u = pca[up];
+	glm::vec3 e1 = pca[(up + 1) % 3];
+	glm::vec3 e2 = pca[(up + 2) % 3];
+
+	//Flatten the vertices onto the plane at right angles to up
+	std::vector<glm::vec2> flat(count);
+	for (int i = 0; i < count; i++)
+	{
+		const float* p = positions + (size_t)i * stride;
+		glm::vec3 point(p[0], p[1], p[2]);
+		flat[i] = glm::vec2(glm::dot(e1, point), glm::dot(e2, point));
+	}
+	std::vector<glm::vec2> hull = ConvexHull(flat);
+
+	//Try a rectangle side along each hull edge
+	float bestArea = FLT_MAX;
+	glm::vec2 bestDirection(1.0f, 0.0f);
+	for (size_t i = 0; i < hull.size(); i++)
+	{
+		glm::vec2 edge = hull[(i + 1) % hull.size()] - hull[i];
+		float length = glm::length(edge);
+		if (length < 1e-12f)
+			continue;
+		glm::vec2 d = edge / length;
+		glm::vec2 n(-d.y, d.x);
+
+		float minD = FLT_MAX, maxD = -FLT_MAX, minN = FLT_MAX, maxN = -FLT_MAX;
+		for (size_t j = 0; j < hull.size(); j++)
+		{
+			float pd = glm::dot(d, hull[j]);
+			float pn = glm::dot(n, hull[j]);
+			minD = std::min(minD, pd);
+			maxD = std::max(maxD, pd);
+			minN = std::min(minN, pn);
+			maxN = std::max(maxN, pn);
+		}
+
+		float area = (maxD - minD) * (maxN - minN);
+		if (area < bestArea)
+		{
+			bestArea = area;
+			bestDirection = d;
+		}
+	}
+
+	//Turn the best 2D direction back into 3D axes
+	glm::vec3 axes[3];
+	axes[0] = e1 * bestDirection.x + e2 * bestDirection.y;
+	axes[1] = e1 * -bestDirection.y + e2 * bestDirection.x;
+	axes[2] = u;
+	Orthonormalize(axes);
+
+	return BoundAlong(positions, count, stride, axes);
+}
+
+FittedOBB FitOBB(const float* positions, int count, int stride, bool refine)
+{
+	FittedOBB fitted;
+	fitted.translation = glm::mat4(1.0f);
+	fitted.rotation = glm::mat4(1.0f);
+	fitted.box = OBB(0.0f, 0.0f, 0.0f);
+	if (count <= 0)
+		return fitted;
+
+	glm::dvec3 mean;
+	double covariance[3][3];
+	Covariance(positions, count, stride, mean, covariance);
+
+	glm::vec3 axes[3];
+	Eigenvectors(covariance, axes);
+	Orthonormalize(axes);
+
+	AxisBox best = BoundAlong(positions, count, stride, axes);
+	if (refine && count >= 3)
+	{
+		for (int up = 0; up < 3; up++)
+		{
+			AxisBox candidate = FitAroundAxis(positions, count, stride, axes, up);
+			if (candidate.Volume() < best.Volume())
+				best = candidate;
+		}
+	}
+
+	//The middle of the box in worldspace
+	glm::vec3 mid = (best.min + best.max) * 0.5f;
+	glm::vec3 center = best.axes[0] * mid.x + best.axes[1] * mid.y + best.axes[2] * mid.z;
+
+	//Pad the box by a few rounding errors, so the vertices which set its bounds
+	//still test as inside once the center and half sizes have been rounded
+	float reach = glm::length(glm::max(glm::abs(best.min), glm::abs(best.max)));
+	glm::vec3 size = best.max - best.min + glm::vec3(reach * (16.0f * FLT_EPSILON));
+	fitted.box = OBB(size.x, size.y, size.z);
+	fitted.translation[3] = glm::vec4(center, 1.0f);
+	for (int a = 0; a < 3; a++)
+		fitted.rotation[a] = glm::vec4(best.axes[a], 0.0f);
+
+	return fitted;
+}
+
+void FitOBBs(const FitInput* meshes, int numMeshes, FittedOBB* results, bool refine, int numThreads)
+{
+	ParallelFor(numMeshes, 16, numThreads, [&](int begin, int end)
+	{
+		for (int m = begin; m < end; m++)
+			results[m] = FitOBB(meshes[m].positions, meshes[m].count, meshes[m].stride, refine);
+	});
+}
+
+float Volume(const FittedOBB &fitted)
+{
+	return fitted.box.width * fitted.box.height * fitted.box.depth;
+}
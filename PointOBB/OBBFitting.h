@@ -0,0 +1,94 @@
+/*
+Title: Point - OBB
+File Name: OBBFitting.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Fits an OBB around a set of vertices, instead of building one by hand the way
+main() does from the differences between the box's vertices.
+
+The first guess at the box's axes comes from principal component analysis: the
+covariance matrix of the vertices is worked out, and its eigenvectors point along
+the directions the vertices are most and least spread out in. The box is then
+made just big enough to hold every vertex along those axes.
+
+PCA is easily fooled by uneven vertex density, so the fit can be refined. Each
+of the three axes is tried as the box's "up" direction: the vertices are flattened
+onto the plane at right angles to it, and the smallest rectangle around their 2D
+convex hull is found. The smallest rectangle always has a side lying along an edge
+of the hull (the idea behind rotating calipers), so only the hull's edge directions
+need to be tried. Whichever of the resulting boxes has the least volume is kept.
+
+The result is an OBB with translation and rotation matrices, ready to be used the
+same way the demo's box is.
+*/
+
+#ifndef _OBB_FITTING_H
+#define _OBB_FITTING_H
+
+#include "Collision.h"
+
+//A fitted box, with an identity scale
+struct FittedOBB
+{
+	OBB box;
+	glm::mat4 translation;
+	glm::mat4 rotation;
+};
+
+//A vertex array to fit a box to
+struct FitInput
+{
+	const float* positions;	//The x, y, z of the first vertex
+	int count;				//The number of vertices
+	int stride;				//The number of floats from one vertex to the next
+};
+
+///
+//Fits an OBB around a set of vertices
+//
+//Parameters:
+//	positions: The x, y, z of the first vertex
+//	count: The number of vertices
+//	stride: The number of floats from one vertex to the next
+//		(3 for packed positions, 7 for the demo's Vertex struct)
+//	refine: Whether to improve the PCA fit using the convex hull
+//
+//Returns:
+//	The fitted box
+FittedOBB FitOBB(const float* positions, int count, int stride, bool refine);
+
+///
+//Fits OBBs to many vertex arrays at once
+//
+//Parameters:
+//	meshes: The vertex arrays
+//	numMeshes: The number of vertex arrays
+//	results: Receives one box per vertex array
+//	refine: Whether to improve the PCA fits using the convex hull
+//	numThreads: The number of threads to use, or 0 for one per hardware thread
+void FitOBBs(const FitInput* meshes, int numMeshes, FittedOBB* results, bool refine, int numThreads);
+
+///
+//Gets the volume of a fitted box
+float Volume(const FittedOBB &fitted);
+
+#endif _OBB_FITTING_H
@@ -0,0 +1,154 @@
+/*
+Title: Point - OBB
+File Name: OBBTree.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A tree of OBBs fitted to a mesh. See OBBTree.h.
+*/
+
+#include "OBBTree.h"
+#include <algorithm>
+#include "OBBFitting.h"
+
+//The deepest a tree built by Build can be, which bounds the traversal stack
+static const int MAX_DEPTH = 64;
+
+void OBBTree::Build(const float* positions, int numVertices, int stride, int maxLeafTriangles, bool refine)
+{
+	this->positions = positions;
+	this->stride = stride;
+	this->maxLeafTriangles = std::max(1, maxLeafTriangles);
+	this->refine = refine;
+
+	int numTriangles = numVertices / 3;
+	this->nodes.clear();
+	this->triangles.resize(numTriangles);
+	this->centroids.resize(numTriangles);
+	for (int t = 0; t < numTriangles; t++)
+	{
+		const float* a = positions + (size_t)(3 * t) * stride;
+		const float* b = a + stride;
+		const float* c = b + stride;
+		this->triangles[t] = t;
+		this->centroids[t] = glm::vec3(a[0] + b[0] + c[0], a[1] + b[1] + c[1], a[2] + b[2] + c[2]) / 3.0f;
+	}
+
+	if (numTriangles > 0)
+	{
+		this->nodes.reserve(2 * numTriangles);
+		this->nodes.push_back(OBBTreeNode());
+		this->BuildNode(0, 0, numTriangles, 0);
+	}
+
+	//Only the boxes are needed once the tree is built
+	this->positions = nullptr;
+	std::vector<glm::vec3>().swap(this->centroids);
+	std::vector<float>().swap(this->scratch);
+}
+
+///
+//Fills in a node over triangles[start] up to triangles[start + count], and everything beneath it
+void OBBTree::BuildNode(int node, int start, int count, int depth)
+{
+	//Gather the vertices under this node and fit a box to them
+	this->scratch.resize((size_t)count * 9);
+	for (int i = 0; i < count; i++)
+	{
+		const float* vertex = this->positions + (size_t)(3 * this->triangles[start + i]) * this->stride;
+		for (int v = 0; v < 3; v++, vertex += this->stride)
+		{
+			float* out = &this->scratch[(size_t)(3 * i + v) * 3];
+			out[0] = vertex[0];
+			out[1] = vertex[1];
+			out[2] = vertex[2];
+		}
+	}
+	FittedOBB fitted = FitOBB(this->scratch.data(), count * 3, 3, this->refine);
+	this->nodes[node].box = PrepareCollider(fitted.box, fitted.translation, fitted.rotation, glm::mat4(1.0f));
+
+	//The depth limit keeps the traversal stack in bounds. Halving makes it unreachable in practice.
+	if (count <= this->maxLeafTriangles || depth + 1 >= MAX_DEPTH)
+	{
+		this->nodes[node].start = start;
+		this->nodes[node].count = count;
+		return;
+	}
+
+	//Split at the median centroid along the longest side of the box
+	const OBBCollider &box = this->nodes[node].box;
+	glm::vec3 size = box.max - box.min;
+	int axis = 0;
+	if (size.y > size[axis])
+		axis = 1;
+	if (size.z > size[axis])
+		axis = 2;
+	glm::vec3 direction = box.axes[axis];
+
+	int half = count / 2;
+	const std::vector<glm::vec3> &centroids = this->centroids;
+	std::nth_element(this->triangles.begin() + start, this->triangles.begin() + start + half, this->triangles.begin() + start + count,
+		[&centroids, direction](int a, int b) { return glm::dot(direction, centroids[a]) < glm::dot(direction, centroids[b]); });
+
+	int left = (int)this->nodes.size();
+	this->nodes.push_back(OBBTreeNode());
+	this->nodes.push_back(OBBTreeNode());
+	this->nodes[node].start = left;
+	this->nodes[node].count = 0;
+
+	this->BuildNode(left, start, half, depth + 1);
+	this->BuildNode(left + 1, start + half, count - half, depth + 1);
+}
+
+bool OBBTree::TestCollision(glm::vec3 point) const
+{
+	if (this->nodes.empty())
+		return false;
+
+	int stack[MAX_DEPTH * 2];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const OBBTreeNode &node = this->nodes[stack[--top]];
+		if (!::TestCollision(node.box, point))
+			continue;
+
+		if (node.count > 0)
+			return true;
+
+		stack[top++] = node.start + 1;
+		stack[top++] = node.start;
+	}
+
+	return false;
+}
+
+const std::vector<OBBTreeNode> &OBBTree::Nodes(void) const
+{
+	return this->nodes;
+}
+
+const std::vector<int> &OBBTree::Triangles(void) const
+{
+	return this->triangles;
+}
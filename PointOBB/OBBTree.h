@@ -0,0 +1,100 @@
+/*
+Title: Point - OBB
+File Name: OBBTree.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A tree of OBBs fitted to a mesh, for objects one box fits too loosely. The root
+box holds the whole mesh, and each node below holds a part of it, so a point near
+the object but away from any of its parts is missed by the leaves even though it
+is inside the root.
+
+The tree is built top-down from the mesh's triangles. A box is fitted to the
+vertices of the triangles under a node with FitOBB, then the triangles are split
+in half at the median of their centroids along the longest side of that box, until
+few enough are left to make a leaf. As in ColliderBVH, nodes are stored in one array
+and the two children of a node are always next to each other.
+
+A point is inside the tree if it is inside a leaf. The search walks down from the
+root with the prepared point - OBB test and drops a branch the moment a box misses.
+
+The tree lives in the mesh's local space, the same space as its vertices. A
+worldspace point must be moved into that space (by the inverse of the mesh's
+translation * rotation * scale) before it is tested.
+*/
+
+#ifndef _OBB_TREE_H
+#define _OBB_TREE_H
+
+#include <vector>
+#include "Collision.h"
+
+//A node in an OBBTree
+struct OBBTreeNode
+{
+	OBBCollider box;
+	int start;	//Leaf: the first entry in the tree's triangles. Otherwise: the first child
+	int count;	//Leaf: the number of triangles in it. Otherwise: 0
+};
+
+class OBBTree
+{
+public:
+	///
+	//Builds the tree over the triangles of a mesh
+	//
+	//Parameters:
+	//	positions: The x, y, z of the first vertex. Every three vertices are a triangle.
+	//	numVertices: The number of vertices
+	//	stride: The number of floats from one vertex to the next
+	//		(3 for packed positions, 7 for the demo's Vertex struct)
+	//	maxLeafTriangles: The most triangles to put in one leaf
+	//	refine: Whether to refine each node's box, see FitOBB
+	void Build(const float* positions, int numVertices, int stride, int maxLeafTriangles, bool refine);
+
+	///
+	//Tests for collisions between a point and the leaves of the tree
+	//
+	//Parameters:
+	//	point: The point in the mesh's local space
+	//
+	//Returns:
+	//	true if a collision is detected, else false
+	bool TestCollision(glm::vec3 point) const;
+
+	const std::vector<OBBTreeNode> &Nodes(void) const;
+	const std::vector<int> &Triangles(void) const;
+
+private:
+	void BuildNode(int node, int start, int count, int depth);
+
+	const float* positions;
+	int stride;
+	int maxLeafTriangles;
+	bool refine;
+
+	std::vector<OBBTreeNode> nodes;
+	std::vector<int> triangles;			//Triangle indices, ordered so every leaf's are together
+	std::vector<glm::vec3> centroids;	//The centroid of each triangle
+	std::vector<float> scratch;			//The vertices of the node being fitted
+};
+
+#endif _OBB_TREE_H
@@ -0,0 +1,88 @@
+/*
+Title: Point - OBB
+File Name: Parallel.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Splits a loop over count items into chunks and runs the chunks on several threads.
+Threads take the next chunk from a shared counter when they finish one, so a chunk
+which happens to be slow does not hold up the rest.
+*/
+
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+///
+//Runs body(begin, end) over [0, count) in chunks of grain items on several threads
+//
+//Parameters:
+//	count: The number of items
+//	grain: The number of items in each chunk
+//	numThreads: The number of threads to use, or 0 for one per hardware thread
+//	body: Called with the range of each chunk, from any of the threads
+template <typename Body>
+void ParallelFor(int count, int grain, int numThreads, const Body &body)
+{
+	if (grain < 1)
+		grain = 1;
+	if (numThreads <= 0)
+		numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+
+	int numChunks = (count + grain - 1) / grain;
+	numThreads = std::min(numThreads, numChunks);
+
+	//Not worth starting any threads
+	if (numThreads <= 1)
+	{
+		if (count > 0)
+			body(0, count);
+		return;
+	}
+
+	std::atomic<int> nextChunk(0);
+	auto run = [&]()
+	{
+		for (;;)
+		{
+			int chunk = nextChunk.fetch_add(1);
+			if (chunk >= numChunks)
+				return;
+			int begin = chunk * grain;
+			body(begin, std::min(count, begin + grain));
+		}
+	};
+
+	//The calling thread does its share too
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numThreads; t++)
+		threads.push_back(std::thread(run));
+	run();
+
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+}
+
+#endif _PARALLEL_H
@@ -0,0 +1,203 @@
+/*
+Title: Point - OBB
+File Name: PointKDTree.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A kd-tree over a fixed cloud of points. See PointKDTree.h.
+*/
+
+#include "PointKDTree.h"
+#include <algorithm>
+#include <cfloat>
+
+PointKDTree::PointKDTree(void)
+{
+	this->numLevels = 0;
+	this->numLeaves = 0;
+}
+
+int PointKDTree::Size(void) const
+{
+	return (int)this->original.size();
+}
+
+///
+//Gets the first reordered point in a leaf. Every leaf gets an equal share.
+int PointKDTree::LeafStart(int leaf) const
+{
+	return (int)((long long)leaf * this->Size() / this->numLeaves);
+}
+
+void PointKDTree::Build(const float* x, const float* y, const float* z, int count, int bucketSize)
+{
+	//Enough leaves that none holds more than bucketSize points
+	bucketSize = std::max(1, bucketSize);
+	this->numLevels = 1;
+	this->numLeaves = 1;
+	while ((long long)this->numLeaves * bucketSize < count)
+	{
+		this->numLeaves *= 2;
+		this->numLevels++;
+	}
+
+	this->original.resize(count);
+	for (int i = 0; i < count; i++)
+		this->original[i] = i;
+
+	//Keep the points in their original order while building,
+	//only the indices are shuffled around
+	this->x.assign(x, x + count);
+	this->y.assign(y, y + count);
+	this->z.assign(z, z + count);
+
+	this->bounds.resize(2 * this->numLeaves - 1);
+	if (count > 0)
+		this->BuildNode(0, 0, this->numLeaves);
+
+	//Now lay the points out bucket by bucket
+	HugeVector<float> sortedX(count), sortedY(count), sortedZ(count);
+	for (int i = 0; i < count; i++)
+	{
+		sortedX[i] = x[this->original[i]];
+		sortedY[i] = y[this->original[i]];
+		sortedZ[i] = z[this->original[i]];
+	}
+	this->x.swap(sortedX);
+	this->y.swap(sortedY);
+	this->z.swap(sortedZ);
+}
+
+///
+//Splits the points under a node between its children and bounds them
+void PointKDTree::BuildNode(int node, int firstLeaf, int numLeaves)
+{
+	int start = this->LeafStart(firstLeaf);
+	int end = this->LeafStart(firstLeaf + numLeaves);
+
+	AABB box;
+	box.min = glm::vec3(FLT_MAX);
+	box.max = glm::vec3(-FLT_MAX);
+	for (int i = start; i < end; i++)
+	{
+		glm::vec3 p(this->x[this->original[i]], this->y[this->original[i]], this->z[this->original[i]]);
+		box.min = glm::min(box.min, p);
+		box.max = glm::max(box.max, p);
+	}
+	this->bounds[node] = box;
+
+	if (numLeaves == 1)
+		return;
+
+	//Split where the left child's last leaf ends, along the widest axis
+	glm::vec3 size = box.max - box.min;
+	int axis = 0;
+	if (size.y > size[axis])
+		axis = 1;
+	if (size.z > size[axis])
+		axis = 2;
+	const float* coordinate = axis == 0 ? &this->x[0] : (axis == 1 ? &this->y[0] : &this->z[0]);
+
+	int half = numLeaves / 2;
+	int split = this->LeafStart(firstLeaf + half);
+	if (start < split && split < end)
+	{
+		std::nth_element(this->original.begin() + start, this->original.begin() + split, this->original.begin() + end,
+			[coordinate](int a, int b) { return coordinate[a] < coordinate[b]; });
+	}
+
+	this->BuildNode(2 * node + 1, firstLeaf, half);
+	this->BuildNode(2 * node + 2, firstLeaf + half, half);
+}
+
+void PointKDTree::Query(const OBBCollider &collider, std::vector<int> &results) const
+{
+	if (this->Size() == 0)
+		return;
+
+	int firstLeafNode = this->numLeaves - 1;
+	std::vector<unsigned char> inside;
+
+	//Each entry is a node and the level it is on
+	int stack[64][2];
+	int top = 0;
+	stack[top][0] = 0;
+	stack[top][1] = 0;
+	top++;
+
+	while (top > 0)
+	{
+		top--;
+		int node = stack[top][0];
+		int level = stack[top][1];
+		const AABB &box = this->bounds[node];
+
+		//Empty leaves have inverted bounds and are skipped here too
+		if (box.min.x > box.max.x || !Overlaps(collider, box))
+			continue;
+
+		//Which leaves this node covers
+		int levelsBelow = this->numLevels - 1 - level;
+		int firstLeaf = ((node + 1) << levelsBelow) - 1 - firstLeafNode;
+		int start = this->LeafStart(firstLeaf);
+		int end = this->LeafStart(firstLeaf + (1 << levelsBelow));
+
+		//If every corner is inside, so is everything in between
+		bool allInside = true;
+		for (int corner = 0; corner < 8 && allInside; corner++)
+		{
+			glm::vec3 p((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y, (corner & 4) ? box.max.z : box.min.z);
+			allInside = TestCollision(collider, p);
+		}
+		if (allInside)
+		{
+			this->AddRange(start, end, results);
+			continue;
+		}
+
+		if (levelsBelow == 0)
+		{
+			//A leaf the box only partly covers: test its bucket
+			inside.resize(end - start);
+			TestCollisions(collider, &this->x[start], &this->y[start], &this->z[start], end - start, inside.data());
+			for (int i = start; i < end; i++)
+			{
+				if (inside[i - start])
+					results.push_back(this->original[i]);
+			}
+			continue;
+		}
+
+		stack[top][0] = 2 * node + 2;
+		stack[top][1] = level + 1;
+		top++;
+		stack[top][0] = 2 * node + 1;
+		stack[top][1] = level + 1;
+		top++;
+	}
+}
+
+///
+//Adds every point in a range of reordered points to the results
+void PointKDTree::AddRange(int start, int end, std::vector<int> &results) const
+{
+	results.insert(results.end(), this->original.begin() + start, this->original.begin() + end);
+}
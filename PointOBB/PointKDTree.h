@@ -0,0 +1,86 @@
+/*
+Title: Point - OBB
+File Name: PointKDTree.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A kd-tree over a fixed cloud of points, for finding every point inside one box.
+This is TestCollision turned around: instead of asking which box a point is in,
+it asks which points a box holds.
+
+The tree is complete and balanced, so it needs no child pointers: the children of
+node i are nodes 2i + 1 and 2i + 2, and the leaves are the last level. Each leaf
+is a bucket of roughly the same number of points. Building the tree reorders the
+points so that every bucket's points sit next to each other in separate x, y, and
+z arrays, which is exactly the form TestCollisions takes.
+
+A query walks down from the root, skipping any node whose AABB does not overlap the
+box. A node whose AABB lies entirely inside the box has all of its points added
+without testing them, and any leaf the box only partly covers has its bucket run
+through TestCollisions.
+*/
+
+#ifndef _POINT_KD_TREE_H
+#define _POINT_KD_TREE_H
+
+#include <vector>
+#include "CollisionScene.h"
+
+class PointKDTree
+{
+public:
+	PointKDTree(void);
+
+	///
+	//Builds the tree over a cloud of points
+	//
+	//Parameters:
+	//	x, y, z: The worldspace coordinates of the points
+	//	count: The number of points
+	//	bucketSize: About how many points to put in each leaf
+	void Build(const float* x, const float* y, const float* z, int count, int bucketSize);
+
+	///
+	//Finds every point inside a box
+	//
+	//Parameters:
+	//	collider: The prepared OBB, whose axes must be unit length and perpendicular
+	//	results: The indices of the points inside, as they were passed to Build,
+	//		are added to the end of this
+	void Query(const OBBCollider &collider, std::vector<int> &results) const;
+
+	///
+	//Gets the number of points in the tree
+	int Size(void) const;
+
+private:
+	int LeafStart(int leaf) const;
+	void BuildNode(int node, int firstLeaf, int numLeaves);
+	void AddRange(int start, int end, std::vector<int> &results) const;
+
+	int numLevels;		//Including the leaves
+	int numLeaves;		//Always a power of two
+	HugeVector<AABB> bounds;	//The AABB of each node's points, in implicit order
+	HugeVector<float> x, y, z;	//The points, reordered bucket by bucket
+	HugeVector<int> original;	//Where each reordered point was passed to Build
+};
+
+#endif _POINT_KD_TREE_H
@@ -0,0 +1,42 @@
+/*
+Title: Point - OBB
+File Name: Prefetch.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+The prefetch distance setting. See Prefetch.h.
+*/
+
+#include "Prefetch.h"
+#include <atomic>
+
+//8 lines (128 floats of each stream) suits most current desktop and server CPUs
+static std::atomic<int> prefetchDistance(8);
+
+int PrefetchDistance(void)
+{
+	return prefetchDistance.load(std::memory_order_relaxed);
+}
+
+void SetPrefetchDistance(int lines)
+{
+	prefetchDistance.store(lines > 0 ? lines : 0, std::memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+/*
+Title: Point - OBB
+File Name: Prefetch.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Software prefetching for the loops which walk through memory faster than it can
+be loaded. A prefetch asks for a cache line ahead of when it is needed, so the
+load is already on its way by the time the loop gets there.
+
+How far ahead to ask depends on the machine: too near and the data is still not
+there in time, too far and it has been pushed out of the cache again before it is
+used. The distance is therefore a setting, counted in cache lines of each stream,
+which the streaming kernels read when they start. Tree traversals cannot see
+further than the node they are on, so they prefetch one step ahead (the colliders
+of a leaf, and the node which will be popped next) whatever the distance. A
+distance of 0 turns all of it off, traversals included, to measure against.
+*/
+
+#ifndef _PREFETCH_H
+#define _PREFETCH_H
+
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+//The size of a cache line in bytes
+#define CACHE_LINE_SIZE 64
+
+///
+//Asks for the cache line holding an address to be loaded into every level of cache
+inline void Prefetch(const void* address)
+{
+#if defined(_M_X64) || defined(_M_IX86_FP) || defined(__SSE2__)
+	_mm_prefetch((const char*)address, _MM_HINT_T0);
+#elif defined(__GNUC__)
+	__builtin_prefetch(address);
+#else
+	(void)address;
+#endif
+}
+
+///
+//Gets how many cache lines ahead the streaming kernels prefetch, 0 for not at all
+int PrefetchDistance(void);
+
+///
+//Sets how many cache lines ahead the streaming kernels prefetch, 0 for not at all
+void SetPrefetchDistance(int lines);
+
+#endif _PREFETCH_H
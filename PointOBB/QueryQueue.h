@@ -0,0 +1,167 @@
+/*
+Title: Point - OBB
+File Name: QueryQueue.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A bounded, lock-free queue which any number of threads may push to and pop from
+at the same time. It is a ring of cells, each with a sequence number saying which
+lap of the ring the cell is ready for. A thread claims a slot by advancing the
+enqueue (or dequeue) position with a compare-and-swap, then publishes the cell by
+bumping its sequence number. Nothing ever blocks: when the ring is full TryPush
+fails, and it is up to the caller to decide whether to wait or give up. That
+failure is the back-pressure the collision workers hand on to their clients.
+
+References:
+Bounded MPMC queue by Dmitry Vyukov
+*/
+
+#ifndef _QUERY_QUEUE_H
+#define _QUERY_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T>
+class QueryQueue
+{
+public:
+	///
+	//Creates a queue holding up to capacity items.
+	//The capacity is rounded up to a power of two.
+	QueryQueue(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+
+		this->mask = size - 1;
+		this->cells = new Cell[size];
+		for (size_t i = 0; i < size; i++)
+			this->cells[i].sequence.store(i, std::memory_order_relaxed);
+
+		this->enqueuePos.store(0, std::memory_order_relaxed);
+		this->dequeuePos.store(0, std::memory_order_relaxed);
+	}
+
+	~QueryQueue(void)
+	{
+		delete[] this->cells;
+	}
+
+	///
+	//Attempts to add an item to the back of the queue
+	//
+	//Returns:
+	//	false if the queue is full, else true
+	bool TryPush(const T &item)
+	{
+		Cell* cell;
+		size_t pos = this->enqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			cell = &this->cells[pos & this->mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)pos;
+			if (diff == 0)
+			{
+				//The cell is free on this lap, try to claim it
+				if (this->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				//The cell still holds an item from the last lap
+				return false;
+			}
+			else
+			{
+				//Another producer got here first
+				pos = this->enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->data = item;
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	///
+	//Attempts to take an item from the front of the queue
+	//
+	//Returns:
+	//	false if the queue is empty, else true
+	bool TryPop(T &item)
+	{
+		Cell* cell;
+		size_t pos = this->dequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			cell = &this->cells[pos & this->mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)(pos + 1);
+			if (diff == 0)
+			{
+				if (this->dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				//Nothing has been published here yet
+				return false;
+			}
+			else
+			{
+				pos = this->dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		item = cell->data;
+		cell->sequence.store(pos + this->mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	///
+	//Gets the maximum number of items the queue can hold
+	size_t Capacity(void) const
+	{
+		return this->mask + 1;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	//Keep the producer and consumer positions on separate cache lines
+	//so that producers do not slow down consumers and vice versa
+	alignas(64) Cell* cells;
+	size_t mask;
+	alignas(64) std::atomic<size_t> enqueuePos;
+	alignas(64) std::atomic<size_t> dequeuePos;
+
+	QueryQueue(const QueryQueue &);
+	QueryQueue &operator=(const QueryQueue &);
+};
+
+#endif _QUERY_QUEUE_H
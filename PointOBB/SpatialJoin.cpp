@@ -0,0 +1,507 @@
+/*
+Title: Point - OBB
+File Name: SpatialJoin.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finds every (point, box) pair where the point is inside the box. See SpatialJoin.h.
+*/
+
+#include "SpatialJoin.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include "Morton.h"
+#include "Parallel.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+//The points are split into 2^RANGE_BITS key ranges for the threads
+static const int RANGE_BITS = 6;
+
+//How many records a run reader holds at once
+static const int RUN_BUFFER = 4096;
+
+//How many pairs are collected before being handed to the writer
+static const int WRITE_BLOCK = 4096;
+
+//How many points of one cell are gathered from the runs before they are tested
+static const int CELL_BLOCK = 4096;
+
+//The most runs merged at once. Each holds an open file and a buffer of RUN_BUFFER
+//records while it is merged, so this bounds the files and memory a merge uses.
+static const size_t MAX_FAN_IN = 64;
+
+//The most cells a box is listed in; bigger boxes go on the list every point is tested against
+static const uint64_t MAX_BOX_CELLS = 64;
+
+//Numbers each JoinStream call, so calls running at once name their runs apart
+static std::atomic<unsigned int> nextStreamId(0);
+
+///
+//Gets the ID of this process, which no other running process shares
+static long long CurrentProcessId(void)
+{
+#ifdef _WIN32
+	return (long long)_getpid();
+#else
+	return (long long)getpid();
+#endif
+}
+
+///
+//Merges sorted run files into one stream of records, smallest code first.
+//Records with the same code come out in the order of their runs, so the merge is stable.
+template <typename Record>
+class RunMerger
+{
+public:
+	///
+	//Opens runs first to last - 1 of a list and reads the start of each
+	RunMerger(const std::vector<std::string> &paths, size_t first, size_t last)
+	{
+		this->failed = false;
+		this->runs.resize(last - first);
+		for (size_t r = 0; r < this->runs.size(); r++)
+		{
+			Run &run = this->runs[r];
+			run.file = fopen(paths[first + r].c_str(), "rb");
+			run.buffer.resize(RUN_BUFFER);
+			run.next = 0;
+			run.size = 0;
+			if (run.file == nullptr)
+			{
+				this->failed = true;
+				continue;
+			}
+
+			this->Refill(run);
+			if (run.size > 0)
+				this->heads.push_back(Head(run.buffer[0].code, r));
+		}
+		std::make_heap(this->heads.begin(), this->heads.end(), std::greater<Head>());
+	}
+
+	~RunMerger(void)
+	{
+		for (size_t r = 0; r < this->runs.size(); r++)
+		{
+			if (this->runs[r].file != nullptr)
+				fclose(this->runs[r].file);
+		}
+	}
+
+	///
+	//Takes the next record
+	//
+	//Returns:
+	//	false once every run is used up, or a run could not be read
+	bool Next(Record &record)
+	{
+		if (this->failed || this->heads.empty())
+			return false;
+
+		std::pop_heap(this->heads.begin(), this->heads.end(), std::greater<Head>());
+		size_t r = this->heads.back().second;
+		this->heads.pop_back();
+
+		Run &run = this->runs[r];
+		record = run.buffer[run.next++];
+		if (run.next == run.size)
+			this->Refill(run);
+		if (run.next < run.size)
+		{
+			this->heads.push_back(Head(run.buffer[run.next].code, r));
+			std::push_heap(this->heads.begin(), this->heads.end(), std::greater<Head>());
+		}
+		return true;
+	}
+
+	///
+	//Gets whether a run could not be opened or read
+	bool Failed(void) const
+	{
+		return this->failed;
+	}
+
+private:
+	struct Run
+	{
+		FILE* file;
+		std::vector<Record> buffer;
+		size_t next;
+		size_t size;
+	};
+
+	//(code, run) for the next record of each run, smallest on top
+	typedef std::pair<uint32_t, size_t> Head;
+
+	///
+	//Reads the next buffer of a run. A short read is only the end of
+	//the run if the file has not had an error.
+	void Refill(Run &run)
+	{
+		run.size = fread(run.buffer.data(), sizeof(Record), RUN_BUFFER, run.file);
+		run.next = 0;
+		if (run.size < (size_t)RUN_BUFFER && ferror(run.file))
+			this->failed = true;
+	}
+
+	std::vector<Run> runs;
+	std::vector<Head> heads;
+	bool failed;
+
+	RunMerger(const RunMerger &);
+	RunMerger &operator=(const RunMerger &);
+};
+
+///
+//Merges runs first to last - 1 of a list into one new run
+//
+//Returns:
+//	false if a run could not be read or the new one could not be written
+template <typename Record>
+static bool MergeRuns(const std::vector<std::string> &paths, size_t first, size_t last, const std::string &path)
+{
+	RunMerger<Record> merger(paths, first, last);
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	std::vector<Record> block;
+	block.reserve(RUN_BUFFER);
+	Record record;
+	bool ok = true;
+	while (ok && merger.Next(record))
+	{
+		block.push_back(record);
+		if (block.size() == (size_t)RUN_BUFFER)
+		{
+			ok = fwrite(block.data(), sizeof(Record), block.size(), file) == block.size();
+			block.clear();
+		}
+	}
+	if (ok && !block.empty())
+		ok = fwrite(block.data(), sizeof(Record), block.size(), file) == block.size();
+	ok = fclose(file) == 0 && ok;
+	return ok && !merger.Failed();
+}
+
+SpatialJoin::SpatialJoin(const CollisionScene &scene, int cellBits)
+	: scene(scene)
+{
+	int numColliders = scene.Size();
+
+	//Spread the grid over the boxes. Points outside this cannot be in any box.
+	this->world.min = glm::vec3(0.0f);
+	this->world.max = glm::vec3(0.0f);
+	glm::vec3 averageSize(0.0f);
+	for (int i = 0; i < numColliders; i++)
+	{
+		const AABB &b = scene.bounds[i];
+		this->world.min = i == 0 ? b.min : glm::min(this->world.min, b.min);
+		this->world.max = i == 0 ? b.max : glm::max(this->world.max, b.max);
+		averageSize += (b.max - b.min) / (float)numColliders;
+	}
+
+	glm::vec3 size = glm::max(this->world.max - this->world.min, glm::vec3(1e-6f));
+	this->invSize = 1.0f / size;
+
+	//Pick cells about as big as the average box
+	if (cellBits <= 0)
+	{
+		float boxSize = std::max(std::max(averageSize.x, averageSize.y), std::max(averageSize.z, 1e-6f));
+		float worldSize = std::max(std::max(size.x, size.y), size.z);
+		cellBits = (int)std::floor(std::log2(std::max(1.0f, worldSize / boxSize)));
+	}
+	this->cellBits = std::min(std::max(cellBits, 0), MORTON_BITS);
+
+	//List each box in every cell its AABB touches, unless that is too many
+	for (int i = 0; i < numColliders; i++)
+	{
+		const AABB &b = scene.bounds[i];
+		glm::uvec3 low = MortonCell(b.min, this->world.min, this->invSize, this->cellBits);
+		glm::uvec3 high = MortonCell(b.max, this->world.min, this->invSize, this->cellBits);
+
+		uint64_t numCells = (uint64_t)(high.x - low.x + 1) * (high.y - low.y + 1) * (high.z - low.z + 1);
+		if (numCells > MAX_BOX_CELLS)
+		{
+			this->hugeBoxes.push_back(i);
+			continue;
+		}
+
+		for (uint32_t cx = low.x; cx <= high.x; cx++)
+			for (uint32_t cy = low.y; cy <= high.y; cy++)
+				for (uint32_t cz = low.z; cz <= high.z; cz++)
+					this->boxCells.push_back(((uint64_t)MortonCode(cx, cy, cz) << 32) | (uint32_t)i);
+	}
+	std::sort(this->boxCells.begin(), this->boxCells.end());
+}
+
+int SpatialJoin::CellsPerAxis(void) const
+{
+	return 1 << this->cellBits;
+}
+
+///
+//Gets the cell code of a point
+//
+//Returns:
+//	false if the point is outside every box's AABB, so needs no cell
+bool SpatialJoin::CellOf(float x, float y, float z, uint32_t &code) const
+{
+	glm::vec3 p(x, y, z);
+	if (!Contains(this->world, p))
+		return false;
+
+	glm::uvec3 cell = MortonCell(p, this->world.min, this->invSize, this->cellBits);
+	code = MortonCode(cell.x, cell.y, cell.z);
+	return true;
+}
+
+///
+//Walks a run of points sorted by cell code alongside the sorted box list
+void SpatialJoin::MergeRange(const PointRecord* points, size_t numPoints, std::vector<JoinPair> &results) const
+{
+	if (numPoints == 0)
+		return;
+
+	//A box too big to be listed by cell could hold any of the points
+	for (size_t h = 0; h < this->hugeBoxes.size(); h++)
+	{
+		int collider = this->hugeBoxes[h];
+		for (size_t p = 0; p < numPoints; p++)
+		{
+			glm::vec3 point(points[p].x, points[p].y, points[p].z);
+			if (Contains(this->scene.bounds[collider], point) && TestCollision(this->scene.colliders[collider], point))
+			{
+				JoinPair pair = { points[p].index, collider };
+				results.push_back(pair);
+			}
+		}
+	}
+
+	std::vector<uint64_t>::const_iterator box = std::lower_bound(this->boxCells.begin(), this->boxCells.end(), (uint64_t)points[0].code << 32);
+
+	size_t p = 0;
+	while (p < numPoints && box != this->boxCells.end())
+	{
+		uint32_t pointCode = points[p].code;
+		uint32_t boxCode = (uint32_t)(*box >> 32);
+
+		if (pointCode < boxCode)
+		{
+			p++;
+			continue;
+		}
+		if (boxCode < pointCode)
+		{
+			box++;
+			continue;
+		}
+
+		//The boxes in this cell
+		std::vector<uint64_t>::const_iterator boxEnd = box;
+		while (boxEnd != this->boxCells.end() && (uint32_t)(*boxEnd >> 32) == pointCode)
+			boxEnd++;
+
+		//Test each point in this cell against each of them
+		for (; p < numPoints && points[p].code == pointCode; p++)
+		{
+			glm::vec3 point(points[p].x, points[p].y, points[p].z);
+			for (std::vector<uint64_t>::const_iterator b = box; b != boxEnd; b++)
+			{
+				int collider = (int)(uint32_t)*b;
+				if (Contains(this->scene.bounds[collider], point) && TestCollision(this->scene.colliders[collider], point))
+				{
+					JoinPair pair = { points[p].index, collider };
+					results.push_back(pair);
+				}
+			}
+		}
+
+		box = boxEnd;
+	}
+}
+
+void SpatialJoin::Join(const float* x, const float* y, const float* z, int count, std::vector<JoinPair> &results, int numThreads) const
+{
+	//Label every point with its cell and count how many land in each key range
+	int numRanges = 1 << RANGE_BITS;
+	int rangeShift = 3 * this->cellBits > RANGE_BITS ? 3 * this->cellBits - RANGE_BITS : 0;
+
+	std::vector<PointRecord> records;
+	records.reserve(count);
+	std::vector<size_t> rangeStart(numRanges + 1, 0);
+	for (int i = 0; i < count; i++)
+	{
+		PointRecord record;
+		if (!this->CellOf(x[i], y[i], z[i], record.code))
+			continue;
+		record.x = x[i];
+		record.y = y[i];
+		record.z = z[i];
+		record.index = i;
+		records.push_back(record);
+		rangeStart[(record.code >> rangeShift) + 1]++;
+	}
+
+	//Scatter the points into their key ranges
+	for (int r = 0; r < numRanges; r++)
+		rangeStart[r + 1] += rangeStart[r];
+	std::vector<PointRecord> ranged(records.size());
+	std::vector<size_t> fill(rangeStart.begin(), rangeStart.end() - 1);
+	for (size_t i = 0; i < records.size(); i++)
+		ranged[fill[records[i].code >> rangeShift]++] = records[i];
+	records.clear();
+
+	//Sort and merge each key range on its own
+	std::vector<std::vector<JoinPair> > rangeResults(numRanges);
+	ParallelFor(numRanges, 1, numThreads, [&](int begin, int end)
+	{
+		for (int r = begin; r < end; r++)
+		{
+			PointRecord* first = ranged.data() + rangeStart[r];
+			PointRecord* last = ranged.data() + rangeStart[r + 1];
+			std::sort(first, last, [](const PointRecord &a, const PointRecord &b) { return a.code < b.code; });
+			this->MergeRange(first, last - first, rangeResults[r]);
+		}
+	});
+
+	for (int r = 0; r < numRanges; r++)
+		results.insert(results.end(), rangeResults[r].begin(), rangeResults[r].end());
+}
+
+bool SpatialJoin::JoinStream(JoinPointReader reader, void* readerData, int chunkSize, const char* spillDirectory, JoinPairWriter writer, void* writerData) const
+{
+	if (chunkSize <= 0)
+		return false;
+
+	std::vector<float> x(chunkSize), y(chunkSize), z(chunkSize);
+	std::vector<PointRecord> chunk;
+	chunk.reserve(chunkSize);
+	std::vector<std::string> runs;
+	std::vector<JoinPair> results;
+	long long nextIndex = 0;
+	bool ok = true;
+
+	std::string runPrefix = std::string(spillDirectory) + "/pointobb_" + std::to_string(CurrentProcessId()) +
+		"_" + std::to_string(nextStreamId.fetch_add(1)) + "_run_";
+
+	//Read, label, sort, and spill one chunk at a time
+	for (;;)
+	{
+		int read = reader(x.data(), y.data(), z.data(), chunkSize, readerData);
+		if (read <= 0)
+			break;
+		read = std::min(read, chunkSize);
+
+		chunk.clear();
+		for (int i = 0; i < read; i++, nextIndex++)
+		{
+			PointRecord record;
+			if (!this->CellOf(x[i], y[i], z[i], record.code))
+				continue;
+			record.x = x[i];
+			record.y = y[i];
+			record.z = z[i];
+			record.index = nextIndex;
+			chunk.push_back(record);
+		}
+		std::stable_sort(chunk.begin(), chunk.end(), [](const PointRecord &a, const PointRecord &b) { return a.code < b.code; });
+
+		std::string path = runPrefix + "0_" + std::to_string(runs.size()) + ".tmp";
+		FILE* file = fopen(path.c_str(), "wb");
+		if (file == nullptr)
+		{
+			ok = false;
+			break;
+		}
+		runs.push_back(path);
+		size_t written = chunk.empty() ? 0 : fwrite(chunk.data(), sizeof(PointRecord), chunk.size(), file);
+		if (fclose(file) != 0 || written != chunk.size())
+		{
+			ok = false;
+			break;
+		}
+	}
+
+	//Merge groups of runs into longer ones until few enough are left to merge at once
+	for (int pass = 1; ok && runs.size() > MAX_FAN_IN; pass++)
+	{
+		std::vector<std::string> merged;
+		for (size_t first = 0; ok && first < runs.size(); first += MAX_FAN_IN)
+		{
+			std::string path = runPrefix + std::to_string(pass) + "_" + std::to_string(merged.size()) + ".tmp";
+			merged.push_back(path);
+			ok = MergeRuns<PointRecord>(runs, first, std::min(first + MAX_FAN_IN, runs.size()), path);
+		}
+
+		for (size_t r = 0; r < runs.size(); r++)
+			remove(runs[r].c_str());
+		runs.swap(merged);
+	}
+
+	//Merge the last runs back together, smallest code first. The merger is
+	//scoped so the runs are closed before they are removed.
+	{
+		RunMerger<PointRecord> merger(runs, 0, ok ? runs.size() : 0);
+		ok = ok && !merger.Failed();
+
+		//Gather each cell's points across all runs and merge them against the cell's
+		//boxes, a block at a time
+		std::vector<PointRecord> cell;
+		cell.reserve(CELL_BLOCK);
+		PointRecord record;
+		while (ok && merger.Next(record))
+		{
+			if (!cell.empty() && (cell.back().code != record.code || (int)cell.size() >= CELL_BLOCK))
+			{
+				this->MergeRange(cell.data(), cell.size(), results);
+				cell.clear();
+			}
+			cell.push_back(record);
+
+			if ((int)results.size() >= WRITE_BLOCK)
+			{
+				writer(results.data(), (int)results.size(), writerData);
+				results.clear();
+			}
+		}
+		ok = ok && !merger.Failed();
+		if (ok)
+			this->MergeRange(cell.data(), cell.size(), results);
+		if (!results.empty())
+			writer(results.data(), (int)results.size(), writerData);
+	}
+
+	for (size_t r = 0; r < runs.size(); r++)
+		remove(runs[r].c_str());
+
+	return ok;
+}
@@ -0,0 +1,136 @@
+/*
+Title: Point - OBB
+File Name: SpatialJoin.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finds every (point, box) pair where the point is inside the box, for very large
+sets of points and boxes, by sorting rather than by building a tree.
+
+The space around the scene is cut into a grid of cells. Every box is listed once
+for each cell its worldspace AABB touches, and every point is labelled with the
+one cell it falls in. Both lists are sorted by the Morton code of the cell, and
+then walked side by side like the two halves of a merge sort. Only a point and
+a box which share a cell are ever put through the point - OBB test. A box which
+would have to be listed in too many cells is kept on a short list of its own
+instead, and every point is tested against the boxes on it.
+
+Join runs in memory. The points are split by the top bits of their cell codes
+into key ranges which are sorted and merged on separate threads.
+
+JoinStream handles more points than fit in memory. It reads the points a chunk
+at a time, sorts each chunk and writes it to a run file on disk, then merges the
+runs back together in a streaming pass against the box list, which is assumed to
+fit in memory. Only so many runs are merged at once; when there are more, groups
+of them are first merged into longer runs, as often as it takes, so the number of
+open files and read buffers stays bounded however many points there are. Points
+in the same cell are tested in blocks as they come off the runs, so even a cell
+holding most of the points is never held in memory all at once. Run files are
+named after the process and the call, so any number of joins may share a spill
+directory.
+*/
+
+#ifndef _SPATIAL_JOIN_H
+#define _SPATIAL_JOIN_H
+
+#include <cstdint>
+#include <vector>
+#include "CollisionScene.h"
+
+//A point inside a box
+struct JoinPair
+{
+	long long point;	//The index of the point
+	int box;			//The index of the collider in the scene
+};
+
+//Reads up to maxCount more points, returning how many were read (0 at the end)
+typedef int (*JoinPointReader)(float* x, float* y, float* z, int maxCount, void* userData);
+
+//Receives a block of results
+typedef void (*JoinPairWriter)(const JoinPair* pairs, int count, void* userData);
+
+class SpatialJoin
+{
+public:
+	///
+	//Lists the boxes of a scene by grid cell
+	//
+	//Parameters:
+	//	scene: The boxes to join against, which must outlive the join
+	//	cellBits: The grid has 2^cellBits cells along each axis (at most 10),
+	//		or 0 to choose so that cells are about as big as the average box
+	SpatialJoin(const CollisionScene &scene, int cellBits);
+
+	///
+	//Finds every point inside every box, in memory
+	//
+	//Parameters:
+	//	x, y, z: The worldspace coordinates of the points
+	//	count: The number of points
+	//	results: The pairs found are added to the end of this
+	//	numThreads: The number of threads to use, or 0 for one per hardware thread
+	void Join(const float* x, const float* y, const float* z, int count, std::vector<JoinPair> &results, int numThreads) const;
+
+	///
+	//Finds every point inside every box, for points which may not fit in memory
+	//
+	//Parameters:
+	//	reader: Called to get the points, a chunk at a time
+	//	readerData: Passed to reader
+	//	chunkSize: The most points to hold in memory at once
+	//	spillDirectory: Where to write the sorted runs
+	//	writer: Called with the pairs found, in blocks
+	//	writerData: Passed to writer
+	//
+	//Returns:
+	//	false if chunkSize is not positive or a run file could not be written or
+	//	read back, else true
+	bool JoinStream(JoinPointReader reader, void* readerData, int chunkSize, const char* spillDirectory, JoinPairWriter writer, void* writerData) const;
+
+	///
+	//Gets the number of cells along each axis of the grid
+	int CellsPerAxis(void) const;
+
+private:
+	//A point labelled with its cell, as it is sorted and spilled
+	struct PointRecord
+	{
+		uint32_t code;
+		float x, y, z;
+		long long index;
+	};
+
+	bool CellOf(float x, float y, float z, uint32_t &code) const;
+	void MergeRange(const PointRecord* points, size_t numPoints, std::vector<JoinPair> &results) const;
+
+	const CollisionScene &scene;
+	int cellBits;
+	AABB world;			//The grid is spread over this
+	glm::vec3 invSize;
+
+	//(code << 32 | box) for every cell each box touches, sorted
+	std::vector<uint64_t> boxCells;
+	//The boxes which touch too many cells to be listed in boxCells
+	std::vector<int> hugeBoxes;
+};
+
+#endif _SPATIAL_JOIN_H
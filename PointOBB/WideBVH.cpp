@@ -0,0 +1,383 @@
+/*
+Title: Point - OBB
+File Name: WideBVH.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A compact, 8-wide BVH with quantized child bounds. See WideBVH.h.
+*/
+
+//The quantized bounds must be worked out the same way when they are built and when
+//they are tested, or a child could be rounded in instead of out
+#include "NoContract.h"
+#include "WideBVH.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "CpuFeatures.h"
+#include "Prefetch.h"
+
+//The AVX2 child test is built on any x86 compiler, and only used if the CPU has AVX2
+#ifdef CPU_X86
+#include <immintrin.h>
+#define WIDE_BVH_AVX2
+#endif
+
+static_assert(sizeof(WideBVHNode) == 2 * CACHE_LINE_SIZE, "a WideBVHNode should fill exactly two cache lines");
+
+//The deepest a tree built by Build can be, which bounds the traversal stack
+static const int MAX_DEPTH = 64;
+
+//The number of steps across a node's box
+static const int STEPS = 255;
+
+///
+//Gets the surface area of an AABB, the usual guess at how often it will be hit
+static float SurfaceArea(const AABB &box)
+{
+	glm::vec3 size = box.max - box.min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+///
+//Gets the position of a quantized step
+static float Dequantize(float origin, float step, int q)
+{
+	return origin + (float)q * step;
+}
+
+///
+//Finds which of a node's 8 children a point is in, one child at a time
+static int ChildMask(const WideBVHNode &node, glm::vec3 point)
+{
+	int mask = 0;
+	for (int s = 0; s < WIDE_BVH_WIDTH; s++)
+	{
+		bool inside =
+			Dequantize(node.origin[0], node.step[0], node.minX[s]) <= point.x && point.x <= Dequantize(node.origin[0], node.step[0], node.maxX[s]) &&
+			Dequantize(node.origin[1], node.step[1], node.minY[s]) <= point.y && point.y <= Dequantize(node.origin[1], node.step[1], node.maxY[s]) &&
+			Dequantize(node.origin[2], node.step[2], node.minZ[s]) <= point.z && point.z <= Dequantize(node.origin[2], node.step[2], node.maxZ[s]);
+		mask |= inside ? 1 << s : 0;
+	}
+	return mask;
+}
+
+#ifdef WIDE_BVH_AVX2
+///
+//Finds which of a node's 8 children a point is in, all 8 at once.
+//Only call this if CpuHasAVX2 says so.
+TARGET_AVX2 static int ChildMaskAVX2(const WideBVHNode &node, glm::vec3 point)
+{
+	__m256 p[3] = { _mm256_set1_ps(point.x), _mm256_set1_ps(point.y), _mm256_set1_ps(point.z) };
+	const uint8_t* minimums[3] = { node.minX, node.minY, node.minZ };
+	const uint8_t* maximums[3] = { node.maxX, node.maxY, node.maxZ };
+	__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	for (int axis = 0; axis < 3; axis++)
+	{
+		__m256 origin = _mm256_set1_ps(node.origin[axis]);
+		__m256 step = _mm256_set1_ps(node.step[axis]);
+		__m256 low = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)minimums[axis])));
+		__m256 high = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)maximums[axis])));
+		low = _mm256_add_ps(origin, _mm256_mul_ps(low, step));
+		high = _mm256_add_ps(origin, _mm256_mul_ps(high, step));
+		inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(low, p[axis], _CMP_LE_OQ), _mm256_cmp_ps(p[axis], high, _CMP_LE_OQ)));
+	}
+	return _mm256_movemask_ps(inside);
+}
+
+#endif
+
+WideBVH::WideBVH(void)
+{
+	this->scene = nullptr;
+	this->nodeData = nullptr;
+	this->numNodes = 0;
+}
+
+WideBVH::WideBVH(const WideBVH &other)
+	: nodes(other.nodes)
+{
+	this->scene = other.scene;
+	this->nodeData = other.nodeData == other.nodes.data() ? this->nodes.data() : other.nodeData;
+	this->numNodes = other.numNodes;
+}
+
+WideBVH &WideBVH::operator=(const WideBVH &other)
+{
+	if (this != &other)
+	{
+		this->scene = other.scene;
+		this->nodes = other.nodes;
+		this->nodeData = other.nodeData == other.nodes.data() ? this->nodes.data() : other.nodeData;
+		this->numNodes = other.numNodes;
+	}
+	return *this;
+}
+
+void WideBVH::Build(const CollisionScene &scene)
+{
+	this->scene = &scene;
+	this->nodes.clear();
+	if (scene.Size() > 0)
+	{
+		ColliderBVH binary;
+		binary.Build(scene, 1);
+		this->nodes.reserve(binary.NumNodes() / 4 + 1);
+		this->BuildNode(binary, 0);
+	}
+	this->nodeData = this->nodes.data();
+	this->numNodes = (int)this->nodes.size();
+}
+
+///
+//Checks that nodes from outside make a tree the queries can walk safely: every
+//node is reached once from the root, no deeper than the traversal stack allows,
+//and every collider a node names is in the scene
+static bool IsValidTree(const CollisionScene &scene, const WideBVHNode* nodes, int numNodes)
+{
+	if (numNodes < 0)
+		return false;
+	if (numNodes == 0)
+		return true;
+
+	std::vector<bool> reached(numNodes, false);
+	std::vector<std::pair<int, int> > stack;
+	stack.push_back(std::pair<int, int>(0, 0));
+	reached[0] = true;
+	while (!stack.empty())
+	{
+		std::pair<int, int> entry = stack.back();
+		stack.pop_back();
+		if (entry.second >= MAX_DEPTH)
+			return false;
+
+		const WideBVHNode &node = nodes[entry.first];
+		if (node.count < 0 || node.count > WIDE_BVH_WIDTH)
+			return false;
+
+		for (int s = 0; s < node.count; s++)
+		{
+			int32_t child = node.child[s];
+			if (child < 0)
+			{
+				if (~child >= scene.Size())
+					return false;
+				continue;
+			}
+			if (child >= numNodes || reached[child])
+				return false;
+			reached[child] = true;
+			stack.push_back(std::pair<int, int>(child, entry.second + 1));
+		}
+	}
+	return true;
+}
+
+bool WideBVH::Attach(const CollisionScene &scene, const WideBVHNode* nodes, int numNodes)
+{
+	this->scene = &scene;
+	this->nodes.clear();
+	if (!IsValidTree(scene, nodes, numNodes))
+	{
+		this->nodeData = nullptr;
+		this->numNodes = 0;
+		return false;
+	}
+
+	this->nodeData = nodes;
+	this->numNodes = numNodes;
+	return true;
+}
+
+///
+//Makes a wide node out of a binary node and the nodes under it
+//
+//Returns:
+//	The index of the wide node
+int WideBVH::BuildNode(const ColliderBVH &binary, int binaryNode)
+{
+	const BVHNode* binaryNodes = binary.Nodes();
+
+	//Open up the biggest inner node until there are enough children
+	std::vector<int> slots;
+	if (binaryNodes[binaryNode].count > 0)
+		slots.push_back(binaryNode);
+	else
+	{
+		slots.push_back(binaryNodes[binaryNode].start);
+		slots.push_back(binaryNodes[binaryNode].start + 1);
+	}
+	while ((int)slots.size() < WIDE_BVH_WIDTH)
+	{
+		int biggest = -1;
+		for (int s = 0; s < (int)slots.size(); s++)
+		{
+			if (binaryNodes[slots[s]].count == 0 && (biggest < 0 || SurfaceArea(binaryNodes[slots[s]].bounds) > SurfaceArea(binaryNodes[slots[biggest]].bounds)))
+				biggest = s;
+		}
+		if (biggest < 0)
+			break;
+
+		int start = binaryNodes[slots[biggest]].start;
+		slots[biggest] = start;
+		slots.push_back(start + 1);
+	}
+
+	int node = (int)this->nodes.size();
+	this->nodes.push_back(WideBVHNode());
+
+	//Work out the steps across this node's box
+	const AABB &box = binaryNodes[binaryNode].bounds;
+	float origin[3], step[3], invStep[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		//A little over 1/255 of the box, so the last step reaches past the far side
+		origin[axis] = box.min[axis];
+		step[axis] = (box.max[axis] - box.min[axis]) / (float)STEPS * (1.0f + 4.0f * FLT_EPSILON);
+		invStep[axis] = step[axis] > 0.0f ? 1.0f / step[axis] : 0.0f;
+	}
+
+	//Kept here until the children are built, since building them can move the nodes
+	uint8_t minimums[3][WIDE_BVH_WIDTH], maximums[3][WIDE_BVH_WIDTH];
+	int32_t child[WIDE_BVH_WIDTH];
+
+	for (int s = 0; s < WIDE_BVH_WIDTH; s++)
+	{
+		if (s >= (int)slots.size())
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				minimums[axis][s] = STEPS;
+				maximums[axis][s] = 0;
+			}
+			child[s] = 0;
+			continue;
+		}
+
+		const BVHNode &slot = binaryNodes[slots[s]];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			//Round outwards, then make sure rounding the step back to a position did too
+			int low = (int)std::floor((slot.bounds.min[axis] - origin[axis]) * invStep[axis]);
+			int high = (int)std::ceil((slot.bounds.max[axis] - origin[axis]) * invStep[axis]);
+			low = std::min(std::max(low, 0), STEPS);
+			high = std::min(std::max(high, 0), STEPS);
+			while (low > 0 && Dequantize(origin[axis], step[axis], low) > slot.bounds.min[axis])
+				low--;
+			while (high < STEPS && Dequantize(origin[axis], step[axis], high) < slot.bounds.max[axis])
+				high++;
+
+			minimums[axis][s] = (uint8_t)low;
+			maximums[axis][s] = (uint8_t)high;
+		}
+
+		//Leaves hold one collider, which goes straight into the slot
+		child[s] = slot.count > 0 ? ~binary.Indices()[slot.start] : this->BuildNode(binary, slots[s]);
+	}
+
+	//Building the children may have moved the nodes
+	WideBVHNode &wide = this->nodes[node];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		wide.origin[axis] = origin[axis];
+		wide.step[axis] = step[axis];
+	}
+	uint8_t* wideMinimums[3] = { wide.minX, wide.minY, wide.minZ };
+	uint8_t* wideMaximums[3] = { wide.maxX, wide.maxY, wide.maxZ };
+	for (int s = 0; s < WIDE_BVH_WIDTH; s++)
+	{
+		wide.child[s] = child[s];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			wideMinimums[axis][s] = minimums[axis][s];
+			wideMaximums[axis][s] = maximums[axis][s];
+		}
+	}
+	wide.count = (int32_t)slots.size();
+
+	return node;
+}
+
+int WideBVH::FindContaining(glm::vec3 point) const
+{
+	if (this->numNodes == 0)
+		return -1;
+
+	bool prefetch = PrefetchDistance() > 0;
+#ifdef WIDE_BVH_AVX2
+	bool avx2 = CpuHasAVX2();
+#endif
+	int stack[MAX_DEPTH * WIDE_BVH_WIDTH];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const WideBVHNode &node = this->nodeData[stack[--top]];
+		//A node is two cache lines
+		if (prefetch && top > 0)
+		{
+			Prefetch(&this->nodeData[stack[top - 1]]);
+			Prefetch((const char*)&this->nodeData[stack[top - 1]] + CACHE_LINE_SIZE);
+		}
+
+		//Find which of the 8 children the point is in
+#ifdef WIDE_BVH_AVX2
+		int mask = avx2 ? ChildMaskAVX2(node, point) : ChildMask(node, point);
+#else
+		int mask = ChildMask(node, point);
+#endif
+
+		//Test the colliders now, and come back for the nodes
+		mask &= (1 << node.count) - 1;
+		for (; mask != 0; mask &= mask - 1)
+		{
+			int s = 0;
+			while (((mask >> s) & 1) == 0)
+				s++;
+
+			int32_t child = node.child[s];
+			if (child >= 0)
+				stack[top++] = child;
+			else if (TestCollision(this->scene->colliders[~child], point))
+				return ~child;
+		}
+	}
+
+	return -1;
+}
+
+size_t WideBVH::MemoryBytes(void) const
+{
+	return this->numNodes * sizeof(WideBVHNode);
+}
+
+const WideBVHNode* WideBVH::Nodes(void) const
+{
+	return this->nodeData;
+}
+
+int WideBVH::NumNodes(void) const
+{
+	return this->numNodes;
+}
@@ -0,0 +1,131 @@
+/*
+Title: Point - OBB
+File Name: WideBVH.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A compact, 8-wide bounding volume hierarchy over the boxes of a CollisionScene, for
+scenes so big that a binary tree with float bounds no longer fits in the caches.
+
+Every node holds up to 8 children. A child's AABB is not stored as floats, but as
+8 bit steps across its parent's AABB: the node keeps its own box's corner and the
+size of one step on each axis, and each child's bounds are rounded outwards to the
+nearest step. That takes 6 bytes per child instead of 24, at the cost of children
+looking a little bigger than they are, which only means a few more boxes reach the
+exact test. A child is either another node or, in place of a leaf, one collider,
+whose index is stored right in the slot.
+
+The tree is made by building a ColliderBVH with one collider per leaf and pulling
+its nodes up into the wide nodes: starting from a node's two children, the child
+with the largest surface area is replaced by its own two children until there are
+8. A query tests a point against all 8 children of a node at once, with AVX2 if
+the CPU has it. That is checked when the program runs, so one build works on
+every x86 CPU without needing AVX2 turned on for the whole program.
+
+A node takes 108 bytes, and is padded out to two whole cache lines so that no node
+ever straddles three.
+*/
+
+#ifndef _WIDE_BVH_H
+#define _WIDE_BVH_H
+
+#include <cstdint>
+#include <vector>
+#include "ColliderBVH.h"
+#include "Prefetch.h"
+
+//The number of children of a WideBVH node
+#define WIDE_BVH_WIDTH 8
+
+//A node in a WideBVH
+struct alignas(CACHE_LINE_SIZE) WideBVHNode
+{
+	float origin[3];	//The minimum corner of the node's AABB
+	float step[3];		//The size of one quantized step along each axis
+
+	//The children's bounds in steps from the origin, rounded outwards
+	uint8_t minX[WIDE_BVH_WIDTH], minY[WIDE_BVH_WIDTH], minZ[WIDE_BVH_WIDTH];
+	uint8_t maxX[WIDE_BVH_WIDTH], maxY[WIDE_BVH_WIDTH], maxZ[WIDE_BVH_WIDTH];
+
+	//A node index if 0 or more, else ~(the index of a collider)
+	int32_t child[WIDE_BVH_WIDTH];
+
+	//The number of slots in use, which are always the first ones
+	int32_t count;
+};
+
+class WideBVH
+{
+public:
+	WideBVH(void);
+
+	///
+	//Copies a tree. A copy of an attached tree reads the same attached nodes.
+	WideBVH(const WideBVH &other);
+	WideBVH &operator=(const WideBVH &other);
+
+	///
+	//Builds the tree over every collider in a scene
+	//
+	//Parameters:
+	//	scene: The scene to build over, which must outlive the tree
+	void Build(const CollisionScene &scene);
+
+	///
+	//Finds a collider containing a point
+	//
+	//Returns:
+	//	The index of a collider containing the point, or -1 if there is none
+	int FindContaining(glm::vec3 point) const;
+
+	///
+	//Gets the number of bytes the tree's nodes take up
+	size_t MemoryBytes(void) const;
+
+	///
+	//Uses a tree which was built earlier, such as one mapped from a BVHCache file,
+	//in place of building one. The nodes are not copied, so must outlive the tree.
+	//Every node is checked first, since they may come from a damaged file.
+	//
+	//Parameters:
+	//	scene: The scene the tree was built over, which must outlive the tree
+	//	nodes: The nodes, root first
+	//	numNodes: The number of nodes
+	//
+	//Returns:
+	//	false, leaving the tree empty, if the nodes are not a tree over the scene
+	bool Attach(const CollisionScene &scene, const WideBVHNode* nodes, int numNodes);
+
+	const WideBVHNode* Nodes(void) const;
+	int NumNodes(void) const;
+
+private:
+	int BuildNode(const ColliderBVH &binary, int binaryNode);
+
+	const CollisionScene* scene;
+	HugeVector<WideBVHNode> nodes;
+
+	//The nodes the queries read, which are either the ones above or attached ones
+	const WideBVHNode* nodeData;
+	int numNodes;
+};
+
+#endif _WIDE_BVH_H
@@ -0,0 +1,223 @@
+/*
+Title: Point - OBB
+File Name: AwaitStyles.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Compares the ways a client can wait on CollisionWorkers: blocking on each
+Submit's future in turn, submitting every batch and then waiting on all the
+futures, posting with a callback, and co_awaiting CollisionQuery from a number
+of coroutines. Each style runs the same batches, at a few batch sizes with the
+same total number of points at each, and the batches finished per second are
+reported, so the fixed cost of each style shows up at the small sizes.
+
+Usage: AwaitStyles [workers] [batches] [coroutines]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "BenchScenes.h"
+#include "CollisionAwait.h"
+
+//The batch sizes to try, in points
+static const int BATCH_POINTS[] = { 64, 1024, 16384 };
+static const int NUM_BATCH_SIZES = sizeof(BATCH_POINTS) / sizeof(BATCH_POINTS[0]);
+
+//Everything the styles share for one batch size
+struct Workload
+{
+	CollisionWorkers* workers;
+	OBBCollider box;
+	const float* x;
+	const float* y;
+	const float* z;
+	int batchPoints;
+	int numBatches;
+	std::vector<unsigned char> results;
+	std::atomic<int> finished;
+
+	unsigned char* Results(int batch)
+	{
+		return this->results.data() + (size_t)batch * this->batchPoints;
+	}
+};
+
+///
+//Waits until every batch of a workload is finished
+static void WaitFinished(Workload &work)
+{
+	while (work.finished.load(std::memory_order_acquire) < work.numBatches)
+		std::this_thread::yield();
+}
+
+///
+//Submits one batch at a time and blocks on its future
+static void RunBlocking(Workload &work)
+{
+	QueryBatch batch;
+	batch.collider = work.box;
+	batch.x = work.x;
+	batch.y = work.y;
+	batch.z = work.z;
+	batch.count = work.batchPoints;
+	for (int b = 0; b < work.numBatches; b++)
+	{
+		batch.results = work.Results(b);
+		work.workers->Submit(&batch).wait();
+	}
+}
+
+///
+//Submits every batch, then waits on all the futures
+static void RunFutures(Workload &work)
+{
+	std::vector<QueryBatch> batches(work.numBatches);
+	std::vector<std::future<void>> futures(work.numBatches);
+	for (int b = 0; b < work.numBatches; b++)
+	{
+		batches[b].collider = work.box;
+		batches[b].x = work.x;
+		batches[b].y = work.y;
+		batches[b].z = work.z;
+		batches[b].count = work.batchPoints;
+		batches[b].results = work.Results(b);
+		futures[b] = work.workers->Submit(&batches[b]);
+	}
+	for (int b = 0; b < work.numBatches; b++)
+		futures[b].wait();
+}
+
+///
+//Counts a finished batch
+static void BatchFinished(QueryBatch* batch, void* userData)
+{
+	((Workload*)userData)->finished.fetch_add(1, std::memory_order_release);
+}
+
+///
+//Posts every batch with a callback, then waits for the callbacks
+static void RunCallbacks(Workload &work)
+{
+	std::vector<QueryBatch> batches(work.numBatches);
+	work.finished.store(0);
+	for (int b = 0; b < work.numBatches; b++)
+	{
+		batches[b].collider = work.box;
+		batches[b].x = work.x;
+		batches[b].y = work.y;
+		batches[b].z = work.z;
+		batches[b].count = work.batchPoints;
+		batches[b].results = work.Results(b);
+		batches[b].callback = BatchFinished;
+		batches[b].userData = &work;
+		work.workers->Post(&batches[b]);
+	}
+	WaitFinished(work);
+}
+
+#ifdef COLLISION_COROUTINES
+//A coroutine which starts straight away and frees itself when it returns
+struct Detached
+{
+	struct promise_type
+	{
+		Detached get_return_object(void) { return Detached(); }
+		std::suspend_never initial_suspend(void) noexcept { return std::suspend_never(); }
+		std::suspend_never final_suspend(void) noexcept { return std::suspend_never(); }
+		void return_void(void) {}
+		void unhandled_exception(void) { std::terminate(); }
+	};
+};
+
+///
+//Awaits every numCoroutines'th batch, starting at first, one after another
+static Detached AwaitBatches(Workload &work, int first, int numCoroutines)
+{
+	for (int b = first; b < work.numBatches; b += numCoroutines)
+	{
+		co_await CollisionQuery(*work.workers, work.box, work.x, work.y, work.z, work.batchPoints, work.Results(b));
+		work.finished.fetch_add(1, std::memory_order_release);
+	}
+}
+
+///
+//Starts the coroutines, then waits for them all to finish their batches
+static void RunCoroutines(Workload &work, int numCoroutines)
+{
+	work.finished.store(0);
+	for (int c = 0; c < numCoroutines; c++)
+		AwaitBatches(work, c, numCoroutines);
+	WaitFinished(work);
+}
+#endif COLLISION_COROUTINES
+
+int main(int argc, char** argv)
+{
+	int numWorkers = BenchArgument(argc, argv, 1, 0);
+	int numBatches = BenchArgument(argc, argv, 2, 8192);
+	int numCoroutines = BenchArgument(argc, argv, 3, 64);
+
+	int maxPoints = BATCH_POINTS[NUM_BATCH_SIZES - 1];
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, maxPoints, 100.0f, 1);
+	std::mt19937 random(2);
+
+	CollisionWorkers workers(numWorkers, 1024);
+	printf("%d workers, %d batches, %d coroutines\n", workers.NumThreads(), numBatches, numCoroutines);
+	printf("%8s %14s %14s %14s %14s\n", "points", "blocking/s", "futures/s", "callbacks/s", "coroutines/s");
+
+	for (int s = 0; s < NUM_BATCH_SIZES; s++)
+	{
+		Workload work;
+		work.workers = &workers;
+		work.box = RandomCollider(random, 100.0f, 30.0f);
+		work.x = x.data();
+		work.y = y.data();
+		work.z = z.data();
+		work.batchPoints = BATCH_POINTS[s];
+		work.numBatches = std::max(1, (int)((long long)numBatches * BATCH_POINTS[0] / BATCH_POINTS[s]));
+		work.results.resize((size_t)work.numBatches * work.batchPoints);
+
+		double start = BenchSeconds();
+		RunBlocking(work);
+		double blocking = work.numBatches / (BenchSeconds() - start);
+
+		start = BenchSeconds();
+		RunFutures(work);
+		double futures = work.numBatches / (BenchSeconds() - start);
+
+		start = BenchSeconds();
+		RunCallbacks(work);
+		double callbacks = work.numBatches / (BenchSeconds() - start);
+
+#ifdef COLLISION_COROUTINES
+		start = BenchSeconds();
+		RunCoroutines(work, numCoroutines);
+		double coroutines = work.numBatches / (BenchSeconds() - start);
+		printf("%8d %14.0f %14.0f %14.0f %14.0f\n", work.batchPoints, blocking, futures, callbacks, coroutines);
+#else
+		printf("%8d %14.0f %14.0f %14.0f %14s\n", work.batchPoints, blocking, futures, callbacks, "-");
+#endif COLLISION_COROUTINES
+	}
+	return 0;
+}
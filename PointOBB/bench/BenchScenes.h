@@ -0,0 +1,119 @@
+/*
+Title: Point - OBB
+File Name: BenchScenes.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Shared pieces of the benchmark programs: a clock, and random boxes and points
+spread through a cube, made from a fixed seed so every run times the same data.
+*/
+
+#ifndef _BENCH_SCENES_H
+#define _BENCH_SCENES_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "CollisionScene.h"
+
+///
+//Gets the time in seconds since some fixed point
+inline double BenchSeconds(void)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///
+//Reads a positive whole number from the command line
+//
+//Parameters:
+//	argc, argv: The program's arguments
+//	index: Which argument to read
+//	fallback: The value when the argument is missing or not a positive number
+inline int BenchArgument(int argc, char** argv, int index, int fallback)
+{
+	if (index >= argc)
+		return fallback;
+	int value = atoi(argv[index]);
+	return value > 0 ? value : fallback;
+}
+
+///
+//Makes a randomly placed, rotated, and sized box
+//
+//Parameters:
+//	random: The generator to draw from
+//	worldSize: The edge length of the cube the center is placed in
+//	maxHalfExtent: The largest half extent on any axis
+inline OBBCollider RandomCollider(std::mt19937 &random, float worldSize, float maxHalfExtent)
+{
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+
+	OBBCollider collider;
+	collider.center = glm::vec3(unit(random), unit(random), unit(random)) * worldSize;
+
+	//Normalized gaussian vectors are evenly spread over directions
+	glm::vec3 u = glm::normalize(glm::vec3(normal(random), normal(random), normal(random)) + glm::vec3(1e-6f));
+	glm::vec3 other = fabsf(u.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::vec3 v = glm::normalize(glm::cross(u, other));
+	collider.axes[0] = u;
+	collider.axes[1] = v;
+	collider.axes[2] = glm::cross(u, v);
+
+	for (int a = 0; a < 3; a++)
+	{
+		float halfExtent = maxHalfExtent * (0.25f + 0.75f * unit(random));
+		collider.min[a] = -halfExtent;
+		collider.max[a] = halfExtent;
+	}
+	return collider;
+}
+
+///
+//Fills a scene with random boxes
+inline void RandomScene(CollisionScene &scene, int count, float worldSize, float maxHalfExtent, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	for (int i = 0; i < count; i++)
+		scene.Add(RandomCollider(random, worldSize, maxHalfExtent));
+}
+
+///
+//Fills separate x, y, and z arrays with points spread evenly through a cube
+inline void RandomPoints(std::vector<float> &x, std::vector<float> &y, std::vector<float> &z, int count, float worldSize, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> coordinate(0.0f, worldSize);
+	x.resize(count);
+	y.resize(count);
+	z.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		x[i] = coordinate(random);
+		y[i] = coordinate(random);
+		z[i] = coordinate(random);
+	}
+}
+
+#endif _BENCH_SCENES_H
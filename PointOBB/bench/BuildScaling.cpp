@@ -0,0 +1,137 @@
+/*
+Title: Point - OBB
+File Name: BuildScaling.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Measures how ColliderBVH::BuildLinear scales across cores. For each scene size
+the tree is built with 1, 2, 4, ... threads up to the number of hardware threads
+(or the number given), with and without the treelet pass, and the time and the
+speedup over one thread are reported, best of a few repeats. The single-threaded
+top-down Build is timed alongside for reference, and the time per query of each
+kind of tree shows what the treelet pass buys.
+
+Usage: BuildScaling [max threads] [repeats]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "BenchScenes.h"
+#include "ColliderBVH.h"
+
+//The scene sizes to try
+static const int SCENE_SIZES[] = { 1 << 14, 1 << 17, 1 << 20 };
+static const int NUM_SCENE_SIZES = sizeof(SCENE_SIZES) / sizeof(SCENE_SIZES[0]);
+
+//How many points are looked up in each finished tree
+static const int QUERY_POINTS = 1 << 16;
+
+static const float WORLD_SIZE = 1000.0f;
+
+///
+//Times one way of building a tree
+//
+//Parameters:
+//	build: Builds the tree
+//	repeats: How many times to build it
+//
+//Returns:
+//	The best time in seconds
+template <typename Build>
+static double TimeBuild(Build build, int repeats)
+{
+	double best = 1e30;
+	for (int r = 0; r < repeats; r++)
+	{
+		double start = BenchSeconds();
+		build();
+		best = std::min(best, BenchSeconds() - start);
+	}
+	return best;
+}
+
+///
+//Times looking points up in a tree
+//
+//Returns:
+//	The time per point in microseconds
+static double TimeQueries(const ColliderBVH &tree, const std::vector<float> &x, const std::vector<float> &y, const std::vector<float> &z, long long &checksum)
+{
+	double start = BenchSeconds();
+	for (size_t i = 0; i < x.size(); i++)
+		checksum += tree.FindContaining(glm::vec3(x[i], y[i], z[i]));
+	return (BenchSeconds() - start) / x.size() * 1e6;
+}
+
+int main(int argc, char** argv)
+{
+	int hardwareThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	int maxThreads = BenchArgument(argc, argv, 1, hardwareThreads);
+	int repeats = BenchArgument(argc, argv, 2, 3);
+
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, QUERY_POINTS, WORLD_SIZE, 1);
+	long long checksum = 0;
+
+	printf("up to %d threads (%d in hardware), best of %d\n", maxThreads, hardwareThreads, repeats);
+	for (int s = 0; s < NUM_SCENE_SIZES; s++)
+	{
+		int numBoxes = SCENE_SIZES[s];
+		CollisionScene scene;
+		RandomScene(scene, numBoxes, WORLD_SIZE, 0.5f * WORLD_SIZE / cbrtf((float)numBoxes), 2);
+		ColliderBVH tree;
+
+		double topDown = TimeBuild([&]() { tree.Build(scene, 1); }, repeats);
+		double topDownQuery = TimeQueries(tree, x, y, z, checksum);
+		printf("\n%d boxes: top-down build %.1f ms, %.3f us per query\n", numBoxes, topDown * 1e3, topDownQuery);
+		printf("%8s %12s %10s %14s %10s\n", "threads", "linear ms", "speedup", "treelets ms", "speedup");
+
+		//Powers of two, and the most threads even if it is not one
+		std::vector<int> threadCounts;
+		for (int threads = 1; threads < maxThreads; threads *= 2)
+			threadCounts.push_back(threads);
+		threadCounts.push_back(maxThreads);
+
+		double linearOne = 0.0, treeletsOne = 0.0;
+		double linearQuery = 0.0, treeletsQuery = 0.0;
+		for (size_t t = 0; t < threadCounts.size(); t++)
+		{
+			int threads = threadCounts[t];
+			double linear = TimeBuild([&]() { tree.BuildLinear(scene, threads, false); }, repeats);
+			linearQuery = TimeQueries(tree, x, y, z, checksum);
+			double treelets = TimeBuild([&]() { tree.BuildLinear(scene, threads, true); }, repeats);
+			treeletsQuery = TimeQueries(tree, x, y, z, checksum);
+			if (threads == 1)
+			{
+				linearOne = linear;
+				treeletsOne = treelets;
+			}
+
+			printf("%8d %12.1f %10.2f %14.1f %10.2f\n", threads, linear * 1e3, linearOne / linear, treelets * 1e3, treeletsOne / treelets);
+		}
+		printf("query us: linear %.3f, with treelets %.3f\n", linearQuery, treeletsQuery);
+	}
+
+	printf("(checksum %lld)\n", checksum);
+	return 0;
+}
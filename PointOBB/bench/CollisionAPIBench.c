@@ -0,0 +1,170 @@
+/*
+Title: Point - OBB
+File Name: CollisionAPIBench.c
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A C client of the PointOBBLibrary C interface, which measures what a call costs
+apart from the work it does. The same points are tested in batches of different
+sizes, so the time per call shows the fixed cost of crossing the interface (the
+checks, the scene's lock), and the time per point shows how quickly that cost
+is spread thin as the batches grow. Separate x, y, z arrays and interleaved
+points, which have to be gathered, are both measured.
+
+Usage: CollisionAPIBench [points] [boxes]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "CollisionAPI.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+//The batch sizes to try
+static const int BATCH_SIZES[] = { 1, 4, 16, 64, 256, 1024, 4096, 16384, 65536 };
+#define NUM_BATCH_SIZES (sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]))
+
+///
+//Gets the time in seconds since some fixed point
+static double Seconds(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency, now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+	return (double)now.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+///
+//Gets a random float from 0 to 1
+static float Random(void)
+{
+	return (float)rand() / (float)RAND_MAX;
+}
+
+///
+//Adds boxes turned about the z axis at random places
+static int MakeScene(POBB_Scene* scene, int numBoxes, float worldSize)
+{
+	int i;
+	for (i = 0; i < numBoxes; i++)
+	{
+		float angle = Random() * 6.2831853f;
+		float center[3] = { Random() * worldSize, Random() * worldSize, Random() * worldSize };
+		float axes[9] = { cosf(angle), sinf(angle), 0.0f, -sinf(angle), cosf(angle), 0.0f, 0.0f, 0.0f, 1.0f };
+		float min[3] = { -1.0f, -1.0f, -1.0f };
+		float max[3] = { 1.0f, 1.0f, 1.0f };
+		if (POBB_AddCollider(scene, center, axes, min, max, NULL) != POBB_OK)
+			return 0;
+	}
+	return POBB_BuildScene(scene) == POBB_OK;
+}
+
+int main(int argc, char** argv)
+{
+	int numPoints = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	int numBoxes = argc > 2 ? atoi(argv[2]) : 10000;
+	float worldSize = 100.0f;
+	float* x = (float*)malloc(numPoints * sizeof(float));
+	float* y = (float*)malloc(numPoints * sizeof(float));
+	float* z = (float*)malloc(numPoints * sizeof(float));
+	float* xyz = (float*)malloc(3 * (size_t)numPoints * sizeof(float));
+	uint8_t* inside = (uint8_t*)malloc(numPoints);
+	int32_t* found = (int32_t*)malloc(numPoints * sizeof(int32_t));
+	POBB_Scene* scene = POBB_CreateScene();
+	size_t b;
+	int i;
+
+	if (numPoints <= 0 || x == NULL || y == NULL || z == NULL || xyz == NULL || inside == NULL || found == NULL ||
+		scene == NULL || !MakeScene(scene, numBoxes, worldSize))
+	{
+		fprintf(stderr, "setup failed\n");
+		return 1;
+	}
+
+	for (i = 0; i < numPoints; i++)
+	{
+		x[i] = xyz[3 * i + 0] = Random() * worldSize;
+		y[i] = xyz[3 * i + 1] = Random() * worldSize;
+		z[i] = xyz[3 * i + 2] = Random() * worldSize;
+	}
+
+	printf("PointOBBLibrary version %d, %d points, %d boxes\n", POBB_Version(), numPoints, numBoxes);
+	printf("%8s | %-21s | %-21s | %-21s | %-21s\n", "", "TestBox separate", "TestBox interleaved", "Find separate", "Find interleaved");
+	printf("%8s | %10s %10s | %10s %10s | %10s %10s | %10s %10s\n", "batch",
+		"ns/call", "ns/point", "ns/call", "ns/point", "ns/call", "ns/point", "ns/call", "ns/point");
+
+	for (b = 0; b < NUM_BATCH_SIZES; b++)
+	{
+		int batch = BATCH_SIZES[b];
+		double times[4];
+		int test;
+		if (batch > numPoints)
+			break;
+
+		for (test = 0; test < 4; test++)
+		{
+			int interleaved = test & 1, find = test >> 1;
+			size_t stride = interleaved ? 3 * sizeof(float) : sizeof(float);
+			const float* px = interleaved ? xyz : x;
+			const float* py = interleaved ? xyz + 1 : y;
+			const float* pz = interleaved ? xyz + 2 : z;
+			int start;
+
+			double begin = Seconds();
+			for (start = 0; start + batch <= numPoints; start += batch)
+			{
+				size_t first = (size_t)start * (interleaved ? 3 : 1);
+				if (find)
+					POBB_FindContaining(scene, px + first, py + first, pz + first, stride, batch, found + start);
+				else
+					POBB_TestBox(scene, 0, px + first, py + first, pz + first, stride, batch, inside + start);
+			}
+			times[test] = Seconds() - begin;
+		}
+
+		{
+			double calls = (double)(numPoints / batch), points = calls * batch;
+			printf("%8d | %10.1f %10.2f | %10.1f %10.2f | %10.1f %10.2f | %10.1f %10.2f\n", batch,
+				times[0] / calls * 1e9, times[0] / points * 1e9, times[1] / calls * 1e9, times[1] / points * 1e9,
+				times[2] / calls * 1e9, times[2] / points * 1e9, times[3] / calls * 1e9, times[3] / points * 1e9);
+		}
+	}
+
+	POBB_DestroyScene(scene);
+	free(x);
+	free(y);
+	free(z);
+	free(xyz);
+	free(inside);
+	free(found);
+	return 0;
+}
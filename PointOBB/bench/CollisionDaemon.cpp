@@ -0,0 +1,65 @@
+/*
+Title: Point - OBB
+File Name: CollisionDaemon.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Runs the collision service (see CollisionService.h) until it is interrupted with
+Ctrl+C or sent SIGTERM. Linux only.
+
+Usage: CollisionDaemon [socket path] [worker threads]
+*/
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include "CollisionService.h"
+
+//Cleared by the signal handler to shut the service down
+static std::atomic<bool> running(true);
+
+///
+//Asks the service to shut down
+static void Stop(int signal)
+{
+	(void)signal;
+	running.store(false);
+}
+
+int main(int argc, char** argv)
+{
+	const char* socketPath = argc > 1 ? argv[1] : "/tmp/pointobb.sock";
+	int numThreads = argc > 2 ? atoi(argv[2]) : 0;
+
+	signal(SIGINT, Stop);
+	signal(SIGTERM, Stop);
+
+	printf("serving on %s\n", socketPath);
+	fflush(stdout);
+	if (!RunCollisionService(socketPath, numThreads, running))
+	{
+		fprintf(stderr, "could not listen on %s\n", socketPath);
+		return 1;
+	}
+	printf("stopped\n");
+	return 0;
+}
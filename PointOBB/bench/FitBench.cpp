@@ -0,0 +1,124 @@
+/*
+Title: Point - OBB
+File Name: FitBench.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Times FitOBB and reports how tight its boxes are. Each cloud is drawn from inside
+a random rotated box and includes that box's eight corners, so the box is known
+to fit and its volume is a bound to measure against. Clouds are either spread
+evenly through the box or bunched along one of its diagonals, which pulls the
+PCA axes away from the box's own. For each cloud size and shape the time of a
+plain PCA fit and of a refined fit are reported, with the volume of each as a
+multiple of the source box's volume.
+
+Usage: FitBench [clouds per row]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "BenchScenes.h"
+#include "OBBFitting.h"
+
+//The cloud sizes to try, in points
+static const int CLOUD_SIZES[] = { 64, 1024, 16384, 262144 };
+static const int NUM_CLOUD_SIZES = sizeof(CLOUD_SIZES) / sizeof(CLOUD_SIZES[0]);
+
+//The fraction of a bunched cloud's points which lie near the diagonal
+static const float BUNCHED_FRACTION = 0.9f;
+
+///
+//Fills positions with a cloud inside a box, corners first
+//
+//Parameters:
+//	random: The generator to draw from
+//	box: The box the cloud is drawn from
+//	count: The number of points, at least 8
+//	bunched: Whether most of the points should lie near a diagonal
+//	positions: Receives x, y, z for each point
+static void MakeCloud(std::mt19937 &random, const OBBCollider &box, int count, bool bunched, std::vector<float> &positions)
+{
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> noise(0.0f, 0.05f);
+	positions.resize((size_t)count * 3);
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 t;
+		if (i < 8)
+			t = glm::vec3((float)(i & 1), (float)((i >> 1) & 1), (float)(i >> 2));
+		else if (bunched && unit(random) < BUNCHED_FRACTION)
+		{
+			float along = unit(random);
+			t = glm::clamp(glm::vec3(along + noise(random), along + noise(random), along + noise(random)), 0.0f, 1.0f);
+		}
+		else
+			t = glm::vec3(unit(random), unit(random), unit(random));
+
+		glm::vec3 point = box.center;
+		for (int a = 0; a < 3; a++)
+			point += box.axes[a] * (box.min[a] + t[a] * (box.max[a] - box.min[a]));
+		positions[(size_t)i * 3 + 0] = point.x;
+		positions[(size_t)i * 3 + 1] = point.y;
+		positions[(size_t)i * 3 + 2] = point.z;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int numClouds = BenchArgument(argc, argv, 1, 16);
+
+	printf("%d clouds per row, volumes as a multiple of the source box\n", numClouds);
+	printf("%8s %8s %12s %12s %12s %12s\n", "points", "shape", "pca us", "pca volume", "refined us", "refined vol");
+
+	std::vector<float> positions;
+	for (int c = 0; c < NUM_CLOUD_SIZES; c++)
+	{
+		for (int shape = 0; shape < 2; shape++)
+		{
+			std::mt19937 random(1 + c);
+			double pcaTime = 0.0, refinedTime = 0.0;
+			double pcaRatio = 0.0, refinedRatio = 0.0;
+			for (int i = 0; i < numClouds; i++)
+			{
+				OBBCollider box = RandomCollider(random, 100.0f, 10.0f);
+				MakeCloud(random, box, CLOUD_SIZES[c], shape == 1, positions);
+				glm::vec3 extent = box.max - box.min;
+				double boxVolume = (double)extent.x * extent.y * extent.z;
+
+				double start = BenchSeconds();
+				FittedOBB pca = FitOBB(positions.data(), CLOUD_SIZES[c], 3, false);
+				pcaTime += BenchSeconds() - start;
+
+				start = BenchSeconds();
+				FittedOBB refined = FitOBB(positions.data(), CLOUD_SIZES[c], 3, true);
+				refinedTime += BenchSeconds() - start;
+
+				pcaRatio += Volume(pca) / boxVolume;
+				refinedRatio += Volume(refined) / boxVolume;
+			}
+
+			printf("%8d %8s %12.1f %12.3f %12.1f %12.3f\n", CLOUD_SIZES[c], shape == 1 ? "bunched" : "even",
+				pcaTime / numClouds * 1e6, pcaRatio / numClouds, refinedTime / numClouds * 1e6, refinedRatio / numClouds);
+		}
+	}
+	return 0;
+}
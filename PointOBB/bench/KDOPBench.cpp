@@ -0,0 +1,98 @@
+/*
+Title: Point - OBB
+File Name: KDOPBench.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Compares the batch point test of each k-DOP against the OBB's. A random rotated
+box is wrapped in a 6, 14, 18, and 26-DOP, and the points streamed through each
+collider per second are reported, best of a few repeats. Since a k-DOP fitted
+around a box holds more than the box does, each row also gives how many points
+it finds as a multiple of the box's count.
+
+Usage: KDOPBench [points] [repeats]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "BenchScenes.h"
+#include "KDOP.h"
+
+///
+//Times one collider's batch test
+//
+//Returns:
+//	The best time of the repeats in seconds, with inside set to the points found
+template<typename Collider>
+static double TimeCollider(const Collider &collider, const std::vector<float> &x, const std::vector<float> &y, const std::vector<float> &z,
+	std::vector<unsigned char> &results, int repeats, long long &inside)
+{
+	int count = (int)x.size();
+	double best = 1e30;
+	for (int r = 0; r < repeats; r++)
+	{
+		double start = BenchSeconds();
+		TestCollisions(collider, x.data(), y.data(), z.data(), count, results.data());
+		best = std::min(best, BenchSeconds() - start);
+	}
+
+	inside = 0;
+	for (int i = 0; i < count; i++)
+		inside += results[i];
+	return best;
+}
+
+///
+//Prints one row of the table
+static void PrintRow(const char* name, int count, double seconds, long long inside, long long boxInside)
+{
+	printf("%8s %12.1f %12lld %12.3f\n", name, count / seconds / 1e6, inside, boxInside > 0 ? (double)inside / boxInside : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+	int numPoints = BenchArgument(argc, argv, 1, 1 << 22);
+	int repeats = BenchArgument(argc, argv, 2, 5);
+
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, numPoints, 100.0f, 1);
+	std::vector<unsigned char> results(numPoints);
+	std::mt19937 random(2);
+	OBBCollider box = RandomCollider(random, 100.0f, 30.0f);
+
+	printf("%d points, best of %d\n", numPoints, repeats);
+	printf("%8s %12s %12s %12s\n", "collider", "Mpts/s", "inside", "vs OBB");
+
+	long long boxInside, inside;
+	double seconds = TimeCollider(box, x, y, z, results, repeats, boxInside);
+	PrintRow("OBB", numPoints, seconds, boxInside, boxInside);
+
+	seconds = TimeCollider(FitKDOP<6>(box), x, y, z, results, repeats, inside);
+	PrintRow("6-DOP", numPoints, seconds, inside, boxInside);
+	seconds = TimeCollider(FitKDOP<14>(box), x, y, z, results, repeats, inside);
+	PrintRow("14-DOP", numPoints, seconds, inside, boxInside);
+	seconds = TimeCollider(FitKDOP<18>(box), x, y, z, results, repeats, inside);
+	PrintRow("18-DOP", numPoints, seconds, inside, boxInside);
+	seconds = TimeCollider(FitKDOP<26>(box), x, y, z, results, repeats, inside);
+	PrintRow("26-DOP", numPoints, seconds, inside, boxInside);
+	return 0;
+}
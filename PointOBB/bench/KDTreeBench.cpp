@@ -0,0 +1,111 @@
+/*
+Title: Point - OBB
+File Name: KDTreeBench.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Compares PointKDTree against a linear scan with TestCollisions for finding the
+points inside a box. For each cloud size the tree's build time is reported, and
+then, for boxes of a few sizes, the time per box of a tree query and of a scan
+which tests every point and gathers the indices of those inside. The break-even
+is the number of boxes which pays for the build.
+
+Usage: KDTreeBench [boxes per size] [bucket size]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "BenchScenes.h"
+#include "PointKDTree.h"
+
+//The cloud sizes to try
+static const int CLOUD_SIZES[] = { 1 << 16, 1 << 20, 1 << 23 };
+static const int NUM_CLOUD_SIZES = sizeof(CLOUD_SIZES) / sizeof(CLOUD_SIZES[0]);
+
+//The largest half extent of the boxes, as a fraction of the world, which
+//decides roughly what fraction of the points each box holds
+static const float BOX_SIZES[] = { 0.01f, 0.05f, 0.2f };
+static const int NUM_BOX_SIZES = sizeof(BOX_SIZES) / sizeof(BOX_SIZES[0]);
+
+static const float WORLD_SIZE = 100.0f;
+
+int main(int argc, char** argv)
+{
+	int numBoxes = BenchArgument(argc, argv, 1, 64);
+	int bucketSize = BenchArgument(argc, argv, 2, 32);
+
+	printf("%d boxes per size, buckets of %d points\n", numBoxes, bucketSize);
+	printf("%10s %6s %10s %10s %12s %12s %10s %10s\n", "points", "box", "build ms", "inside", "tree us", "scan us", "break-even", "mismatch");
+
+	for (int c = 0; c < NUM_CLOUD_SIZES; c++)
+	{
+		int numPoints = CLOUD_SIZES[c];
+		std::vector<float> x, y, z;
+		RandomPoints(x, y, z, numPoints, WORLD_SIZE, 1);
+
+		double start = BenchSeconds();
+		PointKDTree tree;
+		tree.Build(x.data(), y.data(), z.data(), numPoints, bucketSize);
+		double buildTime = BenchSeconds() - start;
+
+		std::vector<unsigned char> inside(numPoints);
+		std::vector<int> treeResults, scanResults;
+		for (int b = 0; b < NUM_BOX_SIZES; b++)
+		{
+			std::mt19937 random(2 + b);
+			double treeTime = 0.0, scanTime = 0.0;
+			long long found = 0;
+			int mismatches = 0;
+			for (int i = 0; i < numBoxes; i++)
+			{
+				OBBCollider box = RandomCollider(random, WORLD_SIZE, BOX_SIZES[b] * WORLD_SIZE);
+
+				treeResults.clear();
+				start = BenchSeconds();
+				tree.Query(box, treeResults);
+				treeTime += BenchSeconds() - start;
+
+				scanResults.clear();
+				start = BenchSeconds();
+				TestCollisions(box, x.data(), y.data(), z.data(), numPoints, inside.data());
+				for (int p = 0; p < numPoints; p++)
+				{
+					if (inside[p])
+						scanResults.push_back(p);
+				}
+				scanTime += BenchSeconds() - start;
+
+				found += (long long)scanResults.size();
+				std::sort(treeResults.begin(), treeResults.end());
+				if (treeResults != scanResults)
+					mismatches++;
+			}
+
+			//How many boxes it takes for the tree's savings to cover its build
+			double saved = (scanTime - treeTime) / numBoxes;
+			double breakEven = saved > 0.0 ? buildTime / saved : -1.0;
+			printf("%10d %6.2f %10.1f %10lld %12.1f %12.1f %10.0f %10d\n", numPoints, BOX_SIZES[b], buildTime * 1e3, found / numBoxes,
+				treeTime / numBoxes * 1e6, scanTime / numBoxes * 1e6, breakEven, mismatches);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*
+Title: Point - OBB
+File Name: KNearestBench.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Times ColliderBVH::KNearest over a range of scene sizes and values of K, against
+a scan which measures the distance to every box and keeps the K smallest. The
+scan is only run for a few of the query points, since it is linear in the scene
+size. Both are single-threaded and report microseconds per query, and the
+distances the two find are compared.
+
+Usage: KNearestBench [queries] [scan queries]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "BenchScenes.h"
+#include "ColliderBVH.h"
+
+//The scene sizes and values of K to try
+static const int SCENE_SIZES[] = { 1024, 16384, 262144 };
+static const int NUM_SCENE_SIZES = sizeof(SCENE_SIZES) / sizeof(SCENE_SIZES[0]);
+static const int KS[] = { 1, 4, 16, 64 };
+static const int NUM_KS = sizeof(KS) / sizeof(KS[0]);
+
+//The scene's boxes are spread through a cube this size whatever their number,
+//and shrink as there are more of them so they cover about the same volume
+static const float WORLD_SIZE = 1000.0f;
+
+///
+//Finds the k smallest squared distances from a point to every box of a scene
+static void ScanNearest(const CollisionScene &scene, glm::vec3 point, int k, std::vector<float> &distances, std::vector<float> &nearest)
+{
+	int numColliders = scene.Size();
+	distances.resize(numColliders);
+	for (int i = 0; i < numColliders; i++)
+		distances[i] = DistanceSquared(scene.colliders[i], point);
+
+	k = std::min(k, numColliders);
+	std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+	nearest.assign(distances.begin(), distances.begin() + k);
+}
+
+int main(int argc, char** argv)
+{
+	int numQueries = BenchArgument(argc, argv, 1, 16384);
+	int numScanQueries = BenchArgument(argc, argv, 2, 64);
+	numScanQueries = std::min(numScanQueries, numQueries);
+
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, numQueries, WORLD_SIZE, 1);
+
+	printf("%d BVH queries and %d scan queries per row\n", numQueries, numScanQueries);
+	printf("%8s %4s %12s %12s %12s %10s\n", "boxes", "k", "build ms", "bvh us", "scan us", "mismatch");
+
+	for (int s = 0; s < NUM_SCENE_SIZES; s++)
+	{
+		int numBoxes = SCENE_SIZES[s];
+		CollisionScene scene;
+		RandomScene(scene, numBoxes, WORLD_SIZE, 0.5f * WORLD_SIZE / cbrtf((float)numBoxes), 2);
+
+		double start = BenchSeconds();
+		ColliderBVH tree;
+		tree.Build(scene, 4);
+		double buildTime = BenchSeconds() - start;
+
+		for (int kk = 0; kk < NUM_KS; kk++)
+		{
+			int k = KS[kk];
+			std::vector<int> indices((size_t)numQueries * k);
+			std::vector<float> bvhDistances((size_t)numQueries * k);
+
+			start = BenchSeconds();
+			tree.KNearest(x.data(), y.data(), z.data(), numQueries, k, indices.data(), bvhDistances.data(), 1);
+			double bvhTime = BenchSeconds() - start;
+
+			std::vector<float> scratch, nearest;
+			int mismatches = 0;
+			double scanTime = 0.0;
+			for (int q = 0; q < numScanQueries; q++)
+			{
+				start = BenchSeconds();
+				ScanNearest(scene, glm::vec3(x[q], y[q], z[q]), k, scratch, nearest);
+				scanTime += BenchSeconds() - start;
+
+				for (size_t i = 0; i < nearest.size(); i++)
+				{
+					if (nearest[i] != bvhDistances[(size_t)q * k + i])
+						mismatches++;
+				}
+			}
+
+			printf("%8d %4d %12.2f %12.3f %12.3f %10d\n", numBoxes, k, buildTime * 1e3,
+				bvhTime / numQueries * 1e6, scanTime / numScanQueries * 1e6, mismatches);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,160 @@
+/*
+Title: Point - OBB
+File Name: MixedShapes.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Times Narrowphase on scenes with different mixes of spheres, capsules, and OBBs,
+against a loop which switches on the kind of shape for every pair. The pairs
+join random points to random shapes, in random order, the way a broadphase
+would hand them over. Both report millions of pairs per second, best of a few
+repeats, and their answers are compared.
+
+Usage: MixedShapes [pairs] [shapes] [repeats]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "BenchScenes.h"
+#include "Narrowphase.h"
+
+//A mix of shapes, as the share of each kind
+struct ShapeMix
+{
+	const char* name;
+	float spheres;
+	float capsules;
+};
+
+//The mixes to try; whatever is not spheres or capsules is OBBs
+static const ShapeMix MIXES[] =
+{
+	{ "OBBs", 0.0f, 0.0f },
+	{ "spheres", 1.0f, 0.0f },
+	{ "capsules", 0.0f, 1.0f },
+	{ "thirds", 0.34f, 0.33f },
+	{ "90% OBB", 0.05f, 0.05f },
+};
+static const int NUM_MIXES = sizeof(MIXES) / sizeof(MIXES[0]);
+
+static const float WORLD_SIZE = 100.0f;
+
+///
+//Fills a scene with a mix of randomly placed shapes
+static void MixedScene(ShapeScene &scene, const ShapeMix &mix, int count, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (int i = 0; i < count; i++)
+	{
+		float kind = unit(random);
+		glm::vec3 center = glm::vec3(unit(random), unit(random), unit(random)) * WORLD_SIZE;
+		if (kind < mix.spheres)
+		{
+			Sphere sphere = { center, 5.0f + 10.0f * unit(random) };
+			scene.Add(sphere);
+		}
+		else if (kind < mix.spheres + mix.capsules)
+		{
+			glm::vec3 offset = (glm::vec3(unit(random), unit(random), unit(random)) - 0.5f) * 20.0f;
+			Capsule capsule = { center - offset, center + offset, 3.0f + 5.0f * unit(random) };
+			scene.Add(capsule);
+		}
+		else
+			scene.Add(RandomCollider(random, WORLD_SIZE, 15.0f));
+	}
+}
+
+///
+//Tests each pair on its own, switching on the kind of shape
+static void TestEachPair(const ShapeScene &scene, const float* x, const float* y, const float* z, const CandidatePair* pairs, int count, unsigned char* results)
+{
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 point(x[pairs[i].point], y[pairs[i].point], z[pairs[i].point]);
+		const ShapeRef &shape = scene.shapes[pairs[i].shape];
+		switch (shape.type)
+		{
+		case SHAPE_SPHERE:
+			results[i] = TestCollision(scene.spheres[shape.index], point);
+			break;
+		case SHAPE_CAPSULE:
+			results[i] = TestCollision(scene.capsules[shape.index], point);
+			break;
+		default:
+			results[i] = TestCollision(scene.boxes[shape.index], point);
+			break;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int numPairs = BenchArgument(argc, argv, 1, 1 << 21);
+	int numShapes = BenchArgument(argc, argv, 2, 4096);
+	int repeats = BenchArgument(argc, argv, 3, 5);
+
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, numPairs, WORLD_SIZE, 1);
+
+	std::mt19937 random(2);
+	std::uniform_int_distribution<int> anyShape(0, numShapes - 1);
+	std::vector<CandidatePair> pairs(numPairs);
+	for (int i = 0; i < numPairs; i++)
+	{
+		pairs[i].point = i;
+		pairs[i].shape = anyShape(random);
+	}
+
+	printf("%d pairs over %d shapes, best of %d\n", numPairs, numShapes, repeats);
+	printf("%10s %14s %14s %10s %10s\n", "mix", "sorted Mp/s", "switch Mp/s", "inside", "mismatch");
+
+	Narrowphase narrowphase;
+	std::vector<unsigned char> sorted(numPairs), each(numPairs);
+	for (int m = 0; m < NUM_MIXES; m++)
+	{
+		ShapeScene scene;
+		MixedScene(scene, MIXES[m], numShapes, 3 + m);
+
+		double sortedTime = 1e30, eachTime = 1e30;
+		for (int r = 0; r < repeats; r++)
+		{
+			double start = BenchSeconds();
+			narrowphase.Run(scene, x.data(), y.data(), z.data(), pairs.data(), numPairs, sorted.data());
+			sortedTime = std::min(sortedTime, BenchSeconds() - start);
+
+			start = BenchSeconds();
+			TestEachPair(scene, x.data(), y.data(), z.data(), pairs.data(), numPairs, each.data());
+			eachTime = std::min(eachTime, BenchSeconds() - start);
+		}
+
+		long long inside = 0;
+		int mismatches = 0;
+		for (int i = 0; i < numPairs; i++)
+		{
+			inside += sorted[i];
+			mismatches += sorted[i] != each[i];
+		}
+		printf("%10s %14.1f %14.1f %10lld %10d\n", MIXES[m].name, numPairs / sortedTime / 1e6, numPairs / eachTime / 1e6, inside, mismatches);
+	}
+	return 0;
+}
@@ -0,0 +1,130 @@
+/*
+Title: Point - OBB
+File Name: NumaBench.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Measures what NUMA placement is worth to CollisionWorkers. Without placement the
+points are in one array filled by the main thread, so their pages all land on its
+node, and a plain pool runs the batches. With placement each node's share of the
+points is allocated on that node with NumaAllocate, and a NUMA-aware pool runs
+the batches SplitBatchByNode makes of them on the nodes holding them. The points
+streamed per second are reported for each, best of a few repeats. On a machine
+with one node there is nothing to compare, and the benchmark says so and stops.
+
+Usage: NumaBench [points] [points per batch] [repeats] [workers]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "BenchScenes.h"
+#include "CollisionWorkers.h"
+
+///
+//Submits batches and waits for them all
+//
+//Returns:
+//	The time taken in seconds
+static double RunBatches(CollisionWorkers &workers, std::vector<QueryBatch> &batches)
+{
+	std::vector<std::future<void>> futures(batches.size());
+	double start = BenchSeconds();
+	for (size_t b = 0; b < batches.size(); b++)
+		futures[b] = workers.Submit(&batches[b]);
+	for (size_t b = 0; b < futures.size(); b++)
+		futures[b].wait();
+	return BenchSeconds() - start;
+}
+
+int main(int argc, char** argv)
+{
+	int numNodes = NumaNodeCount();
+	if (numNodes <= 1)
+	{
+		printf("one NUMA node, nothing to compare\n");
+		return 0;
+	}
+
+	int numPoints = BenchArgument(argc, argv, 1, 1 << 25);
+	int batchPoints = BenchArgument(argc, argv, 2, 1 << 16);
+	int repeats = BenchArgument(argc, argv, 3, 5);
+	int numWorkers = BenchArgument(argc, argv, 4, 0);
+
+	std::mt19937 random(1);
+	OBBCollider box = RandomCollider(random, 100.0f, 30.0f);
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, numPoints, 100.0f, 2);
+	std::vector<unsigned char> results(numPoints);
+
+	//Without placement: everything where the main thread touched it
+	std::vector<QueryBatch> batches;
+	SplitBatchByNode(box, x.data(), y.data(), z.data(), numPoints, results.data(), batchPoints, batches);
+	for (size_t b = 0; b < batches.size(); b++)
+		batches[b].node = -1;
+
+	double unplaced = 1e30;
+	{
+		CollisionWorkers workers(numWorkers, batches.size(), false);
+		printf("%d nodes, %d workers, %d points in batches of %d, best of %d\n", numNodes, workers.NumThreads(), numPoints, batchPoints, repeats);
+		for (int r = 0; r < repeats; r++)
+			unplaced = std::min(unplaced, RunBatches(workers, batches));
+	}
+
+	//With placement: each node's share of the points allocated on it
+	std::vector<float*> nodeArrays;
+	std::vector<size_t> nodeBytes;
+	std::vector<QueryBatch> placedBatches;
+	for (int node = 0; node < numNodes; node++)
+	{
+		int first = (int)((long long)numPoints * node / numNodes);
+		int count = (int)((long long)numPoints * (node + 1) / numNodes) - first;
+		size_t bytes = (size_t)count * 3 * sizeof(float);
+		float* points = (float*)NumaAllocate(bytes, node);
+		if (points == nullptr)
+		{
+			printf("could not allocate on node %d\n", node);
+			return 1;
+		}
+		memcpy(points, x.data() + first, (size_t)count * sizeof(float));
+		memcpy(points + count, y.data() + first, (size_t)count * sizeof(float));
+		memcpy(points + 2 * count, z.data() + first, (size_t)count * sizeof(float));
+		nodeArrays.push_back(points);
+		nodeBytes.push_back(bytes);
+
+		SplitBatchByNode(box, points, points + count, points + 2 * count, count, results.data() + first, batchPoints, placedBatches);
+	}
+
+	double placed = 1e30;
+	{
+		CollisionWorkers workers(numWorkers, placedBatches.size(), true);
+		for (int r = 0; r < repeats; r++)
+			placed = std::min(placed, RunBatches(workers, placedBatches));
+	}
+
+	for (size_t node = 0; node < nodeArrays.size(); node++)
+		NumaFree(nodeArrays[node], nodeBytes[node]);
+
+	printf("%12s %12s\n", "placement", "Mpts/s");
+	printf("%12s %12.1f\n", "none", numPoints / unplaced / 1e6);
+	printf("%12s %12.1f\n", "per node", numPoints / placed / 1e6);
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*
+Title: Point - OBB
+File Name: PrefetchSweep.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Sweeps the prefetch distance and reports the best one for this machine. Each
+distance times TestCollisions streaming a point cloud much larger than the cache
+through one box, and a binary BVH walk of random points through a large scene.
+The best distance can be passed to SetPrefetchDistance at startup.
+
+Usage: PrefetchSweep [points] [boxes] [repeats]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "BenchScenes.h"
+#include "ColliderBVH.h"
+#include "Prefetch.h"
+
+//The distances to try, in cache lines ahead, 0 being no prefetching at all
+static const int DISTANCES[] = { 0, 1, 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+static const int NUM_DISTANCES = sizeof(DISTANCES) / sizeof(DISTANCES[0]);
+
+//How many points walk the BVH each repeat
+static const int WALK_POINTS = 1 << 18;
+
+int main(int argc, char** argv)
+{
+	int numPoints = BenchArgument(argc, argv, 1, 1 << 23);
+	int numBoxes = BenchArgument(argc, argv, 2, 1 << 19);
+	int repeats = BenchArgument(argc, argv, 3, 3);
+
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, numPoints, 100.0f, 1);
+	std::vector<unsigned char> results(numPoints);
+	std::mt19937 random(2);
+	OBBCollider box = RandomCollider(random, 100.0f, 30.0f);
+
+	CollisionScene scene;
+	RandomScene(scene, numBoxes, 1000.0f, 2.0f, 3);
+	ColliderBVH tree;
+	tree.Build(scene, 4);
+	std::vector<float> wx, wy, wz;
+	RandomPoints(wx, wy, wz, WALK_POINTS, 1000.0f, 4);
+
+	printf("%d points streamed, %d boxes walked by %d points, best of %d\n", numPoints, numBoxes, WALK_POINTS, repeats);
+	printf("%8s %14s %14s\n", "lines", "stream Mpts/s", "walk Mpts/s");
+
+	int bestStream = 0, bestWalk = 0;
+	double bestStreamRate = 0.0, bestWalkRate = 0.0;
+	long long found = 0;
+	for (int d = 0; d < NUM_DISTANCES; d++)
+	{
+		SetPrefetchDistance(DISTANCES[d]);
+
+		double streamTime = 1e30, walkTime = 1e30;
+		for (int r = 0; r < repeats; r++)
+		{
+			double start = BenchSeconds();
+			TestCollisions(box, x.data(), y.data(), z.data(), numPoints, results.data());
+			streamTime = std::min(streamTime, BenchSeconds() - start);
+
+			start = BenchSeconds();
+			for (int i = 0; i < WALK_POINTS; i++)
+				found += tree.FindContaining(glm::vec3(wx[i], wy[i], wz[i]));
+			walkTime = std::min(walkTime, BenchSeconds() - start);
+		}
+
+		double streamRate = numPoints / streamTime / 1e6;
+		double walkRate = WALK_POINTS / walkTime / 1e6;
+		printf("%8d %14.1f %14.2f\n", DISTANCES[d], streamRate, walkRate);
+		if (streamRate > bestStreamRate)
+		{
+			bestStreamRate = streamRate;
+			bestStream = DISTANCES[d];
+		}
+		if (walkRate > bestWalkRate)
+		{
+			bestWalkRate = walkRate;
+			bestWalk = DISTANCES[d];
+		}
+	}
+
+	//Traversals only look one step ahead, so the walk only says whether prefetching is worth having at all
+	printf("best streaming distance: %d lines (%.1f Mpts/s)\n", bestStream, bestStreamRate);
+	printf("best walk: %s (%.2f Mpts/s)\n", bestWalk == 0 ? "no prefetching" : "prefetching", bestWalkRate);
+	printf("(checksum %lld)\n", found + results[numPoints / 2]);
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+Title: Point - OBB
+File Name: ServiceLoad.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Load generator for the collision service. Each client thread connects to a
+running CollisionDaemon and keeps a fixed number of requests in flight, sending
+a new one each time a response comes back. The time from sending a request to
+receiving its response is recorded for every request, and the percentiles of
+those latencies are printed along with the throughput. Linux only.
+
+Usage: ServiceLoad [socket path] [clients] [requests per client] [points per request] [requests in flight per client]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "BenchScenes.h"
+#include "CollisionService.h"
+
+//The arrays of one in-flight request in the shared memory
+struct Slot
+{
+	uint64_t xOffset, yOffset, zOffset, resultOffset;
+};
+
+///
+//Rounds a byte count up to a whole number of cache lines
+static uint64_t LineAligned(uint64_t bytes)
+{
+	return (bytes + 63) / 64 * 64;
+}
+
+///
+//Runs one client, recording the latency of each of its requests in seconds
+//
+//Returns:
+//	false if the client could not connect or lost its connection
+static bool RunClient(const char* socketPath, int client, int numRequests, int numPoints, int depth, std::vector<double> &latencies)
+{
+	uint64_t floatBytes = LineAligned((uint64_t)numPoints * sizeof(float));
+	uint64_t slotBytes = 3 * floatBytes + LineAligned((uint64_t)numPoints);
+
+	CollisionServiceClient connection;
+	if (!connection.Connect(socketPath, (size_t)(slotBytes * depth)))
+		return false;
+
+	//Every slot gets its own points and results, so requests in flight never share memory
+	std::vector<Slot> slots(depth);
+	std::vector<float> x, y, z;
+	for (int s = 0; s < depth; s++)
+	{
+		uint64_t base = slotBytes * s;
+		slots[s].xOffset = base;
+		slots[s].yOffset = base + floatBytes;
+		slots[s].zOffset = base + 2 * floatBytes;
+		slots[s].resultOffset = base + 3 * floatBytes;
+
+		RandomPoints(x, y, z, numPoints, 100.0f, (unsigned int)(client * depth + s));
+		memcpy(connection.Shared() + slots[s].xOffset, x.data(), numPoints * sizeof(float));
+		memcpy(connection.Shared() + slots[s].yOffset, y.data(), numPoints * sizeof(float));
+		memcpy(connection.Shared() + slots[s].zOffset, z.data(), numPoints * sizeof(float));
+	}
+
+	std::mt19937 random(1000 + client);
+	std::vector<double> sent(numRequests);
+	latencies.resize(numRequests);
+
+	ServiceRequest request;
+	request.count = (uint32_t)numPoints;
+	int numSent = 0;
+	for (int received = 0; received < numRequests; received++)
+	{
+		//Keep depth requests in flight, each one using the slot of the id depth before it
+		while (numSent < numRequests && numSent - received < depth)
+		{
+			const Slot &slot = slots[numSent % depth];
+			request.id = (uint32_t)numSent;
+			request.xOffset = slot.xOffset;
+			request.yOffset = slot.yOffset;
+			request.zOffset = slot.zOffset;
+			request.resultOffset = slot.resultOffset;
+			request.collider = RandomCollider(random, 100.0f, 30.0f);
+			sent[numSent] = BenchSeconds();
+			if (!connection.Send(request))
+				return false;
+			numSent++;
+		}
+
+		ServiceResponse response;
+		if (!connection.Receive(response) || response.status != 0 || response.id >= (uint32_t)numRequests)
+			return false;
+		latencies[response.id] = BenchSeconds() - sent[response.id];
+	}
+	return true;
+}
+
+///
+//Gets the latency below which a fraction of the sorted latencies fall
+static double Percentile(const std::vector<double> &sorted, double fraction)
+{
+	size_t index = (size_t)(fraction * (sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+int main(int argc, char** argv)
+{
+	const char* socketPath = argc > 1 ? argv[1] : "/tmp/pointobb.sock";
+	int numClients = BenchArgument(argc, argv, 2, 4);
+	int numRequests = BenchArgument(argc, argv, 3, 20000);
+	int numPoints = BenchArgument(argc, argv, 4, 1024);
+	int depth = BenchArgument(argc, argv, 5, 16);
+
+	std::vector<std::vector<double> > latencies(numClients);
+	std::vector<std::thread> clients;
+	std::vector<char> ok(numClients, 0);
+
+	double start = BenchSeconds();
+	for (int c = 0; c < numClients; c++)
+	{
+		clients.push_back(std::thread([&, c]
+		{
+			ok[c] = RunClient(socketPath, c, numRequests, numPoints, depth, latencies[c]) ? 1 : 0;
+		}));
+	}
+	for (int c = 0; c < numClients; c++)
+		clients[c].join();
+	double elapsed = BenchSeconds() - start;
+
+	std::vector<double> all;
+	for (int c = 0; c < numClients; c++)
+	{
+		if (!ok[c])
+		{
+			fprintf(stderr, "client %d failed, is CollisionDaemon running on %s?\n", c, socketPath);
+			return 1;
+		}
+		all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+	}
+	std::sort(all.begin(), all.end());
+
+	double total = (double)numClients * numRequests;
+	printf("%d clients x %d requests of %d points, %d in flight each\n", numClients, numRequests, numPoints, depth);
+	printf("throughput: %.0f requests/s, %.1f Mpoints/s\n", total / elapsed, total * numPoints / elapsed / 1e6);
+	printf("latency us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+		Percentile(all, 0.5) * 1e6, Percentile(all, 0.9) * 1e6, Percentile(all, 0.99) * 1e6,
+		Percentile(all, 0.999) * 1e6, all.back() * 1e6);
+	return 0;
+}
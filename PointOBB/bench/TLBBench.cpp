@@ -0,0 +1,275 @@
+/*
+Title: Point - OBB
+File Name: TLBBench.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Compares ordinary pages with huge pages for a point cloud far bigger than the TLB
+reaches. The same points are put in ordinary pages, with huge pages turned off
+for them where that can be asked for, and in a HugeVector. Each copy is then
+streamed through TestCollisions, and looked up at random indices, which is where
+the TLB is missed most. The points per second are reported, and on Linux the
+data TLB misses per thousand points as well, read with perf_event_open; where
+the counter is not available (no permission, or a virtual machine without one)
+they are shown as n/a.
+
+Usage: TLBBench [points] [random lookups] [repeats]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "BenchScenes.h"
+#include "HugePages.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//Counts data TLB misses on the calling thread, where the system lets it
+class TLBCounter
+{
+public:
+	TLBCounter(void)
+	{
+		this->fd = -1;
+#ifdef __linux__
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		this->fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+
+	~TLBCounter(void)
+	{
+#ifdef __linux__
+		if (this->fd >= 0)
+			close(this->fd);
+#endif
+	}
+
+	bool Available(void) const
+	{
+		return this->fd >= 0;
+	}
+
+	void Start(void)
+	{
+#ifdef __linux__
+		if (this->fd >= 0)
+		{
+			ioctl(this->fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(this->fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	///
+	//Stops counting
+	//
+	//Returns:
+	//	The misses since Start, or -1 if they cannot be counted
+	long long Stop(void)
+	{
+		long long misses = -1;
+#ifdef __linux__
+		if (this->fd >= 0)
+		{
+			ioctl(this->fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(this->fd, &misses, sizeof(misses)) != sizeof(misses))
+				misses = -1;
+		}
+#endif
+		return misses;
+	}
+
+private:
+	int fd;
+
+	TLBCounter(const TLBCounter &);
+	TLBCounter &operator=(const TLBCounter &);
+};
+
+///
+//Allocates memory in ordinary pages, asking the system not to use huge pages for it
+static float* OrdinaryAllocate(size_t bytes)
+{
+#ifdef __linux__
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+		return nullptr;
+#ifdef MADV_NOHUGEPAGE
+	madvise(memory, bytes, MADV_NOHUGEPAGE);
+#endif
+	return (float*)memory;
+#else
+	return (float*)malloc(bytes);
+#endif
+}
+
+static void OrdinaryFree(float* memory, size_t bytes)
+{
+#ifdef __linux__
+	munmap(memory, bytes);
+#else
+	free(memory);
+#endif
+}
+
+//The measurements of one copy of the points
+struct PageResult
+{
+	double streamRate;
+	double lookupRate;
+	long long streamMisses;
+	long long lookupMisses;
+};
+
+///
+//Streams a copy of the points through a box and looks it up at random indices
+static PageResult Measure(const OBBCollider &box, const float* x, const float* y, const float* z, int count,
+	const std::vector<int> &lookups, int repeats, TLBCounter &counter, long long &checksum)
+{
+	std::vector<unsigned char> results(count);
+	PageResult result;
+	double streamTime = 1e30, lookupTime = 1e30;
+	result.streamMisses = result.lookupMisses = -1;
+	for (int r = 0; r < repeats; r++)
+	{
+		counter.Start();
+		double start = BenchSeconds();
+		TestCollisions(box, x, y, z, count, results.data());
+		double elapsed = BenchSeconds() - start;
+		long long misses = counter.Stop();
+		if (elapsed < streamTime)
+		{
+			streamTime = elapsed;
+			result.streamMisses = misses;
+		}
+
+		long long inside = 0;
+		counter.Start();
+		start = BenchSeconds();
+		for (size_t i = 0; i < lookups.size(); i++)
+		{
+			int p = lookups[i];
+			inside += TestCollision(box, glm::vec3(x[p], y[p], z[p]));
+		}
+		elapsed = BenchSeconds() - start;
+		misses = counter.Stop();
+		if (elapsed < lookupTime)
+		{
+			lookupTime = elapsed;
+			result.lookupMisses = misses;
+		}
+		checksum += inside + results[count / 2];
+	}
+
+	result.streamRate = count / streamTime / 1e6;
+	result.lookupRate = lookups.size() / lookupTime / 1e6;
+	return result;
+}
+
+///
+//Prints one row of the table
+static void PrintRow(const char* name, const PageResult &result, int count, size_t numLookups)
+{
+	char streamMisses[32], lookupMisses[32];
+	if (result.streamMisses >= 0)
+		snprintf(streamMisses, sizeof(streamMisses), "%.2f", result.streamMisses * 1000.0 / count);
+	else
+		snprintf(streamMisses, sizeof(streamMisses), "n/a");
+	if (result.lookupMisses >= 0)
+		snprintf(lookupMisses, sizeof(lookupMisses), "%.2f", result.lookupMisses * 1000.0 / numLookups);
+	else
+		snprintf(lookupMisses, sizeof(lookupMisses), "n/a");
+
+	printf("%12s %14.1f %14s %14.1f %14s\n", name, result.streamRate, streamMisses, result.lookupRate, lookupMisses);
+}
+
+int main(int argc, char** argv)
+{
+	int numPoints = BenchArgument(argc, argv, 1, 1 << 26);
+	int numLookups = BenchArgument(argc, argv, 2, 1 << 23);
+	int repeats = BenchArgument(argc, argv, 3, 3);
+
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, numPoints, 100.0f, 1);
+	std::mt19937 random(2);
+	OBBCollider box = RandomCollider(random, 100.0f, 30.0f);
+	std::uniform_int_distribution<int> anyPoint(0, numPoints - 1);
+	std::vector<int> lookups(numLookups);
+	for (int i = 0; i < numLookups; i++)
+		lookups[i] = anyPoint(random);
+
+	TLBCounter counter;
+	long long checksum = 0;
+	size_t bytes = (size_t)numPoints * 3 * sizeof(float);
+	printf("%d points (%.0f MiB), %d random lookups, best of %d%s\n", numPoints, bytes / 1048576.0, numLookups, repeats,
+		counter.Available() ? "" : ", no TLB counter");
+	printf("%12s %14s %14s %14s %14s\n", "pages", "stream Mpts/s", "misses/1000", "lookup Mpts/s", "misses/1000");
+
+	//Ordinary pages
+	float* ordinary = OrdinaryAllocate(bytes);
+	if (ordinary == nullptr)
+	{
+		printf("could not allocate %zu bytes\n", bytes);
+		return 1;
+	}
+	memcpy(ordinary, x.data(), (size_t)numPoints * sizeof(float));
+	memcpy(ordinary + numPoints, y.data(), (size_t)numPoints * sizeof(float));
+	memcpy(ordinary + 2 * (size_t)numPoints, z.data(), (size_t)numPoints * sizeof(float));
+	PageResult result = Measure(box, ordinary, ordinary + numPoints, ordinary + 2 * (size_t)numPoints, numPoints, lookups, repeats, counter, checksum);
+	PrintRow("ordinary", result, numPoints, lookups.size());
+	OrdinaryFree(ordinary, bytes);
+
+	//Huge pages, saying how much of the memory really got them
+	{
+		HugeVector<float> huge((size_t)numPoints * 3);
+		memcpy(huge.data(), x.data(), (size_t)numPoints * sizeof(float));
+		memcpy(huge.data() + numPoints, y.data(), (size_t)numPoints * sizeof(float));
+		memcpy(huge.data() + 2 * (size_t)numPoints, z.data(), (size_t)numPoints * sizeof(float));
+		result = Measure(box, huge.data(), huge.data() + numPoints, huge.data() + 2 * (size_t)numPoints, numPoints, lookups, repeats, counter, checksum);
+		PrintRow("huge", result, numPoints, lookups.size());
+
+		HugeAllocation allocation;
+		if (HugeAllocatorFind(huge.data(), allocation))
+		{
+			static const char* KIND_NAMES[NUM_HUGE_PAGE_KINDS] = { "ordinary", "transparent", "explicit" };
+			printf("huge copy: %s pages, %.0f of %.0f MiB in huge pages\n", KIND_NAMES[allocation.kind],
+				HugePageBytes(allocation) / 1048576.0, allocation.bytes / 1048576.0);
+		}
+	}
+
+	printf("(checksum %lld)\n", checksum);
+	return 0;
+}
@@ -0,0 +1,132 @@
+/*
+Title: Point - OBB
+File Name: WorkerContention.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Measures CollisionWorkers under contention. For each producer count from 1 to
+64, that many threads post small batches as fast as the pool will take them, and
+the batches finished per second are reported along with how long a Post took at
+the median and the 99th percentile, which is mostly time spent waiting for room
+in the queue.
+
+Usage: WorkerContention [workers] [batches per producer] [points per batch] [queue capacity]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "BenchScenes.h"
+#include "CollisionWorkers.h"
+
+//The producer counts to try
+static const int PRODUCERS[] = { 1, 2, 4, 8, 16, 32, 64 };
+static const int NUM_PRODUCER_COUNTS = sizeof(PRODUCERS) / sizeof(PRODUCERS[0]);
+
+//What one producer needs to post its batches and know when they are finished
+struct Producer
+{
+	std::vector<QueryBatch> batches;
+	std::vector<unsigned char> results;
+	std::vector<double> postTimes;
+	std::atomic<int> finished;
+};
+
+///
+//Counts a finished batch for its producer
+static void BatchFinished(QueryBatch* batch, void* userData)
+{
+	((Producer*)userData)->finished.fetch_add(1, std::memory_order_release);
+}
+
+int main(int argc, char** argv)
+{
+	int numWorkers = BenchArgument(argc, argv, 1, 0);
+	int numBatches = BenchArgument(argc, argv, 2, 4096);
+	int batchPoints = BenchArgument(argc, argv, 3, 1024);
+	int queueCapacity = BenchArgument(argc, argv, 4, 256);
+
+	std::vector<float> x, y, z;
+	RandomPoints(x, y, z, batchPoints, 100.0f, 1);
+	std::mt19937 random(2);
+	OBBCollider box = RandomCollider(random, 100.0f, 30.0f);
+
+	CollisionWorkers workers(numWorkers, queueCapacity);
+	printf("%d workers, %d batches of %d points per producer, queue of %d\n", workers.NumThreads(), numBatches, batchPoints, queueCapacity);
+	printf("%10s %14s %14s %14s\n", "producers", "batches/s", "post p50 us", "post p99 us");
+
+	for (int c = 0; c < NUM_PRODUCER_COUNTS; c++)
+	{
+		int numProducers = PRODUCERS[c];
+		std::vector<Producer> producers(numProducers);
+		for (int p = 0; p < numProducers; p++)
+		{
+			Producer &producer = producers[p];
+			producer.batches.resize(numBatches);
+			producer.results.resize((size_t)numBatches * batchPoints);
+			producer.postTimes.resize(numBatches);
+			producer.finished.store(0);
+			for (int b = 0; b < numBatches; b++)
+			{
+				QueryBatch &batch = producer.batches[b];
+				batch.collider = box;
+				batch.x = x.data();
+				batch.y = y.data();
+				batch.z = z.data();
+				batch.count = batchPoints;
+				batch.results = producer.results.data() + (size_t)b * batchPoints;
+				batch.callback = BatchFinished;
+				batch.userData = &producer;
+			}
+		}
+
+		double start = BenchSeconds();
+		std::vector<std::thread> threads;
+		for (int p = 0; p < numProducers; p++)
+		{
+			threads.push_back(std::thread([&workers, &producers, p, numBatches]
+			{
+				Producer &producer = producers[p];
+				for (int b = 0; b < numBatches; b++)
+				{
+					double posted = BenchSeconds();
+					workers.Post(&producer.batches[b]);
+					producer.postTimes[b] = BenchSeconds() - posted;
+				}
+				while (producer.finished.load(std::memory_order_acquire) < numBatches)
+					std::this_thread::yield();
+			}));
+		}
+		for (size_t t = 0; t < threads.size(); t++)
+			threads[t].join();
+		double elapsed = BenchSeconds() - start;
+
+		std::vector<double> postTimes;
+		for (int p = 0; p < numProducers; p++)
+			postTimes.insert(postTimes.end(), producers[p].postTimes.begin(), producers[p].postTimes.end());
+		std::sort(postTimes.begin(), postTimes.end());
+
+		printf("%10d %14.0f %14.2f %14.2f\n", numProducers, (double)numProducers * numBatches / elapsed,
+			postTimes[postTimes.size() / 2] * 1e6, postTimes[postTimes.size() * 99 / 100] * 1e6);
+	}
+	return 0;
+}
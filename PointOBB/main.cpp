@@ -46,6 +46,10 @@ AABB-2D by Brockton Roth
 */
 
 #include "GLIncludes.h"
+#include "Collision.h"
+#include "CollisionEvents.h"
+#include "IndirectRenderer.h"
+#include "BoxWireframes.h"
 
 // Global data members
 #pragma region Base_data
@@ -54,12 +58,15 @@ GLuint program;
 GLuint vertex_shader;
 GLuint fragment_shader;
 // uniforms
-GLuint uniMVP;
 GLuint uniHue;
 glm::mat4 VP;
 glm::mat4 hue;
 // Reference to the window object being created by GLFW.
 GLFWwindow* window;
+// Draws every mesh in a few indirect draw calls
+IndirectRenderer* renderer;
+// Draws box wireframes from their collider state alone
+BoxWireframes* boxWireframes;
 
 struct Vertex
 {
@@ -71,8 +78,7 @@ struct Vertex
 //Struct for rendering
 struct Mesh
 {
-	GLuint VBO;
-	GLuint VAO;
+	int rendererMesh;
 	glm::mat4 translation;
 	glm::mat4 rotation;
 	glm::mat4 scale;
@@ -93,29 +99,13 @@ struct Mesh
 
 		this->primitive = primType;
 
-		//Generate VAO
-		glGenVertexArrays(1, &this->VAO);
-		//bind VAO
-		glBindVertexArray(VAO);
-
-		//Generate VBO
-		glGenBuffers(1, &this->VBO);
-
-		//Configure VBO
-		glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(struct Vertex) * this->numVertices, this->vertices, GL_STATIC_DRAW);
-
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(struct Vertex), (void*)0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(struct Vertex), (void*)12);
+		//Add the vertices to the renderer's shared buffers
+		this->rendererMesh = renderer->AddMesh(&this->vertices[0].x, this->numVertices, nullptr, 0, this->primitive);
 	}
 
 	~Mesh(void)
 	{
 		delete[] this->vertices;
-		glDeleteVertexArrays(1, &this->VAO);
-		glDeleteBuffers(1, &this->VBO);
 	}
 
 	glm::mat4 GetModelMatrix()
@@ -125,43 +115,10 @@ struct Mesh
 
 	void Draw(void)
 	{
-		//GEnerate the MVP for this model
-		glm::mat4 MVP = VP * this->GetModelMatrix();
-
-		//Bind the VAO being drawn
-		glBindVertexArray(this->VAO);
-
-		// Set the uniform matrix in our shader to our MVP matrix for this mesh.
-		glUniformMatrix4fv(uniMVP, 1, GL_FALSE, glm::value_ptr(MVP));
-		//Draw the mesh
-		glDrawArrays(this->primitive, 0, this->numVertices);
-
-	}
-
-};
-
-//An AABB Collider struct
-struct OBB
-{
-	float width, height, depth;
-
-	///
-	//Default constructor creating an AABB of unit
-	//Width, height, and depth (-1.0f to 1.0f on each axis)
-	OBB()
-	{
-		width = height = depth = 2.0f;
+		//Queue the mesh with its model matrix, the renderer draws everything queued at once
+		renderer->Submit(this->rendererMesh, this->GetModelMatrix());
 	}
 
-	///
-	//Parameterized constructor creating an AABB of specified
-	//width, height, and depth
-	OBB(float w, float h, float d)
-	{
-		width = w;
-		height = h;
-		depth = d;
-	}
 };
 
 struct Mesh* box;
@@ -171,6 +128,15 @@ struct Mesh* selectedShape;
 
 struct OBB* boxCollider;
 
+//Whether the point has just started or stopped colliding with the box
+CollisionEvents pointEvents(1);
+
+//Whether the box's wireframe is built in the vertex shader rather than drawn from its mesh
+bool pullBoxWireframe = true;
+
+//Whether to print the renderer's stats after the next frame
+bool printRenderStats = false;
+
 float movementSpeed = 0.02f;
 float rotationSpeed = 0.01f;
 
@@ -259,9 +225,12 @@ void init()
 	VP = proj * view;
 
 	//Get uniforms
-	uniMVP = glGetUniformLocation(program, "MVP");
 	uniHue = glGetUniformLocation(program, "hue");
 
+	//Make the shared buffers the meshes are added to
+	renderer = new IndirectRenderer();
+	boxWireframes = new BoxWireframes(program);
+
 	// Set options
 	glFrontFace(GL_CCW);
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -279,60 +248,6 @@ void init()
 // Functions called between every frame. game logic
 #pragma region util_functions
 
-///
-//Tests for collisions between a point and an oriented bounding box
-//
-//Overview:
-//	This algorithm tests for collisions between a point and an OBB by determining if
-//	the point lies between bounds of the OBB on the OBB's local X, Y, and Z axis. If
-//	this is true for all 3 axis, we have a collision. We are able to do this by first
-//	transforming the point into a space of which the origin is at the center of the OBB.
-//	Then we can get the scalar projection of the point onto the OBB's local axes by utilizing the
-//	dot product. Finally, if the number returned from the scalar projection is within the min
-//	and max bounds of the OBB on that axis, we know there is a collision on that axis.
-//
-//Parameters:
-//	boxCollider: The AABB to test
-//	boxTranslation: The box's translation transformation matrix
-//		(Tip: We just need the position of the box in worldspace, so feel free to just use a vec3
-//			  if it suits your implementation better.)
-//	boxRotation: the box's rotation transformation matrix
-//	boxScale: The box's scale transformation matrix
-//	point: The point in worldspace
-//
-//Returns:
-//	true if a collision is detected, else false
-bool TestCollision(const OBB &boxCollider, const glm::mat4 &boxTranslation, const glm::mat4 &boxRotation, const glm::mat4 &boxScale, glm::vec3 point)
-{
-	//Translate the point to a coordinate system centered on the box
-	point += glm::vec3(-boxTranslation[3][0], -boxTranslation[3][1], -boxTranslation[3][2]);
-
-	//Get the minimum and maximum points on the AABB
-	glm::vec3 min(-boxCollider.width / 2.0f, -boxCollider.height / 2.0f, -boxCollider.depth / 2.0f);
-	glm::vec3 max(boxCollider.width / 2.0f, boxCollider.height / 2.0f, boxCollider.depth / 2.0f);
-
-	//scale the min and max by the box's dimensions
-	min = glm::vec3(boxScale * glm::vec4(min, 1.0f));
-	max = glm::vec3(boxScale * glm::vec4(max, 1.0f));
-
-	//Get the scalar projection of the point onto each of the box's axes and compare
-	float sProjX = glm::dot(glm::vec3(boxRotation[0][0], boxRotation[0][1], boxRotation[0][2]), point);
-	if (min.x <= sProjX && sProjX <= max.x)
-	{
-		float sProjY = glm::dot(glm::vec3(boxRotation[1][0], boxRotation[1][1], boxRotation[1][2]), point);
-		if (min.y <= sProjY && sProjY <= max.y)
-		{
-			float sProjZ = glm::dot(glm::vec3(boxRotation[2][0], boxRotation[2][1], boxRotation[2][2]), point);
-			if (min.z <= sProjZ && sProjZ <= max.z)
-				return true;
-		}
-
-	}
-		
-
-	return false;
-}
-
 // This runs once every physics timestep.
 void update()
 {
@@ -371,12 +286,15 @@ void update()
 
 	}
 
-	if (TestCollision(*boxCollider, box->translation, box->rotation, box->scale, glm::vec3(point->translation[3][0], point->translation[3][1], point->translation[3][2])))
+	unsigned char hit = TestCollision(*boxCollider, box->translation, box->rotation, box->scale, glm::vec3(point->translation[3][0], point->translation[3][1], point->translation[3][2])) ? 1 : 0;
+	pointEvents.Update(&hit);
+
+	if (!pointEvents.Entered().empty())
 	{
 		//Turn red on
 		hue[0][0] = 1.0f;
 	}
-	else
+	if (!pointEvents.Exited().empty())
 	{
 		//Turn red off
 		hue[0][0] = 0.0f;
@@ -399,8 +317,24 @@ void renderScene()
 	glUniformMatrix4fv(uniHue, 1, GL_FALSE, glm::value_ptr(hue));
 
 	// Draw the Gameobjects
-	box->Draw();
+	if (pullBoxWireframe)
+	{
+		//Send just the box's collider state, and let the vertex shader make its lines
+		PulledBox pulled = MakePulledBox(PrepareCollider(*boxCollider, box->translation, box->rotation, box->scale));
+		boxWireframes->Draw(&pulled, 1, VP, glm::vec4(1.0f, 0.0f, 1.0f, 1.0f));
+	}
+	else
+		box->Draw();
 	point->Draw();
+	renderer->Draw(VP);
+
+	if (printRenderStats)
+	{
+		const RenderStats &stats = renderer->Stats();
+		std::cout << "Renderer: " << stats.submitted << " submitted, " << stats.visible << " visible, " << stats.commands << " commands in "
+			<< stats.calls << " calls, " << stats.cpuMilliseconds << " ms on the CPU\n";
+		printRenderStats = false;
+	}
 }
 
 
@@ -414,6 +348,14 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		if (key == GLFW_KEY_SPACE)
 			selectedShape = selectedShape == box ? point : box;
 
+		//This swaps how the box's wireframe is drawn
+		if (key == GLFW_KEY_B && action == GLFW_PRESS)
+			pullBoxWireframe = !pullBoxWireframe;
+
+		//This prints how the last frame was drawn
+		if (key == GLFW_KEY_P && action == GLFW_PRESS)
+			printRenderStats = true;
+
 		//This set of controls are used to move the selectedShape.
 		if (key == GLFW_KEY_W)
 			selectedShape->translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, movementSpeed, 0.0f)) * selectedShape->translation;
@@ -525,6 +467,11 @@ void main()
 	//Print controls
 	std::cout << "Use WASD to move the selected shape in the XY plane.\nUse left CTRL & left shift to move the selected shape along Z axis.\n";
 	std::cout << "Left click and drag the mouse to rotate the selected shape.\nUse spacebar to swap the selected shape.\n";
+	std::cout << "Press B to swap between building the box wireframe in the vertex shader and drawing its mesh.\n";
+	std::cout << "Press P to print the renderer's stats for the next frame.\n";
+
+	//Start with red off, the first collision event turns it on
+	hue[0][0] = 0.0f;
 
 	// Enter the main loop.
 	while (!glfwWindowShouldClose(window))
@@ -551,6 +498,8 @@ void main()
 
 	delete box;
 	delete point;
+	delete boxWireframes;
+	delete renderer;
 
 	//Delete Colliders
 	delete boxCollider;